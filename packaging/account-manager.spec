@@ -15,6 +15,7 @@ BuildRequires:  pkgconfig(db-util)
 BuildRequires:  pkgconfig(capi-base-common)
 BuildRequires:  pkgconfig(capi-system-info)
 BuildRequires:  pkgconfig(pkgmgr-info)
+BuildRequires:  pkgconfig(pkgmgr)
 BuildRequires:	pkgconfig(glib-2.0) >= 2.26
 BuildRequires:  pkgconfig(gio-2.0)
 BuildRequires:  pkgconfig(vconf)
@@ -25,7 +26,6 @@ BuildRequires:  pkgconfig(account-common)
 BuildRequires:  pkgconfig(libtzplatform-config)
 
 Requires(post): /sbin/ldconfig
-Requires(post): /usr/bin/sqlite3
 Requires(postun): /sbin/ldconfig
 
 
@@ -74,28 +74,26 @@ install -m 644 %SOURCE3 %{buildroot}%{_unitdir}/accounts-service.service
 #        mkdir -p /opt/usr/dbspace
 #fi
 mkdir -p %{TZ_SYS_DB}
-if [ ! -f %{TZ_SYS_DB}/.account.db ]
-then
-        sqlite3 %{TZ_SYS_DB}/.account.db 'PRAGMA journal_mode = PERSIST;
-        CREATE TABLE if not exists label (AppId TEXT, Label TEXT, Locale TEXT);
-        CREATE TABLE if not exists account_type (_id INTEGER PRIMARY KEY AUTOINCREMENT, AppId TEXT,
-        ServiceProviderId TEXT, IconPath TEXT, SmallIconPath TEXT, MultipleAccountSupport INT);
-        CREATE TABLE if not exists account_custom (AccountId INTEGER, AppId TEXT, Key TEXT, Value TEXT);
-        CREATE TABLE if not exists account (_id INTEGER PRIMARY KEY AUTOINCREMENT, user_name TEXT, email_address TEXT, display_name TEXT, icon_path TEXT,
-        source TEXT, package_name TEXT, access_token TEXT, domain_name TEXT, auth_type INTEGER, secret INTEGER, sync_support INTEGER,
-        txt_custom0 TEXT, txt_custom1 TEXT, txt_custom2 TEXT, txt_custom3 TEXT, txt_custom4 TEXT,
-        int_custom0 INTEGER, int_custom1 INTEGER, int_custom2 INTEGER, int_custom3 INTEGER, int_custom4 INTEGER);
-        CREATE TABLE if not exists capability (_id INTEGER PRIMARY KEY AUTOINCREMENT, key TEXT, value INTEGER,
-	package_name TEXT, user_name TEXT,  account_id INTEGER, FOREIGN KEY (account_id) REFERENCES account(_id));
-	CREATE TABLE if not exists provider_feature (app_id TEXT, key TEXT);
-'
-fi
+# tables and schema steps of the global db, from the daemon itself so they match what it expects
+%{_bindir}/account-svcd --migrate-global-db
+# kept in rollback journal mode, left over log files of a WAL global db would be owned by root
+rm -f %{TZ_SYS_DB}/.account.db-wal %{TZ_SYS_DB}/.account.db-shm
+
+# account type snapshot and index, replaced by a rename so the daemon needs a directory of its own
+mkdir -p %{TZ_SYS_DB}/.account.db.catalog
+rm -f %{TZ_SYS_DB}/.account.db.snapshot %{TZ_SYS_DB}/.account.db.index
 
 chown service_fw:service_fw %{TZ_SYS_DB}/.account.db
 chown service_fw:service_fw %{TZ_SYS_DB}/.account.db-journal
+chown service_fw:service_fw %{TZ_SYS_DB}/.account.db.catalog
 
 chmod 644 %{TZ_SYS_DB}/.account.db
 chmod 644 %{TZ_SYS_DB}/.account.db-journal
+chmod 700 %{TZ_SYS_DB}/.account.db.catalog
+
+# flat index of the global account types, the daemon rewrites it after the global db changed
+%{_bindir}/account-svcd --build-catalog-index || rm -f %{TZ_SYS_DB}/.account.db.catalog/index
+chown service_fw:service_fw %{TZ_SYS_DB}/.account.db.catalog/index 2>/dev/null || :
 
 #smack labeling
 #chsmack -a 'System::Shared' %{TZ_SYS_DB}/.account.db-journal
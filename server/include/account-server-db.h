@@ -19,39 +19,58 @@
 #ifndef __ACC_SERVER_DB_H__
 
 #include <account-private.h>
+#include "request-scope.h"
 
 int _account_insert_to_db(account_s* account, int pid, uid_t uid, int *account_id);
+int _account_insert_list_to_db(GSList *account_list, int pid, uid_t uid, int *account_ids);
 int _account_db_open(int mode, int pid, uid_t uid);
 int _account_db_close(void);
 int _account_global_db_open(void);
 int _account_global_db_close(void);
+void _account_db_pool_evict_idle(void);
+void _account_db_pool_checkpoint(void);
+void _account_db_pool_prewarm(void);
+void _account_db_pool_destroy(void);
+void _account_type_catalog_snapshot_load(void);
+void _account_type_catalog_snapshot_save(void);
+int _account_type_catalog_index_build(void);
+int _account_global_db_migrate(void);
 int account_server_insert_account_type_to_user_db(account_type_s* account_type, int* account_type_id, uid_t uid);
 int account_server_delete_account_type_by_app_id_from_user_db(const char * app_id);
-GSList* _account_db_query_all(int pid, uid_t uid);
-GSList* _account_type_query_all(void);
+
+/* largest page of _account_query_page(), also used when the caller gives no limit */
+#define ACCOUNT_QUERY_PAGE_MAX 100
+/* takes one account of a page, returns false to end the page after it */
+typedef bool (*account_page_cb)(account_s *account, void *user_data);
+/* the account handed to callback is carved from scope and reused for the next one once callback returns */
+int _account_query_page(request_scope_s *scope, int pid, uid_t uid, const char *filter, const char *text, int value,
+		int after_id, int limit, account_page_cb callback, void *user_data, int *next_cursor);
+/* the same filters without paging */
+int _account_query_stream(request_scope_s *scope, int pid, uid_t uid, const char *filter, const char *text, int value,
+		account_page_cb callback, void *user_data);
+
+/* the account types returned by the _account_type_query_* functions belong to scope, only read them and free the lists */
+GSList* _account_type_query_all(request_scope_s *scope);
 int _account_delete(int pid, uid_t uid, int account_id);
 int _account_delete_from_db_by_user_name(int pid, uid_t uid, const char *user_name, const char *package_name);
 //int _account_delete_from_db_by_package_name(int pid, uid_t uid, const char *package_name, gboolean permission);
 int _account_update_to_db_by_id(int pid, uid_t uid, account_s *account, int account_id);
 int _account_get_total_count_from_db(gboolean include_hidden, int *count);
-int _account_query_account_by_account_id(int pid, uid_t uid, int account_db_id, account_s *account_record);
+/* the account belongs to scope, only read it */
+int _account_query_account_by_account_id(request_scope_s *scope, int pid, uid_t uid, int account_db_id, account_s **account_record);
 int _account_update_to_db_by_user_name(int pid, uid_t uid, account_s* account, const char *user_name, const char *package_name);
 int _account_type_query_label_by_locale(const char* app_id, const char* locale, char **label);
-GSList* _account_type_query_by_provider_feature(const char* key, int *error_code);
-GList* _account_query_account_by_user_name(int pid, uid_t uid, const char *user_name, int *error_code);
-GList* account_server_query_account_by_package_name(const char* package_name, int *error_code, int pid, uid_t uid);
-GList* _account_query_account_by_capability(int pid, uid_t uid, const char* capability_type, const int capability_value, int *error_code);
-GList* _account_query_account_by_capability_type(int pid, uid_t uid, const char* capability_type, int *error_code);
+GSList* _account_type_query_by_provider_feature(request_scope_s *scope, const char* key, int *error_code);
 GSList* _account_get_capability_list_by_account_id(int account_id, int *error_code);
 int _account_update_sync_status_by_id(uid_t uid, int account_db_id, const int sync_status);
+int _account_patch_by_id(int pid, uid_t uid, int account_db_id, unsigned int field_mask, GVariant *values);
 GSList* _account_type_query_provider_feature_by_app_id(const char* app_id, int *error_code);
 bool _account_type_query_supported_feature(const char* app_id, const char* capability, int *error_code);
 int _account_type_update_to_db_by_app_id(account_type_s *account_type, const char* app_id);
 GSList* _account_type_get_label_list_by_app_id(const char* app_id, int *error_code);
-int _account_type_query_by_app_id(const char* app_id, account_type_s **account_type_record);
+int _account_type_query_by_app_id(request_scope_s *scope, const char* app_id, account_type_s **account_type_record);
 int _account_update_to_db_by_id_ex(account_s *account, int account_id);
 
-GList* account_server_query_account_by_package_name(const char* package_name, int *error_code, int pid, uid_t uid);
 int account_server_delete_account_by_package_name(const char* package_name, bool permission, int pid, uid_t uid);
 int account_server_query_app_id_exist(const char *app_id);
 
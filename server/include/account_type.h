@@ -57,6 +57,23 @@ typedef enum {
 	_ACCOUNT_AUTH_TYPE_MAX
 } _account_auth_type_e;
 
+/* field mask of account_patch, the values are keyed by the column names given here */
+typedef enum {
+	_ACCOUNT_PATCH_USER_NAME = 1 << 0, /**< user_name */
+	_ACCOUNT_PATCH_EMAIL_ADDRESS = 1 << 1, /**< email_address */
+	_ACCOUNT_PATCH_DISPLAY_NAME = 1 << 2, /**< display_name */
+	_ACCOUNT_PATCH_ICON_PATH = 1 << 3, /**< icon_path */
+	_ACCOUNT_PATCH_SOURCE = 1 << 4, /**< source */
+	_ACCOUNT_PATCH_ACCESS_TOKEN = 1 << 5, /**< access_token */
+	_ACCOUNT_PATCH_DOMAIN_NAME = 1 << 6, /**< domain_name */
+	_ACCOUNT_PATCH_AUTH_TYPE = 1 << 7, /**< auth_type */
+	_ACCOUNT_PATCH_SECRET = 1 << 8, /**< secret */
+	_ACCOUNT_PATCH_SYNC_SUPPORT = 1 << 9, /**< sync_support */
+	_ACCOUNT_PATCH_USER_TEXT0 = 1 << 10, /**< txt_custom0, up to txt_custom4 at 1 << 14 */
+	_ACCOUNT_PATCH_USER_INT0 = 1 << 15, /**< int_custom0, up to int_custom4 at 1 << 19 */
+	_ACCOUNT_PATCH_ALL = (1 << 20) - 1
+} _account_patch_field_e;
+
 #define _ACCOUNT_NOTI_NAME_INSERT        "insert"
 
 #define _ACCOUNT_NOTI_NAME_UPDATE        "update"
@@ -0,0 +1,45 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __APP_GROUP_CACHE_H__
+#define __APP_GROUP_CACHE_H__
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/* granted permission checks, dropped on every package install, uninstall and update */
+void app_group_cache_init(void);
+void app_group_cache_finish(void);
+
+/*
+ * Lookups hand out the generation the result has to be stored with,
+ * a result resolved while a package changed is not stored.
+ */
+
+/* appid may act on accounts of package_name, both belong to the same package */
+bool app_group_cache_lookup_group(const char *appid, const char *package_name, uid_t uid, unsigned int *generation);
+void app_group_cache_store_group(const char *appid, const char *package_name, uid_t uid, unsigned int generation);
+
+/* appid of the package that registered the account type appid acts for, a copy to be freed */
+char *app_group_cache_lookup_represented(const char *appid, uid_t uid, unsigned int *generation);
+void app_group_cache_store_represented(const char *appid, uid_t uid, const char *verified_appid, unsigned int generation);
+
+/* account types decide the represented appid, called after any type change */
+void app_group_cache_invalidate_represented(void);
+
+#endif //__APP_GROUP_CACHE_H__
@@ -0,0 +1,35 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __APPID_CACHE_H__
+#define __APPID_CACHE_H__
+
+#include <sys/types.h>
+
+/*
+ * appid of a client process, keyed by pid, uid and the start time from /proc/<pid>/stat,
+ * so a reused pid never matches the entry of the process it replaced.
+ */
+
+/* returns a copy to be freed or NULL, start_time is set for appid_cache_store() either way */
+char *appid_cache_lookup(int pid, uid_t uid, unsigned long long *start_time);
+void appid_cache_store(int pid, uid_t uid, unsigned long long start_time, const char *appid);
+void appid_cache_remove_pid(int pid);
+void appid_cache_finish(void);
+
+#endif //__APPID_CACHE_H__
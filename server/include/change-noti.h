@@ -0,0 +1,34 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __CHANGE_NOTI_H__
+#define __CHANGE_NOTI_H__
+
+#include <gio/gio.h>
+
+#define CHANGE_NOTI_SIGNAL "account_changed"
+
+/* changes are collected for a short while and go out as one account_changed(a(sis)) signal */
+void change_noti_init(GDBusConnection *connection, const char *object_path, const char *interface_name);
+void change_noti_finish(void);
+
+/* op is one of the _ACCOUNT_NOTI_NAME_* names, package_name may be NULL */
+void change_noti_queue(const char *op, int account_id, const char *package_name);
+void change_noti_flush(void);
+
+#endif //__CHANGE_NOTI_H__
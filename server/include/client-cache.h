@@ -0,0 +1,39 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __CLIENT_CACHE_H__
+#define __CLIENT_CACHE_H__
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <gio/gio.h>
+
+/* per sender (D-Bus unique name) cache, entries go away with NameOwnerChanged */
+void client_cache_init(GDBusConnection *connection);
+void client_cache_finish(void);
+
+bool client_cache_lookup_privilege(const char *sender, const char *privilege);
+void client_cache_store_privilege(const char *sender, const char *privilege);
+
+/* pid, uid and security label of the peer, asked from the bus once per sender */
+int client_cache_get_peer_creds(GDBusConnection *connection, const char *sender, guint *pid, uid_t *uid, char **label);
+
+bool client_cache_lookup_creds(const char *sender, char **client, char **user, char **session);
+void client_cache_store_creds(const char *sender, const char *client, const char *user, const char *session);
+
+#endif //__CLIENT_CACHE_H__
@@ -18,7 +18,17 @@
 
 #ifndef __LIFECYCLE_H__
 
+/* idle shutdown on the default main context, armed right away */
+void lifecycle_init(void);
+void lifecycle_finish(void);
+
+/* cold start latency, logged once and counted from lifecycle_init() */
+void lifecycle_name_acquired(void);
+
 void lifecycle_method_call_active();
 void lifecycle_method_call_inactive();
 
+/* blocks until every call gone active went inactive again, for the shutdown once nothing new comes in */
+void lifecycle_wait_method_calls_done(void);
+
 #endif //__LIFECYCLE_H__
@@ -0,0 +1,57 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __METHOD_STATS_H__
+#define __METHOD_STATS_H__
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/* the query phase is not timed on its own, it is what the others leave of the call and so includes sending the reply */
+typedef enum {
+	METHOD_STATS_PHASE_PID = 0,
+	METHOD_STATS_PHASE_PRIVILEGE,
+	METHOD_STATS_PHASE_DB_OPEN,
+	METHOD_STATS_PHASE_QUERY,
+	METHOD_STATS_PHASE_MARSHAL,
+	METHOD_STATS_PHASE_TOTAL,
+	METHOD_STATS_PHASE_MAX
+} method_stats_phase_e;
+
+/* the counters are dumped to dlog on SIGUSR1 and once more by method_stats_finish() */
+void method_stats_init(void);
+void method_stats_finish(void);
+
+/*
+ * Called by the handling thread, between lifecycle_method_call_active() and
+ * lifecycle_method_call_inactive(). A phase entered while another one runs is part of that one.
+ */
+void method_stats_call_begin(GDBusMethodInvocation *invocation);
+void method_stats_call_result(int return_code);
+void method_stats_call_end(void);
+void method_stats_phase_begin(method_stats_phase_e phase);
+void method_stats_phase_end(method_stats_phase_e phase);
+/* objects the request scope of the call carved, against the mallocs it took for them */
+void method_stats_call_allocations(guint64 carved, guint64 allocated);
+
+/* (bucket_bounds, methods) as returned by get_method_stats, the last bound is G_MAXUINT64 */
+GVariant *method_stats_to_variant(void);
+void method_stats_reset(void);
+void method_stats_dump(void);
+
+#endif //__METHOD_STATS_H__
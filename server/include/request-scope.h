@@ -0,0 +1,57 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __REQUEST_SCOPE_H__
+#define __REQUEST_SCOPE_H__
+
+#include <glib.h>
+
+/*
+ * What one method call reads and borrows, released at once by request_scope_free() when the reply
+ * is sent. Result records, their strings and their list nodes are carved from blocks of the scope
+ * instead of being malloc'd and freed one by one. Used from the handling thread only.
+ */
+typedef struct _request_scope_s request_scope_s;
+
+/* where the scope stood, see request_scope_reset() */
+typedef struct _request_scope_mark_s {
+	gpointer block;
+	gsize used;
+} request_scope_mark_s;
+
+request_scope_s *request_scope_new(void);
+/* also adds what the scope carved and malloc'd to the stats of the current call */
+void request_scope_free(request_scope_s *scope);
+
+/* zero filled, never freed on its own */
+gpointer request_scope_alloc(request_scope_s *scope, gsize size);
+char *request_scope_strdup(request_scope_s *scope, const char *str);
+/* the node lives in the scope, so the list is neither freed nor grown with g_slist_append() */
+GSList *request_scope_slist_prepend(request_scope_s *scope, GSList *list, gpointer data);
+
+/*
+ * Hands what was carved after mark back to the scope, e.g. the account of a streamed row once
+ * it is marshalled. Cleanups added in between still run at request_scope_free().
+ */
+void request_scope_mark(request_scope_s *scope, request_scope_mark_s *mark);
+void request_scope_reset(request_scope_s *scope, const request_scope_mark_s *mark);
+
+/* data allocated elsewhere, handed to destroy when the scope is freed, last added first */
+void request_scope_add_cleanup(request_scope_s *scope, GDestroyNotify destroy, gpointer data);
+
+#endif //__REQUEST_SCOPE_H__
@@ -0,0 +1,76 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __TYPE_CACHE_H__
+#define __TYPE_CACHE_H__
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <glib.h>
+#include <account-private.h>
+
+/* account types of one database with their labels and provider features, read only once built */
+typedef struct _type_cache_catalog_s type_cache_catalog_s;
+
+/*
+ * Fills an empty catalog from the database, returns _ACCOUNT_ERROR_NONE on success.
+ * Account types have to be added before the labels and provider features referring to them.
+ */
+typedef int (*type_cache_load_cb)(type_cache_catalog_s *catalog, void *user_data);
+
+void type_cache_catalog_add_account_type(type_cache_catalog_s *catalog, account_type_s *account_type);
+void type_cache_catalog_add_label(type_cache_catalog_s *catalog, const char *app_id, const char *label, const char *locale);
+void type_cache_catalog_add_provider_feature(type_cache_catalog_s *catalog, const char *app_id, const char *key);
+
+/* built on first use and kept until type_cache_invalidate_user(), NULL if loading failed */
+type_cache_catalog_s *type_cache_get_user_catalog(uid_t uid, const char *db_path, type_cache_load_cb load, void *user_data);
+/*
+ * Also rebuilt when the files of db_path changed, the global db is written by the installer.
+ * They are looked at after type_cache_invalidate_global() and at most once a second otherwise.
+ */
+type_cache_catalog_s *type_cache_get_global_catalog(const char *db_path, type_cache_load_cb load, void *user_data);
+void type_cache_catalog_unref(type_cache_catalog_s *catalog);
+
+void type_cache_invalidate_user(uid_t uid);
+/* the global db may have changed, e.g. a package got installed */
+void type_cache_invalidate_global(void);
+void type_cache_finish(void);
+
+/*
+ * Catalogs kept across restarts, loaded before the first request and saved once the dbs are closed.
+ * A catalog of the snapshot is used instead of its db until the db files change.
+ */
+void type_cache_snapshot_load(const char *path);
+void type_cache_snapshot_save(const char *path);
+
+/*
+ * Flat index of the global db written at install time, sorted so label and feature lookups need
+ * no hash tables. Preferred over the snapshot, and rewritten to the loaded path from the next
+ * global catalog built once the global db changed.
+ */
+void type_cache_index_load(const char *path);
+bool type_cache_index_build(const char *index_path, const char *db_path, type_cache_load_cb load, void *user_data);
+
+/* lookups hand out data owned by the catalog, valid until it is unreffed */
+GSList *type_cache_get_all(type_cache_catalog_s *catalog);
+const account_type_s *type_cache_lookup_app_id(type_cache_catalog_s *catalog, const char *app_id);
+GSList *type_cache_lookup_provider_feature(type_cache_catalog_s *catalog, const char *key);
+bool type_cache_has_provider_feature(type_cache_catalog_s *catalog, const char *app_id, const char *key);
+const char *type_cache_lookup_label(type_cache_catalog_s *catalog, const char *app_id, const char *locale);
+
+#endif //__TYPE_CACHE_H__
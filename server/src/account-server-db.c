@@ -40,6 +40,12 @@
 #include <account_err.h>
 #include "account_type.h"
 #include "account-server-db.h"
+#include "app-group-cache.h"
+#include "appid-cache.h"
+#include "change-noti.h"
+#include "method-stats.h"
+#include "request-scope.h"
+#include "type-cache.h"
 
 //typedef sqlite3_stmt* account_stmt;
 
@@ -52,37 +58,78 @@
 
 #define MAX_TEXT 4096
 
+/* kept by triggers, the row of package_name '' counts every account and the others one package each */
+#define ACCOUNT_COUNT_TABLE "account_count"
+/* schema version the count table came with, see account_db_migrations */
+#define ACCOUNT_DB_SCHEMA_COUNT_TABLE 2
+
+/* account type catalogs kept in a directory of the daemon next to the global db */
+#define ACCOUNT_TYPE_CATALOG_DIR_SUFFIX "catalog"
+#define ACCOUNT_TYPE_CATALOG_SNAPSHOT_SUFFIX "snapshot"
+#define ACCOUNT_TYPE_CATALOG_INDEX_SUFFIX "index"
+
 #define _TIZEN_PUBLIC_
 #ifndef _TIZEN_PUBLIC_
 
 #endif
 
-static sqlite3* g_hAccountDB = NULL;
-static sqlite3* g_hAccountDB2 = NULL;
-static sqlite3* g_hAccountGlobalDB = NULL;
-static sqlite3* g_hAccountGlobalDB2 = NULL;
-pthread_mutex_t account_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t account_global_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* read-only connections kept per uid, a request asking for more waits for one to be released */
+#define ACCOUNT_DB_MAX_READERS 4
+
+/* connections bound to the request the calling thread is serving, see _account_db_open() */
+static __thread sqlite3* g_hAccountDB = NULL;
+static __thread sqlite3* g_hAccountGlobalDB = NULL;
+
+typedef struct _account_db_conn_s {
+	uid_t uid;
+	sqlite3 *handle;
+	GHashTable *stmt_cache;
+	int schema_version;	/* of the user db, a failed migration leaves it behind */
+	bool read_only;
+	bool in_use;
+} account_db_conn_s;
+
+/*
+ * Writes of one uid are serialized on its single writer, reads run on their own connections.
+ * Connections are opened with the pool unlocked, writer stays NULL until the first one is up.
+ */
+typedef struct _account_db_user_s {
+	uid_t uid;
+	account_db_conn_s *writer;
+	GSList *readers;
+	int readers_opening;
+} account_db_user_s;
+
+/* uid -> account_db_user_s, kept open until the daemon goes idle */
+static GHashTable *account_db_pool = NULL;
+static GSList *account_global_db_conns = NULL;
+static pthread_mutex_t account_db_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t account_db_pool_cond = PTHREAD_COND_INITIALIZER;
+
+static __thread account_db_conn_s *account_db_conn = NULL;
+static __thread account_db_conn_s *account_global_db_conn = NULL;
 
 //static char *_account_dup_text(const char *text_data);
 static int _account_insert_custom(account_s *account, int account_id);
-static int _account_update_custom(account_s *account, int account_id);
 static int _account_type_update_provider_feature(sqlite3 * account_db_handle, account_type_s *account_type, const char* app_id);
 
-static void _account_insert_delete_update_notification_send(char *noti_name)
+/*
+ * Query loops collect their records in a GPtrArray in row order and turn it into
+ * the list callers take once at the end, appending to a list walks it for every row.
+ */
+static GSList *_account_result_to_slist(GSList *list, GPtrArray *result_set)
 {
-	if (!noti_name) {
-		_ERR("Noti Name is NULL!!!!!!\n");
-		return;
-	}
+	GSList *result_list = NULL;
+	guint i = result_set->len;
 
-	_INFO("noti_type = %s", noti_name);
+	while (i > 0)
+		result_list = g_slist_prepend(result_list, g_ptr_array_index(result_set, --i));
+	g_ptr_array_free(result_set, TRUE);
 
-	if (vconf_set_str(VCONFKEY_ACCOUNT_MSG_STR, noti_name) != 0) {
-		_ERR("Vconf MSG Str set FAILED !!!!!!\n");;
-	}
+	return g_slist_concat(list, result_list);
 }
 
+/* user_data is a GSList** the appids go to in callback order, the symbol is shared with account-common */
 int _account_get_current_appid_cb(const pkgmgrinfo_appinfo_h handle, void *user_data)
 {
 	char* appid = NULL;
@@ -101,6 +148,54 @@ int _account_get_current_appid_cb(const pkgmgrinfo_appinfo_h handle, void *user_
 	return 0;
 }
 
+/* asked from pkgmgr once per client process, a sync adapter updating many accounts hits the cache */
+static char *_account_get_client_appid(int pid, uid_t uid)
+{
+	unsigned long long start_time = 0;
+	char *appid = NULL;
+
+	appid = appid_cache_lookup(pid, uid, &start_time);
+	if (appid)
+		return appid;
+
+	appid = _account_get_current_appid(pid, uid);
+	appid_cache_store(pid, uid, start_time, appid);
+
+	return appid;
+}
+
+/* only grants are cached, a denied caller asks pkgmgr again */
+static int _account_check_client_app_group(char *appid, const char *package_name, uid_t uid)
+{
+	unsigned int generation = 0;
+	int error_code = _ACCOUNT_ERROR_NONE;
+
+	if (app_group_cache_lookup_group(appid, package_name, uid, &generation))
+		return _ACCOUNT_ERROR_NONE;
+
+	error_code = _account_check_appid_group_with_package_name(appid, (char *)package_name, uid);
+	if (error_code == _ACCOUNT_ERROR_NONE)
+		app_group_cache_store_group(appid, package_name, uid, generation);
+
+	return error_code;
+}
+
+static int _account_get_client_represented_appid(char *appid, uid_t uid, char **verified_appid)
+{
+	unsigned int generation = 0;
+	int error_code = _ACCOUNT_ERROR_NONE;
+
+	*verified_appid = app_group_cache_lookup_represented(appid, uid, &generation);
+	if (*verified_appid)
+		return _ACCOUNT_ERROR_NONE;
+
+	error_code = _account_get_represented_appid_from_db(g_hAccountDB, g_hAccountGlobalDB, appid, uid, verified_appid);
+	if (error_code == _ACCOUNT_ERROR_NONE)
+		app_group_cache_store_represented(appid, uid, *verified_appid, generation);
+
+	return error_code;
+}
+
 static inline int __read_proc(const char *path, char *buf, int size)
 {
 	int fd = 0, ret = 0;
@@ -225,291 +320,919 @@ static int _account_end_transaction_from_global_db(bool is_success)
 }
 */
 
-int _account_global_db_open(void)
+static int _account_db_conn_open(const char *account_db_path, sqlite3 **handle, int flags)
 {
 	int rc = 0;
-	int ret = -1;
-	char account_db_path[256] = {0, };
 
-	_INFO("start _account_global_db_open()");
-
-	ACCOUNT_MEMSET(account_db_path, 0x00, sizeof(account_db_path));
-	ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
-
-	if (g_hAccountGlobalDB) {
-		_ERR("Account database is using in another app. %x", g_hAccountDB);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
+	if (flags)
+		rc = db_util_open_with_options(account_db_path, handle, flags, NULL);
+	else
+		rc = db_util_open(account_db_path, handle, DB_UTIL_REGISTER_HOOK_METHOD);
+	ACCOUNT_DEBUG("db_util_open(%s) sqlite_rc = %d", account_db_path, rc);
 
-	ret = _account_db_handle_close(g_hAccountGlobalDB2);
-	if (ret != _ACCOUNT_ERROR_NONE)
-		ACCOUNT_DEBUG("db_util_close(g_hAccountGlobalDB2) fail ret = %d", ret);
-
-	ACCOUNT_DEBUG("before _account_global_db_open()");
-//	if (mode == ACCOUNT_DB_OPEN_READWRITE)
-//		rc = db_util_open(account_db_path, &g_hAccountDB, DB_UTIL_REGISTER_HOOK_METHOD);
-//	else if (mode == ACCOUNT_DB_OPEN_READONLY)
-	rc = db_util_open_with_options(account_db_path, &g_hAccountGlobalDB, SQLITE_OPEN_READONLY, NULL);
-//	else
-//		return _ACCOUNT_ERROR_DB_NOT_OPENED;
-	ACCOUNT_DEBUG("after _account_global_db_open() sqlite_rc = %d", rc);
-
-	if (rc == SQLITE_PERM || _account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
+	if (rc == SQLITE_PERM || _account_db_err_code(*handle) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Account permission denied");
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
-
-	if (rc == SQLITE_BUSY) {
+		rc = _ACCOUNT_ERROR_PERMISSION_DENIED;
+	} else if (rc == SQLITE_BUSY) {
 		ACCOUNT_ERROR("busy handler fail.");
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
-
-	if (rc != SQLITE_OK) {
+		rc = _ACCOUNT_ERROR_DATABASE_BUSY;
+	} else if (rc != SQLITE_OK) {
 		ACCOUNT_ERROR("The database isn't connected.");
-		return _ACCOUNT_ERROR_DB_NOT_OPENED;
+		rc = _ACCOUNT_ERROR_DB_NOT_OPENED;
+	} else {
+		return _ACCOUNT_ERROR_NONE;
 	}
 
-	_INFO("end _account_global_db_open()");
-	return _ACCOUNT_ERROR_NONE;
+	_account_db_handle_close(*handle);
+	*handle = NULL;
+
+	return rc;
 }
 
-int _account_global_db_close(void)
+static int _account_db_conn_checkpoint(account_db_conn_s *conn, int mode)
 {
-	ACCOUNT_DEBUG("start account_global_db_close()");
-	int ret = -1;
-/*
-	ret = _account_db_handle_close(g_hAccountGlobalDB2);
-	if (ret != _ACCOUNT_ERROR_NONE)
-		ACCOUNT_DEBUG("db_util_close(g_hAccountGlobalDB2) fail ret = %d", ret);
-*/
-	ret = _account_db_handle_close(g_hAccountGlobalDB);
-	if (ret != _ACCOUNT_ERROR_NONE) {
-		ACCOUNT_ERROR("db_util_close(g_hAccountGlobalDB) fail ret = %d", ret);
-		g_hAccountGlobalDB2 = g_hAccountGlobalDB;
+	int rc = -1;
+	int log_frames = 0;
+	int checkpointed_frames = 0;
+
+	rc = sqlite3_wal_checkpoint_v2(conn->handle, NULL, mode, &log_frames, &checkpointed_frames);
+	if (rc != SQLITE_OK) {
+		ACCOUNT_DEBUG("checkpoint uid [%d] mode [%d] rc = %d (%s)", conn->uid, mode, rc, _account_db_err_msg(conn->handle));
+		return rc;
 	}
-	g_hAccountGlobalDB = NULL;
 
-	return ret;
+	_INFO("checkpoint uid [%d] mode [%d], %d of %d frames", conn->uid, mode, checkpointed_frames, log_frames);
+
+	return rc;
 }
 
-static bool _account_check_add_more_account(const char* app_id)
+/* readers keep working while the single writer appends, see _account_db_open() */
+static void _account_db_conn_set_wal(account_db_conn_s *conn)
 {
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				rc = 0;
-
-	ACCOUNT_RETURN_VAL((app_id != 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("APP ID IS NULL"));
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
-
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE AppId = '%s' and MultipleAccountSupport = 1", ACCOUNT_TYPE_TABLE, app_id);
-	rc = _account_get_record_count(g_hAccountDB, query);
+	account_stmt hstmt = NULL;
+	int rc = -1;
 
-	/* multiple account support case (User DB & global DB) */
-	if (rc > 0 || _account_get_record_count(g_hAccountGlobalDB, query) > 0) {
-		ACCOUNT_SLOGD("app id (%s) supports multiple account. rc(%d)\n", app_id, rc);
-		return TRUE;
+	/* db_util_open() puts the file back to PERSIST, so this is done on every writer open */
+	rc = sqlite3_prepare_v2(conn->handle, "PRAGMA journal_mode = WAL", -1, &hstmt, NULL);
+	if (rc != SQLITE_OK) {
+		ACCOUNT_ERROR("journal_mode prepare failed(%s)", _account_db_err_msg(conn->handle));
+		return;
 	}
 
-	/* multiple account not support case */
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE package_name = '%s'", ACCOUNT_TABLE, app_id);
-	rc = _account_get_record_count(g_hAccountDB, query);
-
-	if (rc <= 0) {
-		ACCOUNT_SLOGD("app id (%s) supports single account. and there is no account of the app id\n", app_id);
-		return TRUE;
-	}
+	rc = sqlite3_step(hstmt);
+	if (rc == SQLITE_ROW)
+		_INFO("uid [%d] journal_mode = %s", conn->uid, (const char *)sqlite3_column_text(hstmt, 0));
+	else
+		ACCOUNT_ERROR("journal_mode step failed(%d, %s)", rc, _account_db_err_msg(conn->handle));
 
-	return FALSE;
+	sqlite3_finalize(hstmt);
 }
 
-
-int _account_db_open(int mode, int pid, uid_t uid)
+static void _account_db_conn_free(gpointer data)
 {
-	int rc = 0;
+	account_db_conn_s *conn = (account_db_conn_s *)data;
 	int ret = -1;
-	char account_db_dir[256] = {0, };
-	char account_db_path[256] = {0, };
-
-	_INFO("start _account_db_open() pid [%d]. uid [%d]", pid, uid);
 
-	ACCOUNT_MEMSET(account_db_dir, 0x00, sizeof(account_db_dir));
-	ACCOUNT_MEMSET(account_db_path, 0x00, sizeof(account_db_path));
+	if (conn == NULL)
+		return;
 
-	ACCOUNT_GET_USER_DB_PATH(account_db_path, sizeof(account_db_path), uid);
+	/* sqlite3_close() refuses to close a handle with live statements */
+	if (conn->stmt_cache)
+		g_hash_table_destroy(conn->stmt_cache);
 
-	if (g_hAccountDB) {
-		_ERR("Account database is using in another app. %x", g_hAccountDB);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
+	/* readers of the uid are closed first, so the whole log can be folded back and cut */
+	if (!conn->read_only && conn->handle)
+		_account_db_conn_checkpoint(conn, SQLITE_CHECKPOINT_TRUNCATE);
 
-	ret = _account_db_handle_close(g_hAccountDB2);
+	ret = _account_db_handle_close(conn->handle);
 	if (ret != _ACCOUNT_ERROR_NONE)
-		ACCOUNT_DEBUG("db_util_close(g_hAccountDB2) fail ret = %d", ret);
+		ACCOUNT_ERROR("db_util_close() uid [%d] fail ret = %d", conn->uid, ret);
 
-	ACCOUNT_GET_USER_DB_DIR(account_db_dir, sizeof(account_db_dir), uid);
+	_ACCOUNT_FREE(conn);
+}
 
-	if (mkdir(account_db_dir, 0777) != 0)
-		ACCOUNT_DEBUG("\"%s\" is already exist directory", account_db_dir);
+static void _account_db_user_free(gpointer data)
+{
+	account_db_user_s *user = (account_db_user_s *)data;
 
-	ACCOUNT_DEBUG("before db_util_open()");
-//	if (mode == ACCOUNT_DB_OPEN_READWRITE)
-		rc = db_util_open(account_db_path, &g_hAccountDB, DB_UTIL_REGISTER_HOOK_METHOD);
-//	else if (mode == ACCOUNT_DB_OPEN_READONLY)
-//		rc = db_util_open_with_options(account_db_path, &g_hAccountDB, SQLITE_OPEN_READONLY, NULL);
-//	else
-//		return _ACCOUNT_ERROR_DB_NOT_OPENED;
-	ACCOUNT_DEBUG("after db_util_open() sqlite_rc = %d", rc);
+	if (user == NULL)
+		return;
 
-	if (rc == SQLITE_PERM || _account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Account permission denied");
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
+	g_slist_free_full(user->readers, _account_db_conn_free);
+	_account_db_conn_free(user->writer);
+	_ACCOUNT_FREE(user);
+}
 
-	if (rc == SQLITE_BUSY) {
-		ACCOUNT_ERROR("busy handler fail.");
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
+static void _account_stmt_free(gpointer data)
+{
+	sqlite3_finalize((account_stmt)data);
+}
 
-	if (rc != SQLITE_OK) {
-		ACCOUNT_ERROR("The database isn't connected.");
-		return _ACCOUNT_ERROR_DB_NOT_OPENED;
-	}
+static int _account_db_conn_new(const char *account_db_path, uid_t uid, bool read_only, account_db_conn_s **out)
+{
+	int ret = -1;
+	account_db_conn_s *conn = NULL;
 
-	rc = _account_check_is_all_table_exists(g_hAccountDB);
+	conn = (account_db_conn_s *)calloc(1, sizeof(account_db_conn_s));
+	ACCOUNT_RETURN_VAL((conn != NULL), {}, _ACCOUNT_ERROR_OUT_OF_MEMORY, ("Memory Allocation Failed"));
+	conn->uid = uid;
+	conn->read_only = read_only;
 
-	if (rc < 0) {
-		_ERR("_account_check_is_all_table_exists rc=[%d]", rc);
-		return rc;
-	} else if (rc == ACCOUNT_TABLE_TOTAL_COUNT) {
-		_INFO("Tables OK");
-	} else {
-		int ret = _account_create_all_tables(g_hAccountDB);
-		if (ret != _ACCOUNT_ERROR_NONE) {
-			_ERR("_account_create_all_tables fail ret=[%d]", ret);
-			return ret;
-		}
+	ret = _account_db_conn_open(account_db_path, &conn->handle, read_only ? SQLITE_OPEN_READONLY : 0);
+	if (ret != _ACCOUNT_ERROR_NONE) {
+		_ACCOUNT_FREE(conn);
+		return ret;
 	}
+	conn->stmt_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, _account_stmt_free);
+
+	*out = conn;
 
-	_INFO("end _account_db_open()");
 	return _ACCOUNT_ERROR_NONE;
 }
 
-int _account_db_close(void)
+/* a statement left mid-step would keep the read transaction of a cached connection open */
+static void _account_db_conn_reset_stmts(account_db_conn_s *conn)
 {
-	ACCOUNT_DEBUG("start db_util_close()");
-	int ret = -1;
-/*
-	ret = _account_db_handle_close(g_hAccountDB2);
-	if (ret != _ACCOUNT_ERROR_NONE)
-		ACCOUNT_DEBUG("db_util_close(g_hAccountDB2) fail ret = %d", ret);
-*/
-	ret = _account_db_handle_close(g_hAccountDB);
-	if (ret != _ACCOUNT_ERROR_NONE) {
-		ACCOUNT_ERROR("db_util_close(g_hAccountDB) fail ret = %d", ret);
-		g_hAccountDB2 = g_hAccountDB;
-	}
-	g_hAccountDB = NULL;
+	account_stmt hstmt = NULL;
 
-	return ret;
+	while ((hstmt = sqlite3_next_stmt(conn->handle, hstmt)) != NULL) {
+		if (sqlite3_stmt_busy(hstmt))
+			sqlite3_reset(hstmt);
+	}
 }
 
-static int _account_execute_insert_query(account_s *account)
+/* takes an idle connection out of the list, called with account_db_pool_mutex held */
+static account_db_conn_s *_account_db_conn_take_idle(GSList *conns)
 {
-	_INFO("_account_execute_insert_query start");
+	GSList *iter = NULL;
 
-	int				rc = 0;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				error_code = _ACCOUNT_ERROR_NONE;
-	account_stmt	hstmt = NULL;
+	for (iter = conns; iter != NULL; iter = g_slist_next(iter)) {
+		account_db_conn_s *conn = (account_db_conn_s *)iter->data;
+		if (!conn->in_use) {
+			conn->in_use = true;
+			return conn;
+		}
+	}
 
-	/* check whether app id exist in account type db */
+	return NULL;
+}
 
-	if (!account->user_name && !account->display_name && !account->email_address) {
-		_INFO("");
-		ACCOUNT_ERROR("Mandetory fields is NULL. At least one field is required among username, display name, email address\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
-	}
+static account_db_conn_s *_account_db_conn_lookup(sqlite3 *handle)
+{
+	if (handle == NULL)
+		return NULL;
 
-	_INFO("");
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-	ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s (user_name, email_address , display_name , icon_path , source , package_name , "
-			"access_token , domain_name , auth_type , secret , sync_support , txt_custom0, txt_custom1, txt_custom2, txt_custom3, txt_custom4, "
-			"int_custom0, int_custom1, int_custom2, int_custom3, int_custom4, txt_custom0 ) values " // to do urusa
-			"(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",	ACCOUNT_TABLE);
+	/* a handle is only ever used by the thread it is bound to */
+	if (account_db_conn && account_db_conn->handle == handle)
+		return account_db_conn;
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+	if (account_global_db_conn && account_global_db_conn->handle == handle)
+		return account_global_db_conn;
 
-	_INFO("");
-	_account_convert_account_to_sql(account, hstmt, query);
+	return NULL;
+}
 
-	_INFO("");
-	rc = _account_query_step(hstmt);
-	if (rc != SQLITE_DONE) {
-		_INFO("");
-		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+/* without it the counts are taken from the account table the way they were before the migration */
+static bool _account_db_has_count_table(void)
+{
+	return account_db_conn && account_db_conn->schema_version >= ACCOUNT_DB_SCHEMA_COUNT_TABLE;
+}
 
-		if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM)
-			error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
-		else
-			error_code = _ACCOUNT_ERROR_DB_FAILED;
+#ifdef ACCOUNT_CHECK_QUERY_PLANS
+/* logs the statements sqlite answers with a full scan, e.g. when an index got lost */
+static void _account_db_check_query_plan(sqlite3 *account_db_handle, const char *query)
+{
+	char *plan_query = g_strdup_printf("EXPLAIN QUERY PLAN %s", query);
+	account_stmt hstmt = NULL;
+	const char *detail = NULL;
+
+	if (sqlite3_prepare_v2(account_db_handle, plan_query, -1, &hstmt, NULL) != SQLITE_OK) {
+		_ERR("query plan of (%s) failed(%s)", query, _account_db_err_msg(account_db_handle));
+		g_free(plan_query);
+		return;
 	}
 
-	_INFO("");
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
+	/* the detail column is the last one in every sqlite version */
+	while (sqlite3_step(hstmt) == SQLITE_ROW) {
+		detail = (const char *)sqlite3_column_text(hstmt, sqlite3_column_count(hstmt) - 1);
+		if (detail && strncmp(detail, "SCAN", 4) == 0)
+			_ERR("full scan in (%s): %s", query, detail);
+	}
 
-	_INFO("_account_execute_insert_query end");
-	return error_code;
+	sqlite3_finalize(hstmt);
+	g_free(plan_query);
 }
+#endif
 
-static int _account_insert_capability(account_s *account, int account_id)
+/*
+ * Prepares the query once per connection and hands back the cached statement afterwards.
+ * The statement must be given back with _account_query_release() instead of being finalized.
+ */
+static account_stmt _account_prepare_cached_query(sqlite3 *account_db_handle, const char *query)
 {
-	_INFO("_account_insert_capability start");
-	int				rc, count = 1;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	account_stmt	hstmt = NULL;
-
-	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
+	account_db_conn_s *conn = NULL;
+	account_stmt hstmt = NULL;
+	int rc = -1;
 
-	if (g_slist_length(account->capablity_list) == 0) {
-		ACCOUNT_DEBUG("_account_insert_capability, no capability\n");
-		return _ACCOUNT_ERROR_NONE;
-	}
+	ACCOUNT_RETURN_VAL((query != NULL), {}, NULL, ("query is NULL"));
+	ACCOUNT_RETURN_VAL((account_db_handle != NULL), {}, NULL, ("The database isn't connected."));
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=%d", ACCOUNT_TABLE, account_id);
+	conn = _account_db_conn_lookup(account_db_handle);
+	if (conn == NULL || conn->stmt_cache == NULL)
+		return _account_prepare_query(account_db_handle, (char *)query);
 
-	_INFO("_account_insert_capability _account_get_record_count [%s]", query);
-	rc = _account_get_record_count(g_hAccountDB, query);
+	hstmt = (account_stmt)g_hash_table_lookup(conn->stmt_cache, query);
+	if (hstmt != NULL) {
+		sqlite3_reset(hstmt);
+		sqlite3_clear_bindings(hstmt);
+		return hstmt;
+	}
 
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		_ERR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	rc = sqlite3_prepare_v2(account_db_handle, query, strlen(query), &hstmt, NULL);
+	if (rc != SQLITE_OK) {
+		ACCOUNT_ERROR("sqlite3_prepare_v2(%s) failed(%s).", query, _account_db_err_msg(account_db_handle));
+		return NULL;
 	}
 
-	if (rc <= 0)
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+#ifdef ACCOUNT_CHECK_QUERY_PLANS
+	_account_db_check_query_plan(account_db_handle, query);
+#endif
 
-	/* insert query*/
+	g_hash_table_insert(conn->stmt_cache, g_strdup(query), hstmt);
 
-	GSList *iter;
+	return hstmt;
+}
 
-	for (iter = account->capablity_list; iter != NULL; iter = g_slist_next(iter)) {
-		int ret;
-		count = 1;
+static int _account_query_release(account_stmt hstmt)
+{
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("hstmt is NULL"));
 
-		account_capability_s* cap_data = NULL;
-		cap_data = (account_capability_s*)iter->data;
+	/* statements outside the cache are owned by the caller as before */
+	if (_account_db_conn_lookup(sqlite3_db_handle(hstmt)) == NULL)
+		return _account_query_finalize(hstmt);
 
-		_INFO("cap_data->type = %s, cap_data->value = %d \n", cap_data->type, cap_data->value);
+	sqlite3_reset(hstmt);
+	sqlite3_clear_bindings(hstmt);
 
-		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(key, value, package_name, user_name, account_id) VALUES "
-				"(?, ?, ?, ?, ?) ", CAPABILITY_TABLE);
-		hstmt = _account_prepare_query(g_hAccountDB, query);
+	return _ACCOUNT_ERROR_NONE;
+}
+
+static int _account_get_cached_record_count(sqlite3 *account_db_handle, account_stmt hstmt)
+{
+	int rc = -1;
+	int ncount = 0;
+
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_cached_query() failed(%s).\n", _account_db_err_msg(account_db_handle)));
+
+	rc = _account_query_step(hstmt);
+	if (rc == SQLITE_BUSY) {
+		ACCOUNT_ERROR("database busy");
+		ncount = _ACCOUNT_ERROR_DATABASE_BUSY;
+	} else if (rc != SQLITE_ROW) {
+		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
+		ncount = _ACCOUNT_ERROR_DB_FAILED;
+	} else {
+		ncount = sqlite3_column_int(hstmt, 0);
+	}
+
+	_account_query_release(hstmt);
+
+	return ncount;
+}
+
+static int _account_get_record_count_by_int(sqlite3 *account_db_handle, const char *query, int value)
+{
+	account_stmt hstmt = _account_prepare_cached_query(account_db_handle, query);
+
+	if (hstmt != NULL)
+		_account_query_bind_int(hstmt, 1, value);
+
+	return _account_get_cached_record_count(account_db_handle, hstmt);
+}
+
+static int _account_get_record_count_by_text(sqlite3 *account_db_handle, const char *query, const char *text1, const char *text2)
+{
+	account_stmt hstmt = _account_prepare_cached_query(account_db_handle, query);
+
+	if (hstmt != NULL) {
+		_account_query_bind_text(hstmt, 1, text1);
+		if (text2)
+			_account_query_bind_text(hstmt, 2, text2);
+	}
+
+	return _account_get_cached_record_count(account_db_handle, hstmt);
+}
+
+/* updates do not always carry the package, the row still has it */
+static void _account_change_noti_queue(const char *op, int account_id, const char *package_name)
+{
+	account_stmt hstmt = NULL;
+	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	char *db_package_name = NULL;
+
+	if (package_name == NULL && g_hAccountDB != NULL) {
+		ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT package_name FROM %s WHERE _id = ?", ACCOUNT_TABLE);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+		if (hstmt != NULL) {
+			_account_query_bind_int(hstmt, 1, account_id);
+			if (_account_query_step(hstmt) == SQLITE_ROW)
+				db_package_name = _account_dup_text((const char *)sqlite3_column_text(hstmt, 0));
+			_account_query_release(hstmt);
+		}
+		package_name = db_package_name;
+	}
+
+	change_noti_queue(op, account_id, package_name);
+	_ACCOUNT_FREE(db_package_name);
+}
+
+static int _account_global_db_open_pooled(void)
+{
+	int ret = -1;
+	char account_db_path[256] = {0, };
+	account_db_conn_s *conn = NULL;
+
+	_INFO("start _account_global_db_open()");
+
+	if (g_hAccountGlobalDB) {
+		_ERR("Account database is using in another app. %x", g_hAccountGlobalDB);
+		return _ACCOUNT_ERROR_DATABASE_BUSY;
+	}
+
+	/* the global db is read only, so every worker may have a connection of its own */
+	pthread_mutex_lock(&account_db_pool_mutex);
+	conn = _account_db_conn_take_idle(account_global_db_conns);
+	pthread_mutex_unlock(&account_db_pool_mutex);
+
+	if (conn == NULL) {
+		ACCOUNT_MEMSET(account_db_path, 0x00, sizeof(account_db_path));
+		ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
+
+		/* opened unlocked, it is only added to the pool once it is up */
+		ret = _account_db_conn_new(account_db_path, 0, true, &conn);
+		if (ret != _ACCOUNT_ERROR_NONE)
+			return ret;
+		conn->in_use = true;
+
+		pthread_mutex_lock(&account_db_pool_mutex);
+		account_global_db_conns = g_slist_prepend(account_global_db_conns, conn);
+		pthread_mutex_unlock(&account_db_pool_mutex);
+	}
+
+	account_global_db_conn = conn;
+	g_hAccountGlobalDB = conn->handle;
+
+	_INFO("end _account_global_db_open()");
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/* timed as the db_open phase of the call, waiting for a free connection included */
+int _account_global_db_open(void)
+{
+	int ret = -1;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_DB_OPEN);
+	ret = _account_global_db_open_pooled();
+	method_stats_phase_end(METHOD_STATS_PHASE_DB_OPEN);
+
+	return ret;
+}
+
+int _account_global_db_close(void)
+{
+	ACCOUNT_DEBUG("start account_global_db_close()");
+
+	/* the connection stays cached, just release it from the current request */
+	if (account_global_db_conn) {
+		_account_db_conn_reset_stmts(account_global_db_conn);
+
+		pthread_mutex_lock(&account_db_pool_mutex);
+		account_global_db_conn->in_use = false;
+		pthread_mutex_unlock(&account_db_pool_mutex);
+	}
+	account_global_db_conn = NULL;
+	g_hAccountGlobalDB = NULL;
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+static bool _account_check_add_more_account(const char* app_id)
+{
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	int				rc = 0;
+
+	ACCOUNT_RETURN_VAL((app_id != 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("APP ID IS NULL"));
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
+
+	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
+
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE AppId = ? and MultipleAccountSupport = 1", ACCOUNT_TYPE_TABLE);
+	rc = _account_get_record_count_by_text(g_hAccountDB, query, app_id, NULL);
+
+	/* multiple account support case (User DB & global DB) */
+	if (rc > 0 || _account_get_record_count_by_text(g_hAccountGlobalDB, query, app_id, NULL) > 0) {
+		ACCOUNT_SLOGD("app id (%s) supports multiple account. rc(%d)\n", app_id, rc);
+		return TRUE;
+	}
+
+	/* multiple account not support case, a package without accounts has no count row */
+	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
+	if (_account_db_has_count_table())
+		ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT IFNULL((SELECT total FROM %s WHERE package_name = ?), 0)", ACCOUNT_COUNT_TABLE);
+	else
+		ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE package_name = ?", ACCOUNT_TABLE);
+	rc = _account_get_record_count_by_text(g_hAccountDB, query, app_id, NULL);
+
+	if (rc <= 0) {
+		ACCOUNT_SLOGD("app id (%s) supports single account. and there is no account of the app id\n", app_id);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*
+ * Schema steps on top of _account_create_all_tables(), PRAGMA user_version counts the ones applied.
+ * Only ever append, packaging/account-manager.spec has them run on the global db by --migrate-global-db.
+ */
+static const char *account_db_migrations[] = {
+	/* 1: indexes behind the lookups by account, capability, user name, package, label and feature */
+	"CREATE INDEX IF NOT EXISTS account_user_name_idx ON " ACCOUNT_TABLE " (user_name, package_name);"
+	"CREATE INDEX IF NOT EXISTS account_package_name_idx ON " ACCOUNT_TABLE " (package_name);"
+	"CREATE INDEX IF NOT EXISTS capability_account_id_idx ON " CAPABILITY_TABLE " (account_id);"
+	"CREATE INDEX IF NOT EXISTS capability_key_idx ON " CAPABILITY_TABLE " (key, value, account_id);"
+	"CREATE INDEX IF NOT EXISTS account_custom_account_id_idx ON " ACCOUNT_CUSTOM_TABLE " (AccountId);"
+	"CREATE INDEX IF NOT EXISTS account_type_app_id_idx ON " ACCOUNT_TYPE_TABLE " (AppId);"
+	"CREATE INDEX IF NOT EXISTS label_app_id_locale_idx ON " LABEL_TABLE " (AppId, Locale);"
+	"CREATE INDEX IF NOT EXISTS provider_feature_key_idx ON " PROVIDER_FEATURE_TABLE " (key, app_id);"
+	"CREATE INDEX IF NOT EXISTS provider_feature_app_id_idx ON " PROVIDER_FEATURE_TABLE " (app_id, key);",
+	/* 2: account counts in step with every insert, delete and update, visible is secret 2 (_ACCOUNT_SECRECY_VISIBLE) */
+	"CREATE TABLE IF NOT EXISTS " ACCOUNT_COUNT_TABLE " (package_name TEXT PRIMARY KEY, total INTEGER NOT NULL DEFAULT 0, visible INTEGER NOT NULL DEFAULT 0);"
+	"DELETE FROM " ACCOUNT_COUNT_TABLE ";"
+	"INSERT INTO " ACCOUNT_COUNT_TABLE " SELECT '', COUNT(*), IFNULL(SUM(secret IS 2), 0) FROM " ACCOUNT_TABLE ";"
+	"INSERT INTO " ACCOUNT_COUNT_TABLE " SELECT package_name, COUNT(*), SUM(secret IS 2) FROM " ACCOUNT_TABLE
+	" WHERE package_name IS NOT NULL AND package_name != '' GROUP BY package_name;"
+	"CREATE TRIGGER IF NOT EXISTS account_count_insert AFTER INSERT ON " ACCOUNT_TABLE " BEGIN"
+	" INSERT OR IGNORE INTO " ACCOUNT_COUNT_TABLE " (package_name) SELECT new.package_name WHERE new.package_name IS NOT NULL;"
+	" UPDATE " ACCOUNT_COUNT_TABLE " SET total = total + 1, visible = visible + (new.secret IS 2)"
+	" WHERE package_name = '' OR package_name = new.package_name;"
+	" END;"
+	"CREATE TRIGGER IF NOT EXISTS account_count_delete AFTER DELETE ON " ACCOUNT_TABLE " BEGIN"
+	" UPDATE " ACCOUNT_COUNT_TABLE " SET total = total - 1, visible = visible - (old.secret IS 2)"
+	" WHERE package_name = '' OR package_name = old.package_name;"
+	" DELETE FROM " ACCOUNT_COUNT_TABLE " WHERE package_name = old.package_name AND package_name != '' AND total <= 0;"
+	" END;"
+	"CREATE TRIGGER IF NOT EXISTS account_count_update AFTER UPDATE OF secret, package_name ON " ACCOUNT_TABLE " BEGIN"
+	" UPDATE " ACCOUNT_COUNT_TABLE " SET total = total - 1, visible = visible - (old.secret IS 2)"
+	" WHERE package_name = '' OR package_name = old.package_name;"
+	" DELETE FROM " ACCOUNT_COUNT_TABLE " WHERE package_name = old.package_name AND package_name != '' AND total <= 0;"
+	" INSERT OR IGNORE INTO " ACCOUNT_COUNT_TABLE " (package_name) SELECT new.package_name WHERE new.package_name IS NOT NULL;"
+	" UPDATE " ACCOUNT_COUNT_TABLE " SET total = total + 1, visible = visible + (new.secret IS 2)"
+	" WHERE package_name = '' OR package_name = new.package_name;"
+	" END;",
+};
+
+static int _account_db_get_user_version(sqlite3 *account_db_handle)
+{
+	account_stmt hstmt = NULL;
+	int version = -1;
+
+	if (sqlite3_prepare_v2(account_db_handle, "PRAGMA user_version", -1, &hstmt, NULL) != SQLITE_OK) {
+		ACCOUNT_ERROR("user_version prepare failed(%s)", _account_db_err_msg(account_db_handle));
+		return -1;
+	}
+
+	if (sqlite3_step(hstmt) == SQLITE_ROW)
+		version = sqlite3_column_int(hstmt, 0);
+
+	sqlite3_finalize(hstmt);
+
+	return version;
+}
+
+static int _account_db_migrate(sqlite3 *account_db_handle)
+{
+	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	char *error_msg = NULL;
+	int version = 0;
+	int rc = 0;
+
+	version = _account_db_get_user_version(account_db_handle);
+	ACCOUNT_RETURN_VAL((version >= 0), {}, _ACCOUNT_ERROR_DB_FAILED, ("user_version read failed"));
+
+	if (version > (int)G_N_ELEMENTS(account_db_migrations)) {
+		_ERR("schema version [%d] is newer than this daemon [%d]", version, (int)G_N_ELEMENTS(account_db_migrations));
+		return _ACCOUNT_ERROR_NONE;
+	}
+
+	/* each step commits together with its version, an interrupted one is redone on the next open */
+	for (; version < (int)G_N_ELEMENTS(account_db_migrations); version++) {
+		ACCOUNT_SNPRINTF(query, sizeof(query), "PRAGMA user_version = %d; COMMIT;", version + 1);
+
+		rc = sqlite3_exec(account_db_handle, "BEGIN IMMEDIATE", NULL, NULL, &error_msg);
+		if (rc == SQLITE_OK)
+			rc = sqlite3_exec(account_db_handle, account_db_migrations[version], NULL, NULL, &error_msg);
+		if (rc == SQLITE_OK)
+			rc = sqlite3_exec(account_db_handle, query, NULL, NULL, &error_msg);
+		if (rc != SQLITE_OK) {
+			_ERR("schema migration to [%d] failed rc(%d) (%s)", version + 1, rc, error_msg);
+			sqlite3_free(error_msg);
+			sqlite3_exec(account_db_handle, "ROLLBACK", NULL, NULL, NULL);
+			return _ACCOUNT_ERROR_DB_FAILED;
+		}
+
+		_INFO("schema migrated to [%d]", version + 1);
+	}
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/* the tables of a db that has none or only some of them yet */
+static int _account_db_create_tables(sqlite3 *account_db_handle)
+{
+	int rc = 0;
+
+	rc = _account_check_is_all_table_exists(account_db_handle);
+	if (rc < 0) {
+		_ERR("_account_check_is_all_table_exists rc=[%d]", rc);
+		return rc;
+	} else if (rc == ACCOUNT_TABLE_TOTAL_COUNT) {
+		_INFO("Tables OK");
+		return _ACCOUNT_ERROR_NONE;
+	}
+
+	rc = _account_create_all_tables(account_db_handle);
+	if (rc != _ACCOUNT_ERROR_NONE)
+		_ERR("_account_create_all_tables fail ret=[%d]", rc);
+
+	return rc;
+}
+
+static int _account_db_conn_create(uid_t uid, account_db_conn_s **out)
+{
+	int ret = -1;
+	char account_db_dir[256] = {0, };
+	char account_db_path[256] = {0, };
+	account_db_conn_s *conn = NULL;
+
+	ACCOUNT_MEMSET(account_db_dir, 0x00, sizeof(account_db_dir));
+	ACCOUNT_MEMSET(account_db_path, 0x00, sizeof(account_db_path));
+
+	ACCOUNT_GET_USER_DB_PATH(account_db_path, sizeof(account_db_path), uid);
+	ACCOUNT_GET_USER_DB_DIR(account_db_dir, sizeof(account_db_dir), uid);
+
+	if (mkdir(account_db_dir, 0777) != 0)
+		ACCOUNT_DEBUG("\"%s\" is already exist directory", account_db_dir);
+
+	ret = _account_db_conn_new(account_db_path, uid, false, &conn);
+	if (ret != _ACCOUNT_ERROR_NONE)
+		return ret;
+
+	_account_db_conn_set_wal(conn);
+
+	/* schema is checked once per uid, not once per request */
+	ret = _account_db_create_tables(conn->handle);
+	if (ret != _ACCOUNT_ERROR_NONE) {
+		_account_db_conn_free(conn);
+		return ret;
+	}
+
+	/* a failed step is rolled back, the db keeps being served with the schema it had */
+	if (_account_db_migrate(conn->handle) != _ACCOUNT_ERROR_NONE)
+		_ERR("schema migration of uid [%d] failed", uid);
+
+	conn->schema_version = MAX(_account_db_get_user_version(conn->handle), 0);
+
+	*out = conn;
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+static int _account_db_open_pooled(int mode, int pid, uid_t uid)
+{
+	int ret = -1;
+	char account_db_path[256] = {0, };
+	account_db_user_s *user = NULL;
+	account_db_conn_s *conn = NULL;
+
+	_INFO("start _account_db_open() pid [%d]. uid [%d]", pid, uid);
+
+	if (g_hAccountDB) {
+		_ERR("Account database is using in another app. %x", g_hAccountDB);
+		return _ACCOUNT_ERROR_DATABASE_BUSY;
+	}
+
+	pthread_mutex_lock(&account_db_pool_mutex);
+
+	if (account_db_pool == NULL)
+		account_db_pool = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, _account_db_user_free);
+
+	while (conn == NULL) {
+		/* looked up on every pass, the entry may have been evicted while we were waiting */
+		user = (account_db_user_s *)g_hash_table_lookup(account_db_pool, GUINT_TO_POINTER(uid));
+		if (user == NULL) {
+			user = (account_db_user_s *)calloc(1, sizeof(account_db_user_s));
+			if (user == NULL) {
+				pthread_mutex_unlock(&account_db_pool_mutex);
+				ACCOUNT_FATAL("Memory Allocation Failed");
+				return _ACCOUNT_ERROR_OUT_OF_MEMORY;
+			}
+			user->uid = uid;
+			g_hash_table_insert(account_db_pool, GUINT_TO_POINTER(uid), user);
+
+			/* the writer goes first, it creates the tables the readers expect. Other uids go on meanwhile */
+			pthread_mutex_unlock(&account_db_pool_mutex);
+			ret = _account_db_conn_create(uid, &conn);
+			pthread_mutex_lock(&account_db_pool_mutex);
+
+			if (ret != _ACCOUNT_ERROR_NONE) {
+				/* whoever waits for the writer tries to open it again */
+				g_hash_table_remove(account_db_pool, GUINT_TO_POINTER(uid));
+				pthread_cond_broadcast(&account_db_pool_cond);
+				pthread_mutex_unlock(&account_db_pool_mutex);
+				return ret;
+			}
+
+			user->writer = conn;
+			conn = NULL;
+			pthread_cond_broadcast(&account_db_pool_cond);
+			_INFO("new connection cached for uid [%d]", uid);
+		}
+
+		/* a writer still NULL is being opened by another request */
+		if (user->writer && mode == ACCOUNT_DB_OPEN_READWRITE) {
+			if (!user->writer->in_use) {
+				user->writer->in_use = true;
+				conn = user->writer;
+			}
+		} else if (user->writer) {
+			conn = _account_db_conn_take_idle(user->readers);
+			if (conn == NULL && (int)g_slist_length(user->readers) + user->readers_opening < ACCOUNT_DB_MAX_READERS) {
+				ACCOUNT_MEMSET(account_db_path, 0x00, sizeof(account_db_path));
+				ACCOUNT_GET_USER_DB_PATH(account_db_path, sizeof(account_db_path), uid);
+
+				/* the slot is held, the entry is not evicted while a reader of it is opening */
+				user->readers_opening++;
+				pthread_mutex_unlock(&account_db_pool_mutex);
+				ret = _account_db_conn_new(account_db_path, uid, true, &conn);
+				pthread_mutex_lock(&account_db_pool_mutex);
+				user->readers_opening--;
+
+				if (ret != _ACCOUNT_ERROR_NONE) {
+					pthread_cond_broadcast(&account_db_pool_cond);
+					pthread_mutex_unlock(&account_db_pool_mutex);
+					return ret;
+				}
+				conn->schema_version = user->writer->schema_version;
+				conn->in_use = true;
+				user->readers = g_slist_prepend(user->readers, conn);
+			}
+		}
+
+		if (conn == NULL)
+			pthread_cond_wait(&account_db_pool_cond, &account_db_pool_mutex);
+	}
+
+	pthread_mutex_unlock(&account_db_pool_mutex);
+
+	account_db_conn = conn;
+	g_hAccountDB = conn->handle;
+
+	_INFO("end _account_db_open() %s", conn->read_only ? "reader" : "writer");
+	return _ACCOUNT_ERROR_NONE;
+}
+
+int _account_db_open(int mode, int pid, uid_t uid)
+{
+	int ret = -1;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_DB_OPEN);
+	ret = _account_db_open_pooled(mode, pid, uid);
+	method_stats_phase_end(METHOD_STATS_PHASE_DB_OPEN);
+
+	return ret;
+}
+
+int _account_db_close(void)
+{
+	ACCOUNT_DEBUG("start _account_db_close()");
+
+	if (account_db_conn) {
+		_account_db_conn_reset_stmts(account_db_conn);
+
+		pthread_mutex_lock(&account_db_pool_mutex);
+		account_db_conn->in_use = false;
+		pthread_cond_broadcast(&account_db_pool_cond);
+		pthread_mutex_unlock(&account_db_pool_mutex);
+	}
+	account_db_conn = NULL;
+	g_hAccountDB = NULL;
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/* called with account_db_pool_mutex held, connections still bound to a request stay */
+static GSList *_account_db_conns_evict_idle(GSList *conns, guint *count)
+{
+	GSList *iter = conns;
+	GSList *next = NULL;
+
+	while (iter != NULL) {
+		account_db_conn_s *conn = (account_db_conn_s *)iter->data;
+		next = g_slist_next(iter);
+		if (!conn->in_use) {
+			conns = g_slist_delete_link(conns, iter);
+			_account_db_conn_free(conn);
+			(*count)++;
+		}
+		iter = next;
+	}
+
+	return conns;
+}
+
+static gboolean _account_db_user_evict_idle(gpointer key, gpointer value, gpointer user_data)
+{
+	account_db_user_s *user = (account_db_user_s *)value;
+	guint *count = (guint *)user_data;
+
+	/* an entry whose connections are being opened is kept */
+	if (user->writer == NULL || user->readers_opening > 0)
+		return FALSE;
+
+	user->readers = _account_db_conns_evict_idle(user->readers, count);
+	if (user->readers != NULL || user->writer->in_use)
+		return FALSE;
+
+	(*count)++;
+	return TRUE;
+}
+
+void _account_db_pool_evict_idle(void)
+{
+	guint count = 0;
+
+	pthread_mutex_lock(&account_db_pool_mutex);
+
+	if (account_db_pool)
+		g_hash_table_foreach_remove(account_db_pool, _account_db_user_evict_idle, &count);
+
+	account_global_db_conns = _account_db_conns_evict_idle(account_global_db_conns, &count);
+
+	pthread_mutex_unlock(&account_db_pool_mutex);
+
+	_INFO("evicted [%d] idle connections", count);
+}
+
+/* folds the log back into the database while nobody is waiting for the writers */
+void _account_db_pool_checkpoint(void)
+{
+	GHashTableIter iter;
+	gpointer value = NULL;
+	GSList *writers = NULL;
+	GSList *item = NULL;
+
+	pthread_mutex_lock(&account_db_pool_mutex);
+	if (account_db_pool) {
+		g_hash_table_iter_init(&iter, account_db_pool);
+		while (g_hash_table_iter_next(&iter, NULL, &value)) {
+			account_db_user_s *user = (account_db_user_s *)value;
+			if (user->writer && !user->writer->in_use) {
+				user->writer->in_use = true;
+				writers = g_slist_prepend(writers, user->writer);
+			}
+		}
+	}
+	pthread_mutex_unlock(&account_db_pool_mutex);
+
+	/* passive, so readers still holding an old snapshot are never waited for */
+	for (item = writers; item != NULL; item = g_slist_next(item))
+		_account_db_conn_checkpoint((account_db_conn_s *)item->data, SQLITE_CHECKPOINT_PASSIVE);
+
+	pthread_mutex_lock(&account_db_pool_mutex);
+	for (item = writers; item != NULL; item = g_slist_next(item))
+		((account_db_conn_s *)item->data)->in_use = false;
+	pthread_cond_broadcast(&account_db_pool_cond);
+	pthread_mutex_unlock(&account_db_pool_mutex);
+
+	g_slist_free(writers);
+}
+
+void _account_db_pool_destroy(void)
+{
+	g_hAccountDB = NULL;
+	g_hAccountGlobalDB = NULL;
+	account_db_conn = NULL;
+	account_global_db_conn = NULL;
+
+	pthread_mutex_lock(&account_db_pool_mutex);
+
+	if (account_db_pool) {
+		g_hash_table_destroy(account_db_pool);
+		account_db_pool = NULL;
+	}
+
+	g_slist_free_full(account_global_db_conns, _account_db_conn_free);
+	account_global_db_conns = NULL;
+
+	pthread_mutex_unlock(&account_db_pool_mutex);
+}
+
+static int _account_execute_insert_query(account_s *account)
+{
+	_INFO("_account_execute_insert_query start");
+
+	int				rc = 0;
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	int				error_code = _ACCOUNT_ERROR_NONE;
+	account_stmt	hstmt = NULL;
+
+	/* check whether app id exist in account type db */
+
+	if (!account->user_name && !account->display_name && !account->email_address) {
+		_INFO("");
+		ACCOUNT_ERROR("Mandetory fields is NULL. At least one field is required among username, display name, email address\n");
+		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+	}
+
+	_INFO("");
+	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+	ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s (user_name, email_address , display_name , icon_path , source , package_name , "
+			"access_token , domain_name , auth_type , secret , sync_support , txt_custom0, txt_custom1, txt_custom2, txt_custom3, txt_custom4, "
+			"int_custom0, int_custom1, int_custom2, int_custom3, int_custom4, txt_custom0 ) values " // to do urusa
+			"(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",	ACCOUNT_TABLE);
+
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	_INFO("");
+	_account_convert_account_to_sql(account, hstmt, query);
+
+	_INFO("");
+	rc = _account_query_step(hstmt);
+	if (rc != SQLITE_DONE) {
+		_INFO("");
+		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+
+		if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM)
+			error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		else
+			error_code = _ACCOUNT_ERROR_DB_FAILED;
+	}
+
+	_INFO("");
+	rc = _account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	hstmt = NULL;
+
+	_INFO("_account_execute_insert_query end");
+	return error_code;
+}
+
+static int _account_insert_capability(account_s *account, int account_id)
+{
+	_INFO("_account_insert_capability start");
+	int				rc, count = 1;
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	account_stmt	hstmt = NULL;
+
+	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
+
+	if (g_slist_length(account->capablity_list) == 0) {
+		ACCOUNT_DEBUG("_account_insert_capability, no capability\n");
+		return _ACCOUNT_ERROR_NONE;
+	}
+
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=?", ACCOUNT_TABLE);
+
+	_INFO("_account_insert_capability _account_get_record_count [%s]", query);
+	rc = _account_get_record_count_by_int(g_hAccountDB, query, account_id);
+
+	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+		_ERR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	}
+
+	if (rc <= 0)
+		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+
+	/* insert query*/
+
+	GSList *iter;
+
+	for (iter = account->capablity_list; iter != NULL; iter = g_slist_next(iter)) {
+		int ret;
+		count = 1;
+
+		account_capability_s* cap_data = NULL;
+		cap_data = (account_capability_s*)iter->data;
+
+		_INFO("cap_data->type = %s, cap_data->value = %d \n", cap_data->type, cap_data->value);
+
+		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(key, value, package_name, user_name, account_id) VALUES "
+				"(?, ?, ?, ?, ?) ", CAPABILITY_TABLE);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
@@ -532,7 +1255,7 @@ static int _account_insert_capability(account_s *account, int account_id)
 			break;
 		}
 
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 
@@ -542,164 +1265,402 @@ static int _account_insert_capability(account_s *account, int account_id)
 	return _ACCOUNT_ERROR_NONE;
 }
 
-static int _account_update_capability(account_s *account, int account_id)
+/* user_name .. sync_support, the user text and the user int columns */
+#define ACCOUNT_UPDATE_COLUMN_CNT	(11 + USER_TXT_CNT + USER_INT_CNT)
+
+typedef struct _account_changed_column_s {
+	const char *name;
+	const char *text;
+	int value;
+	bool is_text;
+} account_changed_column_s;
+
+static void _account_diff_text_column(account_changed_column_s *columns, int *count, bool all, const char *name, const char *new_text, const char *old_text)
 {
-	int				rc, count = 1;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	account_stmt	hstmt = NULL;
+	if (!all && g_strcmp0(new_text, old_text) == 0)
+		return;
 
-	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
+	columns[*count].name = name;
+	columns[*count].text = new_text;
+	columns[*count].is_text = true;
+	(*count)++;
+}
 
-	if (g_slist_length(account->capablity_list) == 0) {
-		ACCOUNT_ERROR("_account_update_capability, no capability\n");
+static void _account_diff_int_column(account_changed_column_s *columns, int *count, bool all, const char *name, int new_value, int old_value)
+{
+	if (!all && new_value == old_value)
+		return;
+
+	columns[*count].name = name;
+	columns[*count].value = new_value;
+	columns[*count].is_text = false;
+	(*count)++;
+}
+
+/* fills columns with the account columns that differ from the stored record, or all of them without one, returns how many */
+static int _account_diff_columns(account_s *account, account_s *old_account, account_changed_column_s *columns)
+{
+	static const char *txt_columns[USER_TXT_CNT] = { "txt_custom0", "txt_custom1", "txt_custom2", "txt_custom3", "txt_custom4" };
+	static const char *int_columns[USER_INT_CNT] = { "int_custom0", "int_custom1", "int_custom2", "int_custom3", "int_custom4" };
+	bool all = (old_account == NULL);
+	int count = 0;
+	int i;
+
+	if (all)
+		old_account = account;
+
+	_account_diff_text_column(columns, &count, all, "user_name", account->user_name, old_account->user_name);
+	_account_diff_text_column(columns, &count, all, "email_address", account->email_address, old_account->email_address);
+	_account_diff_text_column(columns, &count, all, "display_name", account->display_name, old_account->display_name);
+	_account_diff_text_column(columns, &count, all, "icon_path", account->icon_path, old_account->icon_path);
+	_account_diff_text_column(columns, &count, all, "source", account->source, old_account->source);
+	_account_diff_text_column(columns, &count, all, "package_name", account->package_name, old_account->package_name);
+	_account_diff_text_column(columns, &count, all, "access_token", account->access_token, old_account->access_token);
+	_account_diff_text_column(columns, &count, all, "domain_name", account->domain_name, old_account->domain_name);
+	_account_diff_int_column(columns, &count, all, "auth_type", account->auth_type, old_account->auth_type);
+	_account_diff_int_column(columns, &count, all, "secret", account->secret, old_account->secret);
+	_account_diff_int_column(columns, &count, all, "sync_support", account->sync_support, old_account->sync_support);
+
+	for (i = 0; i < USER_TXT_CNT; i++)
+		_account_diff_text_column(columns, &count, all, txt_columns[i], account->user_data_txt[i], old_account->user_data_txt[i]);
+
+	for (i = 0; i < USER_INT_CNT; i++)
+		_account_diff_int_column(columns, &count, all, int_columns[i], account->user_data_int[i], old_account->user_data_int[i]);
+
+	return count;
+}
+
+/* the write transaction is only opened once the first difference turns up */
+static int _account_diff_begin_write(bool *changed)
+{
+	int ret_transaction = _ACCOUNT_ERROR_NONE;
+
+	if (*changed)
 		return _ACCOUNT_ERROR_NONE;
+
+	ret_transaction = _account_begin_transaction(g_hAccountDB);
+	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("_account_begin_transaction fail(%d, %s)", ret_transaction, _account_db_err_msg(g_hAccountDB));
+		return ret_transaction;
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=%d", ACCOUNT_TABLE, account_id);
+	*changed = true;
 
-	rc = _account_get_record_count(g_hAccountDB, query);
+	return _ACCOUNT_ERROR_NONE;
+}
 
-	if (rc <= 0) {
-		ACCOUNT_SLOGI("_account_update_capability : related account item is not existed rc=%d , %s", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+/* steps a statement that changes one child row and gives it back to the cache */
+static int _account_diff_step(account_stmt hstmt)
+{
+	int rc = 0;
+
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	rc = _account_query_step(hstmt);
+	_account_query_release(hstmt);
+
+	if (rc == SQLITE_BUSY) {
+		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_DATABASE_BUSY;
+	} else if (rc != SQLITE_DONE) {
+		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_DB_FAILED;
 	}
 
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/*
+ * One UPDATE for the given columns of the account, rows already holding every value are skipped.
+ * *changes, when asked for, is 0 if nothing had to be written.
+ */
+static int _account_update_changed_columns(account_changed_column_s *columns, int column_count, int account_id, int *changes)
+{
+	/* every column is named twice, once to set it and once to compare it */
+	char			query[ACCOUNT_SQL_LEN_MAX * 2] = {0, };
+	account_stmt	hstmt = NULL;
+	int				rc = 0, i = 0, binding_count = 1;
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE account_id=? ", CAPABILITY_TABLE);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET ", ACCOUNT_TABLE);
+	for (i = 0; i < column_count; i++)
+		ACCOUNT_SNPRINTF(query + strlen(query), sizeof(query) - strlen(query), "%s%s=?%d", i ? ", " : "", columns[i].name, i + 1);
+	ACCOUNT_SNPRINTF(query + strlen(query), sizeof(query) - strlen(query), " WHERE _id=?%d AND (", column_count + 1);
+	for (i = 0; i < column_count; i++)
+		ACCOUNT_SNPRINTF(query + strlen(query), sizeof(query) - strlen(query), "%s%s IS NOT ?%d", i ? " OR " : "", columns[i].name, i + 1);
+	ACCOUNT_SNPRINTF(query + strlen(query), sizeof(query) - strlen(query), ") ");
+
+	/* the column set differs from update to update, so the statement is not cached */
 	hstmt = _account_prepare_query(g_hAccountDB, query);
-	count = 1;
-	_account_query_bind_int(hstmt, count++, (int)account_id);
+	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		if (hstmt)
+			_account_query_finalize(hstmt);
+		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	}
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	for (i = 0; i < column_count; i++) {
+		if (columns[i].is_text)
+			_account_query_bind_text(hstmt, binding_count++, columns[i].text);
+		else
+			_account_query_bind_int(hstmt, binding_count++, columns[i].value);
+	}
+	_account_query_bind_int(hstmt, binding_count++, account_id);
+
 	rc = _account_query_step(hstmt);
+	_account_query_finalize(hstmt);
 
-	if (rc != SQLITE_DONE) {
-		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+	if (rc == SQLITE_BUSY) {
+		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_DATABASE_BUSY;
+	} else if (rc != SQLITE_DONE) {
+		ACCOUNT_SLOGE("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_DB_FAILED;
 	}
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
 
-	GSList *iter;
+	if (changes)
+		*changes = sqlite3_changes(g_hAccountDB);
 
-	for (iter = account->capablity_list; iter != NULL; iter = g_slist_next(iter)) {
-		int ret;
-		count = 1;
-		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(key, value, package_name, user_name, account_id) VALUES "
-				"(?, ?, ?, ?, ?) ", CAPABILITY_TABLE);
+	return _ACCOUNT_ERROR_NONE;
+}
 
-		hstmt = _account_prepare_query(g_hAccountDB, query);
+/* capability rows carry the user name and package name of their account, column is one of the two */
+static int _account_update_capability_column(const char *column, const char *text, int account_id)
+{
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	account_stmt	hstmt = NULL;
 
-		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET %s=? WHERE account_id=? ", CAPABILITY_TABLE, column);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	if (hstmt) {
+		_account_query_bind_text(hstmt, 1, text);
+		_account_query_bind_int(hstmt, 2, account_id);
+	}
 
-		account_capability_s* cap_data = NULL;
-		cap_data = (account_capability_s*)iter->data;
+	return _account_diff_step(hstmt);
+}
 
-		ret = _account_query_bind_text(hstmt, count++, cap_data->type);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_int(hstmt, count++, cap_data->value);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Integer binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)account->package_name);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)account->user_name);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_int(hstmt, count++, (int)account_id);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Integer binding fail"));
+/*
+ * Capabilities are matched by key: new keys are inserted, changed values updated
+ * and keys missing from the request deleted. No capability in the request keeps the stored ones.
+ */
+static int _account_update_changed_capability(account_s *account, account_s *old_account, int account_id, bool *changed)
+{
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	GHashTable		*old_caps = NULL;	/* key -> account_capability_s of old_account */
+	GHashTableIter	hash_iter;
+	gpointer		value = NULL;
+	GSList			*iter = NULL;
+	int				error_code = _ACCOUNT_ERROR_NONE;
+
+	if (account->capablity_list == NULL)
+		return _ACCOUNT_ERROR_NONE;
 
-		rc = _account_query_step(hstmt);
+	old_caps = g_hash_table_new(g_str_hash, g_str_equal);
+	for (iter = old_account->capablity_list; iter != NULL; iter = g_slist_next(iter)) {
+		account_capability_s *cap_data = (account_capability_s *)iter->data;
+		if (cap_data->type)
+			g_hash_table_insert(old_caps, cap_data->type, cap_data);
+	}
 
-		if (rc != SQLITE_DONE) {
-			ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+	for (iter = account->capablity_list; iter != NULL && error_code == _ACCOUNT_ERROR_NONE; iter = g_slist_next(iter)) {
+		account_capability_s *cap_data = (account_capability_s *)iter->data;
+		account_capability_s *old_cap = NULL;
+		account_stmt hstmt = NULL;
+
+		if (cap_data->type)
+			old_cap = (account_capability_s *)g_hash_table_lookup(old_caps, cap_data->type);
+
+		if (old_cap) {
+			g_hash_table_remove(old_caps, cap_data->type);
+			if (old_cap->value == cap_data->value)
+				continue;
+		}
+
+		error_code = _account_diff_begin_write(changed);
+		if (error_code != _ACCOUNT_ERROR_NONE)
 			break;
+
+		if (old_cap) {
+			ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET value=? WHERE account_id=? AND key=? ", CAPABILITY_TABLE);
+			hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+			if (hstmt) {
+				_account_query_bind_int(hstmt, 1, cap_data->value);
+				_account_query_bind_int(hstmt, 2, account_id);
+				_account_query_bind_text(hstmt, 3, cap_data->type);
+			}
+		} else {
+			ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(key, value, package_name, user_name, account_id) VALUES "
+					"(?, ?, ?, ?, ?) ", CAPABILITY_TABLE);
+			hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+			if (hstmt) {
+				_account_query_bind_text(hstmt, 1, cap_data->type);
+				_account_query_bind_int(hstmt, 2, cap_data->value);
+				_account_query_bind_text(hstmt, 3, account->package_name);
+				_account_query_bind_text(hstmt, 4, account->user_name);
+				_account_query_bind_int(hstmt, 5, account_id);
+			}
 		}
 
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-		hstmt = NULL;
+		error_code = _account_diff_step(hstmt);
+	}
+
+	g_hash_table_iter_init(&hash_iter, old_caps);
+	while (error_code == _ACCOUNT_ERROR_NONE && g_hash_table_iter_next(&hash_iter, NULL, &value)) {
+		account_capability_s *old_cap = (account_capability_s *)value;
+		account_stmt hstmt = NULL;
 
+		error_code = _account_diff_begin_write(changed);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			break;
+
+		ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE account_id=? AND key=? ", CAPABILITY_TABLE);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+		if (hstmt) {
+			_account_query_bind_int(hstmt, 1, account_id);
+			_account_query_bind_text(hstmt, 2, old_cap->type);
+		}
+
+		error_code = _account_diff_step(hstmt);
 	}
 
-	return _ACCOUNT_ERROR_NONE;
+	g_hash_table_destroy(old_caps);
+
+	return error_code;
 }
 
-static int _account_update_capability_by_user_name(account_s *account, const char *user_name, const char *package_name)
+/* same as the capabilities, custom rows are matched by key */
+static int _account_update_changed_custom(account_s *account, account_s *old_account, int account_id, bool *changed)
 {
-	int				rc, count = 1;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	account_stmt	hstmt = NULL;
-
-	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
+	GHashTable		*old_customs = NULL;	/* key -> account_custom_s of old_account */
+	GHashTableIter	hash_iter;
+	gpointer		value = NULL;
+	GSList			*iter = NULL;
+	int				error_code = _ACCOUNT_ERROR_NONE;
 
-	if (g_slist_length(account->capablity_list) == 0) {
-		ACCOUNT_ERROR("_account_update_capability_by_user_name, no capability\n");
+	if (account->custom_list == NULL)
 		return _ACCOUNT_ERROR_NONE;
+
+	old_customs = g_hash_table_new(g_str_hash, g_str_equal);
+	for (iter = old_account->custom_list; iter != NULL; iter = g_slist_next(iter)) {
+		account_custom_s *custom_data = (account_custom_s *)iter->data;
+		if (custom_data->key)
+			g_hash_table_insert(old_customs, custom_data->key, custom_data);
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where package_name= '%s' and user_name='%s'", ACCOUNT_TABLE, package_name, user_name);
+	for (iter = account->custom_list; iter != NULL && error_code == _ACCOUNT_ERROR_NONE; iter = g_slist_next(iter)) {
+		account_custom_s *custom_data = (account_custom_s *)iter->data;
+		account_custom_s *old_custom = NULL;
+		account_stmt hstmt = NULL;
 
-	rc = _account_get_record_count(g_hAccountDB, query);
+		if (custom_data->key)
+			old_custom = (account_custom_s *)g_hash_table_lookup(old_customs, custom_data->key);
 
-	if (rc <= 0) {
-		ACCOUNT_SLOGI("_account_update_capability_by_user_name : related account item is not existed rc=%d , %s ", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-	}
+		if (old_custom) {
+			g_hash_table_remove(old_customs, custom_data->key);
+			if (g_strcmp0(old_custom->value, custom_data->value) == 0)
+				continue;
+		}
 
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+		error_code = _account_diff_begin_write(changed);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			break;
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE package_name=? and user_name=? ", CAPABILITY_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	count = 1;
-	_account_query_bind_text(hstmt, count++, (char*)account->package_name);
-	_account_query_bind_text(hstmt, count++, (char*)account->user_name);
-	rc = _account_query_step(hstmt);
-	if (rc != SQLITE_DONE) {
-		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_DB_FAILED;
+		if (old_custom) {
+			ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET Value=? WHERE AccountId=? AND Key=? ", ACCOUNT_CUSTOM_TABLE);
+			hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+			if (hstmt) {
+				_account_query_bind_text(hstmt, 1, custom_data->value);
+				_account_query_bind_int(hstmt, 2, account_id);
+				_account_query_bind_text(hstmt, 3, custom_data->key);
+			}
+		} else {
+			ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(AccountId, AppId, Key, Value) VALUES "
+					"(?, ?, ?, ?) ", ACCOUNT_CUSTOM_TABLE);
+			hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+			if (hstmt) {
+				_account_query_bind_int(hstmt, 1, account_id);
+				_account_query_bind_text(hstmt, 2, account->package_name);
+				_account_query_bind_text(hstmt, 3, custom_data->key);
+				_account_query_bind_text(hstmt, 4, custom_data->value);
+			}
+		}
+
+		error_code = _account_diff_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
+	g_hash_table_iter_init(&hash_iter, old_customs);
+	while (error_code == _ACCOUNT_ERROR_NONE && g_hash_table_iter_next(&hash_iter, NULL, &value)) {
+		account_custom_s *old_custom = (account_custom_s *)value;
+		account_stmt hstmt = NULL;
 
-	GSList* iter;
+		error_code = _account_diff_begin_write(changed);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			break;
 
-	for (iter = account->capablity_list; iter != NULL; iter = g_slist_next(iter)) {
-		int ret;
-		count = 1;
-		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(key, value, package_name, user_name, account_id) VALUES "
-				"(?, ?, ?, ?, ?) ", CAPABILITY_TABLE);
+		ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AccountId=? AND Key=? ", ACCOUNT_CUSTOM_TABLE);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+		if (hstmt) {
+			_account_query_bind_int(hstmt, 1, account_id);
+			_account_query_bind_text(hstmt, 2, old_custom->key);
+		}
 
-		hstmt = _account_prepare_query(g_hAccountDB, query);
+		error_code = _account_diff_step(hstmt);
+	}
 
-		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+	g_hash_table_destroy(old_customs);
 
-		account_capability_s* cap_data = NULL;
-		cap_data = (account_capability_s*)iter->data;
+	return error_code;
+}
 
-		ret = _account_query_bind_text(hstmt, count++, cap_data->type);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_int(hstmt, count++, cap_data->value);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Integer binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)account->package_name);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)account->user_name);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_int(hstmt, count++, (int)account->id);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Integer binding fail"));
+/*
+ * Writes only what differs between account and the stored old_account.
+ * *changed is set once the write transaction is open, the caller commits or rolls it back;
+ * it stays false when the stored record already matches and nothing was written.
+ */
+static int _account_update_changed_fields(account_s *account, account_s *old_account, int account_id, bool *changed)
+{
+	account_changed_column_s columns[ACCOUNT_UPDATE_COLUMN_CNT];
+	int				column_count = 0;
+	int				error_code = _ACCOUNT_ERROR_NONE;
 
-		rc = _account_query_step(hstmt);
+	*changed = false;
 
-		if (rc != SQLITE_DONE) {
-			ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-			break;
-		}
+	column_count = _account_diff_columns(account, old_account, columns);
+	if (column_count > 0) {
+		error_code = _account_diff_begin_write(changed);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			return error_code;
 
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-		hstmt = NULL;
+		error_code = _account_update_changed_columns(columns, column_count, account_id, NULL);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			return error_code;
+	}
+
+	/* before the capability diff, rows it leaves alone still get the new names */
+	if (old_account->capablity_list && g_strcmp0(account->user_name, old_account->user_name) != 0) {
+		error_code = _account_update_capability_column("user_name", account->user_name, account_id);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			return error_code;
+	}
+
+	if (old_account->capablity_list && g_strcmp0(account->package_name, old_account->package_name) != 0) {
+		error_code = _account_update_capability_column("package_name", account->package_name, account_id);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			return error_code;
+	}
+
+	error_code = _account_update_changed_capability(account, old_account, account_id, changed);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("update capability failed(%d)", error_code);
+		return error_code;
+	}
 
+	error_code = _account_update_changed_custom(account, old_account, account_id, changed);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("update custom failed(%d)", error_code);
+		return error_code;
 	}
 
 	return _ACCOUNT_ERROR_NONE;
@@ -746,7 +1707,8 @@ bool _account_add_custom_to_account_cb(const char* key, const char* value, accou
 }
 
 
-static int _account_compare_old_record_by_user_name(account_s *new_account, const char* user_name, const char* package_name)
+/* fills the unset fields of new_account from the stored record, handed out through old_record when asked for */
+static int _account_compare_old_record_by_user_name(account_s *new_account, const char* user_name, const char* package_name, account_s **old_record)
 {
 	int				error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt	hstmt = NULL;
@@ -767,8 +1729,12 @@ static int _account_compare_old_record_by_user_name(account_s *new_account, cons
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE user_name = '%s' and package_name='%s'", ACCOUNT_TABLE, user_name, package_name);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE user_name = ? and package_name = ?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	_account_query_bind_text(hstmt, 1, user_name);
+	_account_query_bind_text(hstmt, 2, package_name);
 
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
@@ -778,17 +1744,19 @@ static int _account_compare_old_record_by_user_name(account_s *new_account, cons
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
+	/* an account without capabilities or custom rows is not an error */
 	// get capability
 	error_code = _account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, old_account->id, (void*)old_account);
-	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("account_query_capability_by_account_id error"));
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE || error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND), {}, error_code, ("account_query_capability_by_account_id error"));
 
 	// get custom text
 	error_code = _account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, old_account->id, (void*)old_account);
-	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("_account_query_custom_by_account_id error"));
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE || error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND), {}, error_code, ("_account_query_custom_by_account_id error"));
+	error_code = _ACCOUNT_ERROR_NONE;
 
 	// compare
 	new_account->id = old_account->id;
@@ -865,25 +1833,80 @@ static int _account_compare_old_record_by_user_name(account_s *new_account, cons
 				new_account->user_data_int[i] = old_account->user_data_int[i];
 	}
 
+	if (old_record) {
+		*old_record = old_account;
+		old_account = NULL;
+	}
+
 CATCH:
 	if (old_account)
 		_account_free_account_with_items(old_account);
 
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
 
-	return _ACCOUNT_ERROR_NONE;
+	return error_code;
 }
 
-static int _account_update_account_by_user_name(int pid, uid_t uid, account_s *account, const char *user_name, const char *package_name)
+/*
+ * Every account but account_id stored under the user name and package name gets the columns of account,
+ * as the update by user name did before it was diffed. Their capability and custom rows are left alone.
+ */
+static int _account_update_namesakes(account_s *account, const char *user_name, const char *package_name, int account_id, bool *changed)
 {
-	int				rc = 0, binding_count = 0, count = 0;
+	account_changed_column_s columns[ACCOUNT_UPDATE_COLUMN_CNT];
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt	hstmt = NULL;
+	GArray			*ids = NULL;
+	int				column_count = 0;
+	int				id = 0;
+	int				rc = 0;
+	guint			i = 0;
+	int				error_code = _ACCOUNT_ERROR_NONE;
+
+	/* read out first, the updates may change the user name they were found by */
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT _id FROM %s WHERE user_name=? and package_name=? and _id!=?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	_account_query_bind_text(hstmt, 1, user_name);
+	_account_query_bind_text(hstmt, 2, package_name);
+	_account_query_bind_int(hstmt, 3, account_id);
+
+	ids = g_array_new(FALSE, FALSE, sizeof(int));
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW) {
+		id = sqlite3_column_int(hstmt, 0);
+		g_array_append_val(ids, id);
+	}
+	_account_query_release(hstmt);
+
+	if (rc != SQLITE_DONE) {
+		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+		g_array_free(ids, TRUE);
+		return _ACCOUNT_ERROR_DB_FAILED;
+	}
+
+	column_count = _account_diff_columns(account, NULL, columns);
+	for (i = 0; i < ids->len && error_code == _ACCOUNT_ERROR_NONE; i++) {
+		error_code = _account_diff_begin_write(changed);
+		if (error_code == _ACCOUNT_ERROR_NONE)
+			error_code = _account_update_changed_columns(columns, column_count, g_array_index(ids, int, i), NULL);
+	}
+
+	g_array_free(ids, TRUE);
+
+	return error_code;
+}
+
+static int _account_update_account_by_user_name(int pid, uid_t uid, account_s *account, const char *user_name, const char *package_name, bool *changed)
+{
+	int				count = 0;
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	int				error_code = _ACCOUNT_ERROR_NONE;
+	account_s		*old_account = NULL;
 
 	ACCOUNT_RETURN_VAL((user_name != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("user_name is NULL.\n"));
 	ACCOUNT_RETURN_VAL((package_name != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("package_name is NULL.\n"));
@@ -891,8 +1914,8 @@ static int _account_update_account_by_user_name(int pid, uid_t uid, account_s *a
 	char* current_appid = NULL;
 	char* verified_appid = NULL;
 
-	current_appid = _account_get_current_appid(pid, uid);
-	error_code = _account_get_represented_appid_from_db(g_hAccountDB, g_hAccountGlobalDB, current_appid, uid, &verified_appid);
+	current_appid = _account_get_client_appid(pid, uid);
+	error_code = _account_get_client_represented_appid(current_appid, uid, &verified_appid);
 
 	_ACCOUNT_FREE(current_appid);
 	_ACCOUNT_FREE(verified_appid);
@@ -908,227 +1931,271 @@ static int _account_update_account_by_user_name(int pid, uid_t uid, account_s *a
 		return error_code;
 	}
 
-	_account_compare_old_record_by_user_name(account, user_name, package_name);
+	_account_compare_old_record_by_user_name(account, user_name, package_name, &old_account);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	}
 
 	if (!account->package_name) {
 		ACCOUNT_ERROR("Package name is mandetory field, it can not be NULL!!!!\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+		error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+		goto CATCH;
 	}
 
 	if (!account->user_name && !account->display_name && !account->email_address) {
 		ACCOUNT_ERROR("One field should be set among user name, display name, email address\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+		error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+		goto CATCH;
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE user_name='%s' and package_name='%s'"
-			, ACCOUNT_TABLE, user_name, package_name);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE user_name=? and package_name=?", ACCOUNT_TABLE);
 
-	count = _account_get_record_count(g_hAccountDB, query);
+	count = _account_get_record_count_by_text(g_hAccountDB, query, user_name, package_name);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	}
 
-	if (count <= 0) {
+	if (count <= 0 || old_account == NULL) {
 		ACCOUNT_SLOGI("_account_update_account_by_user_name : The account not exist!, count = %d, user_name=%s, package_name=%s\n",
 			count, user_name, package_name);
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+		error_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+		goto CATCH;
 	}
 
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+	error_code = _account_update_changed_fields(account, old_account, old_account->id, changed);
+	if (error_code == _ACCOUNT_ERROR_NONE && count > 1)
+		error_code = _account_update_namesakes(account, user_name, package_name, old_account->id, changed);
+	if (*changed)
+		_account_end_transaction(g_hAccountDB, error_code == _ACCOUNT_ERROR_NONE);
+	else if (error_code == _ACCOUNT_ERROR_NONE)
+		_INFO("account [%d] is unchanged, nothing written", old_account->id);
 
-	//TODO: Is it required to update id ? As of now I can only think of falied rollback cases (between account and gSSO DB)
-	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET user_name=?, email_address =?, display_name =?, "
-			"icon_path =?, source =?, package_name =? , access_token =?, domain_name =?, auth_type =?, secret =?, sync_support =?,"
-			"txt_custom0=?, txt_custom1=?, txt_custom2=?, txt_custom3=?, txt_custom4=?, "
-			"int_custom0=?, int_custom1=?, int_custom2=?, int_custom3=?, int_custom4=? WHERE user_name=? and package_name=? ", ACCOUNT_TABLE);
+CATCH:
+	if (old_account)
+		_account_free_account_with_items(old_account);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		_account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	return error_code;
+}
+
+/* the package of the caller is resolved once per request, also when it adds several accounts */
+static int _account_get_verified_appid(int pid, uid_t uid, char **verified_appid)
+{
+	int error_code = _ACCOUNT_ERROR_NONE;
+	char *appid = NULL;
+
+	appid = _account_get_client_appid(pid, uid);
+	if (!appid) {
+		// API caller cannot be recognized
+		ACCOUNT_ERROR("App id is not registered in account type DB");
+		return _ACCOUNT_ERROR_NOT_REGISTERED_PROVIDER;
 	}
-	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_svc_query_prepare() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
-	binding_count = _account_convert_account_to_sql(account, hstmt, query);
+	error_code = _account_get_client_represented_appid(appid, uid, verified_appid);
+	_ACCOUNT_FREE(appid);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("error_code = %d", error_code);
+		_ACCOUNT_FREE(*verified_appid);
+		return error_code;
+	}
 
-	_account_query_bind_text(hstmt, binding_count++, user_name);
-	_account_query_bind_text(hstmt, binding_count++, package_name);
+	return _ACCOUNT_ERROR_NONE;
+}
 
-	rc = _account_query_step(hstmt);
-	if (rc != SQLITE_DONE)
-		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+/* called inside a transaction, the caller rolls back when this fails */
+static int _account_insert_account(account_s *data, const char *verified_appid, uid_t uid, int *account_id)
+{
+	int error_code = _ACCOUNT_ERROR_NONE;
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
+	*account_id = _account_get_next_sequence(g_hAccountDB, ACCOUNT_TABLE);
+	data->id = *account_id;
+
+	if (verified_appid) {
+		_INFO("");
+		error_code = _account_check_duplicated(g_hAccountDB, data, verified_appid, uid);
+		if (error_code != _ACCOUNT_ERROR_NONE) {
+			ACCOUNT_DEBUG("_account_check_duplicated() fail(%d)", error_code);
+			return error_code;
+		}
+		if (!_account_check_add_more_account(verified_appid)) {
+			ACCOUNT_ERROR("No more account cannot be added");
+			return _ACCOUNT_ERROR_NOT_ALLOW_MULTIPLE;
+		}
 
-	/*update capability*/
-	error_code = _account_update_capability_by_user_name(account, user_name, package_name);
+		_ACCOUNT_FREE(data->package_name);
+		data->package_name = _account_dup_text(verified_appid);
+	}
 
-	/* update custom */
-	error_code = _account_update_custom(account, account->id);
+	if (!_account_check_add_more_account(data->package_name)) {
+		ACCOUNT_ERROR("No more account cannot be added");
+		return _ACCOUNT_ERROR_NOT_ALLOW_MULTIPLE;
+	}
 
-	return error_code;
-}
+	error_code = encrypt_access_token(data);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("encrypt_access_token fail(%d)", error_code);
+		return error_code;
+	}
 
-int _account_insert_to_db(account_s* account, int pid, uid_t uid, int *account_id)
-{
-	_INFO("");
-	int		error_code = _ACCOUNT_ERROR_NONE;
-	int		ret_transaction = 0;
+	error_code = _account_execute_insert_query(data);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("INSERT account fail(%d)", error_code);
+		return error_code;
+	}
 
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
-	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
-	ACCOUNT_RETURN_VAL((account_id != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT ID POINTER IS NULL"));
+	_INFO("");
+	error_code = _account_insert_capability(data, *account_id);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("INSERT capability fail(%d)", error_code);
+		return error_code;
+	}
 
-	if (!account->user_name && !account->display_name && !account->email_address) {
-		ACCOUNT_ERROR("One field should be set among user name, display name, email address\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+	_INFO("");
+	error_code = _account_insert_custom(data, *account_id);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("INSERT custom fail(%d)", error_code);
+		return error_code;
 	}
 
-	account_s *data = (account_s*)account;
-	ACCOUNT_SLOGD("(%s)-(%d) account_insert_to_db: begin_transaction.\n", __FUNCTION__, __LINE__);
+	return _ACCOUNT_ERROR_NONE;
+}
 
-	pthread_mutex_lock(&account_mutex);
+static int _account_begin_insert_transaction(void)
+{
+	int ret_transaction = 0;
 
 	/* transaction control required*/
 	ret_transaction = _account_begin_transaction(g_hAccountDB);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
-	if (ret_transaction == _ACCOUNT_ERROR_DATABASE_BUSY) {
-		ACCOUNT_ERROR("account insert:_account_begin_transaction fail %d\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	} else if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+	if (ret_transaction != _ACCOUNT_ERROR_NONE)
 		ACCOUNT_ERROR("account insert:_account_begin_transaction fail %d\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
-		return ret_transaction;
+
+	return ret_transaction;
+}
+
+int _account_insert_to_db(account_s* account, int pid, uid_t uid, int *account_id)
+{
+	_INFO("");
+	int		error_code = _ACCOUNT_ERROR_NONE;
+	int		ret_transaction = 0;
+	char	*verified_appid = NULL;
+
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
+	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
+	ACCOUNT_RETURN_VAL((account_id != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT ID POINTER IS NULL"));
+
+	if (!account->user_name && !account->display_name && !account->email_address) {
+		ACCOUNT_ERROR("One field should be set among user name, display name, email address\n");
+		return _ACCOUNT_ERROR_INVALID_PARAMETER;
 	}
 
-	*account_id = _account_get_next_sequence(g_hAccountDB, ACCOUNT_TABLE);
-	data->id = *account_id;
+	account_s *data = (account_s*)account;
+	ACCOUNT_SLOGD("(%s)-(%d) account_insert_to_db: begin_transaction.\n", __FUNCTION__, __LINE__);
 
-	char* appid = NULL;
-	appid = _account_get_current_appid(pid, uid);
+	error_code = _account_begin_insert_transaction();
+	if (error_code != _ACCOUNT_ERROR_NONE)
+		return error_code;
 
-	if (!appid) {
-		_INFO("");
-		// API caller cannot be recognized
+	error_code = _account_get_verified_appid(pid, uid, &verified_appid);
+	if (error_code != _ACCOUNT_ERROR_NONE) {
 		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
 		ACCOUNT_ERROR("App id is not registered in account type DB, transaction ret (%x)!!!!\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_NOT_REGISTERED_PROVIDER;
+		return error_code;
 	}
 
-	_INFO("");
-	char* verified_appid = NULL;
-	error_code  = _account_get_represented_appid_from_db(g_hAccountDB, g_hAccountGlobalDB, appid, uid, &verified_appid);//FIX
-	_ACCOUNT_FREE(appid);
+	error_code = _account_insert_account(data, verified_appid, uid, account_id);
+	_ACCOUNT_FREE(verified_appid);
 	if (error_code != _ACCOUNT_ERROR_NONE) {
-		_ERR("error_code = %d", error_code);
 		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("App id is not registered in account type DB, transaction ret (%x)!!!!\n", ret_transaction);
-		_ACCOUNT_FREE(verified_appid);
-		pthread_mutex_unlock(&account_mutex);
+		ACCOUNT_ERROR("account insert fail, rollback insert query(%x)!!!!\n", ret_transaction);
+		*account_id = -1;
 		return error_code;
 	}
 
-	if (verified_appid) {
-		_INFO("");
-		error_code = _account_check_duplicated(g_hAccountDB, data, verified_appid, uid);
-		if (error_code != _ACCOUNT_ERROR_NONE) {
-			_INFO("");
-			ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-			ACCOUNT_DEBUG("_account_check_duplicated(), rollback insert query(%x)!!!!\n", ret_transaction);
-			*account_id = -1;
-			pthread_mutex_unlock(&account_mutex);
-			return error_code;
-		}
-		if (!_account_check_add_more_account(verified_appid)) {
-			ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-			ACCOUNT_ERROR("No more account cannot be added, transaction ret (%x)!!!!\n", ret_transaction);
-			pthread_mutex_unlock(&account_mutex);
-			_ACCOUNT_FREE(verified_appid);
-			return _ACCOUNT_ERROR_NOT_ALLOW_MULTIPLE;
-		}
+	_INFO("");
 
-		_ACCOUNT_FREE(data->package_name);
-		data->package_name = _account_dup_text(verified_appid);
-		_ACCOUNT_FREE(verified_appid);
-	}
+	_account_end_transaction(g_hAccountDB, TRUE);
+	ACCOUNT_SLOGD("(%s)-(%d) account _end_transaction.\n", __FUNCTION__, __LINE__);
 
-	if (!_account_check_add_more_account(data->package_name)) {
-		_INFO("");
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("No more account cannot be added, transaction ret (%x)!!!!\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_NOT_ALLOW_MULTIPLE;
-	}
+	change_noti_queue(_ACCOUNT_NOTI_NAME_INSERT, *account_id, data->package_name);
+	_INFO("account _notification_send end.");
 
-	error_code = encrypt_access_token(data);
-	if (error_code != _ACCOUNT_ERROR_NONE) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("encrypt_access_token fail, rollback insert query(%x)!!!!\n", ret_transaction);
-		*account_id = -1;
-		pthread_mutex_unlock(&account_mutex);
-		return error_code;
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/*
+ * Adds every account of the list in one transaction, either all of them are stored or none.
+ * account_ids has room for one id per list entry.
+ */
+int _account_insert_list_to_db(GSList *account_list, int pid, uid_t uid, int *account_ids)
+{
+	int		error_code = _ACCOUNT_ERROR_NONE;
+	int		ret_transaction = 0;
+	int		index = 0;
+	char	*verified_appid = NULL;
+	GSList	*iter = NULL;
+
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
+	ACCOUNT_RETURN_VAL((account_list != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT LIST IS NULL"));
+	ACCOUNT_RETURN_VAL((account_ids != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT ID POINTER IS NULL"));
+
+	/* the whole batch is rejected before anything is written */
+	for (iter = account_list; iter != NULL; iter = g_slist_next(iter)) {
+		account_s *account = (account_s *)iter->data;
+		if (account == NULL || (!account->user_name && !account->display_name && !account->email_address)) {
+			ACCOUNT_ERROR("One field should be set among user name, display name, email address, index [%d]", index);
+			return _ACCOUNT_ERROR_INVALID_PARAMETER;
+		}
+		account_ids[index++] = -1;
 	}
 
-	error_code = _account_execute_insert_query(data);
+	error_code = _account_begin_insert_transaction();
+	if (error_code != _ACCOUNT_ERROR_NONE)
+		return error_code;
 
+	error_code = _account_get_verified_appid(pid, uid, &verified_appid);
 	if (error_code != _ACCOUNT_ERROR_NONE) {
-		_INFO("");
 		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("INSERT account fail, rollback insert query(%x)!!!!\n", ret_transaction);
-		*account_id = -1;
-		pthread_mutex_unlock(&account_mutex);
+		ACCOUNT_ERROR("App id is not registered in account type DB, transaction ret (%x)!!!!\n", ret_transaction);
 		return error_code;
 	}
 
-	_INFO("");
-	error_code = _account_insert_capability(data, *account_id);
-	if (error_code != _ACCOUNT_ERROR_NONE) {
-		_INFO("");
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("INSERT capability fail, rollback insert capability query(%x)!!!!\n", ret_transaction);
-		*account_id = -1;
-		pthread_mutex_unlock(&account_mutex);
-		return error_code;
+	/* duplicates inside the batch are caught too, earlier rows are visible to the checks */
+	for (iter = account_list, index = 0; iter != NULL; iter = g_slist_next(iter), index++) {
+		error_code = _account_insert_account((account_s *)iter->data, verified_appid, uid, &account_ids[index]);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			break;
 	}
+	_ACCOUNT_FREE(verified_appid);
 
-	_INFO("");
-	error_code = _account_insert_custom(data, *account_id);
 	if (error_code != _ACCOUNT_ERROR_NONE) {
 		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("INSERT custom fail, rollback insert capability query(%x)!!!!\n", ret_transaction);
-		*account_id = -1;
-		pthread_mutex_unlock(&account_mutex);
+		ACCOUNT_ERROR("account batch insert fail at [%d], rollback insert query(%x)!!!!\n", index, ret_transaction);
+		for (iter = account_list, index = 0; iter != NULL; iter = g_slist_next(iter), index++)
+			account_ids[index] = -1;
 		return error_code;
 	}
 
-	_INFO("");
-
-	pthread_mutex_unlock(&account_mutex);
-	_account_end_transaction(g_hAccountDB, TRUE);
-	ACCOUNT_SLOGD("(%s)-(%d) account _end_transaction.\n", __FUNCTION__, __LINE__);
+	ret_transaction = _account_end_transaction(g_hAccountDB, TRUE);
+	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("account batch insert commit fail(%x)", ret_transaction);
+		return ret_transaction;
+	}
+	_INFO("[%d] accounts inserted in one transaction", index);
 
-	char buf[64] = {0,};
-	ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_INSERT, *account_id);
-	_account_insert_delete_update_notification_send(buf);
-	_INFO("account _notification_send end.");
+	/* the whole batch goes out in one change signal */
+	for (iter = account_list, index = 0; iter != NULL; iter = g_slist_next(iter), index++)
+		change_noti_queue(_ACCOUNT_NOTI_NAME_INSERT, account_ids[index], ((account_s *)iter->data)->package_name);
 
 	return _ACCOUNT_ERROR_NONE;
 }
@@ -1146,8 +2213,8 @@ GSList* _account_get_capability_list_by_account_id(int account_id, int *error_co
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE account_id = %d", CAPABILITY_TABLE, account_id);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE account_id = ?", CAPABILITY_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -1155,11 +2222,15 @@ GSList* _account_get_capability_list_by_account_id(int account_id, int *error_co
 		return NULL;
 	}
 
+	_account_query_bind_int(hstmt, 1, account_id);
+
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR_P(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
 
 	account_capability_s* capability_record = NULL;
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		capability_record = (account_capability_s*) malloc(sizeof(account_capability_s));
 
@@ -1179,11 +2250,12 @@ GSList* _account_get_capability_list_by_account_id(int account_id, int *error_co
 
 		//ACCOUNT_CATCH_ERROR(cb_ret == TRUE, {}, _ACCOUNT_ERROR_NONE, ("Callback func returs FALSE, its iteration is stopped!!!!\n"));
 
-		capability_list = g_slist_append(capability_list, capability_record);
+		g_ptr_array_add(result_set, capability_record);
 		rc = _account_query_step(hstmt);
 	}
+	capability_list = _account_result_to_slist(capability_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	if (rc != _ACCOUNT_ERROR_NONE) {
 		_ERR("finalize error");
 		_account_gslist_capability_free(capability_list);
@@ -1197,17 +2269,17 @@ GSList* _account_get_capability_list_by_account_id(int account_id, int *error_co
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), { *error_code = rc; }, NULL, ("finalize error"));
 		hstmt = NULL;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
 
 	return capability_list;
 }
 
-static int _account_compare_old_record(account_s *new_account, int account_id)
+/* fills the unset fields of new_account from the stored record, handed out through old_record when asked for */
+static int _account_compare_old_record(account_s *new_account, int account_id, account_s **old_record)
 {
 	int				error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt	hstmt = NULL;
@@ -1227,8 +2299,11 @@ static int _account_compare_old_record(account_s *new_account, int account_id)
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id = %d", ACCOUNT_TABLE, account_id);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id = ?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	_account_query_bind_int(hstmt, 1, account_id);
 
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
@@ -1238,17 +2313,19 @@ static int _account_compare_old_record(account_s *new_account, int account_id)
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
+	/* an account without capabilities or custom rows is not an error */
 	// get capability
 	error_code = _account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, old_account->id, (void*)old_account);
-	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("account_query_capability_by_account_id error"));
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE || error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND), {}, error_code, ("account_query_capability_by_account_id error"));
 
 	// get custom text
 	error_code = _account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, old_account->id, (void*)old_account);
-	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("_account_query_custom_by_account_id error"));
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE || error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND), {}, error_code, ("_account_query_custom_by_account_id error"));
+	error_code = _ACCOUNT_ERROR_NONE;
 
 	// compare
 
@@ -1326,17 +2403,22 @@ static int _account_compare_old_record(account_s *new_account, int account_id)
 				new_account->user_data_int[i] = old_account->user_data_int[i];
 	}
 
+	if (old_record) {
+		*old_record = old_account;
+		old_account = NULL;
+	}
+
 CATCH:
 	if (old_account)
 		_account_free_account_with_items(old_account);
 
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
 
-	return _ACCOUNT_ERROR_NONE;
+	return error_code;
 }
 
 static int _account_get_package_name_from_account_id(int account_id, char **package_name)
@@ -1358,8 +2440,11 @@ static int _account_get_package_name_from_account_id(int account_id, char **pack
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id = %d", ACCOUNT_TABLE, account_id);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id = ?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	_account_query_bind_int(hstmt, 1, account_id);
 
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
@@ -1369,7 +2454,7 @@ static int _account_get_package_name_from_account_id(int account_id, char **pack
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -1381,7 +2466,7 @@ CATCH:
 		_account_free_account_with_items(old_account);
 
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -1390,12 +2475,11 @@ CATCH:
 
 }
 
-static int _account_update_account(int pid, uid_t uid, account_s *account, int account_id)
+static int _account_update_account(int pid, uid_t uid, account_s *account, int account_id, bool *changed)
 {
-	int				rc = 0, binding_count = 0;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				error_code = _ACCOUNT_ERROR_NONE, count = 0, ret_transaction = 0;
-	account_stmt	hstmt = NULL;
+	int				error_code = _ACCOUNT_ERROR_NONE, count = 0;
+	account_s		*old_account = NULL;
 
 	if (!account->package_name) {
 		ACCOUNT_ERROR("Package name is mandetory field, it can not be NULL!!!!\n");
@@ -1406,7 +2490,7 @@ static int _account_update_account(int pid, uid_t uid, account_s *account, int a
 	char* current_appid = NULL;
 	char *package_name = NULL;
 
-	current_appid = _account_get_current_appid(pid, uid);
+	current_appid = _account_get_client_appid(pid, uid);
 	error_code = _account_get_package_name_from_account_id(account_id, &package_name);
 
 	if (error_code != _ACCOUNT_ERROR_NONE || package_name == NULL) {
@@ -1416,7 +2500,7 @@ static int _account_update_account(int pid, uid_t uid, account_s *account, int a
 		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 	}
 
-	error_code = _account_check_appid_group_with_package_name(current_appid, package_name, uid);
+	error_code = _account_check_client_app_group(current_appid, package_name, uid);
 	ACCOUNT_DEBUG("UPDATE:account_id[%d],current_appid[%s]package_name[%s]", account_id, current_appid, package_name);	// TODO: remove the log later.
 
 	_ACCOUNT_FREE(current_appid);
@@ -1433,7 +2517,7 @@ static int _account_update_account(int pid, uid_t uid, account_s *account, int a
 		return error_code;
 	}
 
-	error_code = _account_compare_old_record(account, account_id);
+	error_code = _account_compare_old_record(account, account_id, &old_account);
 	if (error_code != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("_account_compare_old_record fail\n");
 		return error_code;
@@ -1441,94 +2525,55 @@ static int _account_update_account(int pid, uid_t uid, account_s *account, int a
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	} else if (_account_db_err_code(g_hAccountDB) == SQLITE_BUSY) {
 		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
+		error_code = _ACCOUNT_ERROR_DATABASE_BUSY;
+		goto CATCH;
 	}
 
 	if (!account->user_name && !account->display_name && !account->email_address) {
 		ACCOUNT_ERROR("One field should be set among user name, display name, email address\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+		error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+		goto CATCH;
 	}
 
 	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id = %d ", ACCOUNT_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id = ? ", ACCOUNT_TABLE);
 
-	count = _account_get_record_count(g_hAccountDB, query);
+	count = _account_get_record_count_by_int(g_hAccountDB, query, account_id);
 	if (count <= 0) {
 		ACCOUNT_DEBUG(" Account record not found, count = %d\n", count);
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-	}
-
-	/* transaction control required*/
-	ret_transaction = _account_begin_transaction(g_hAccountDB);
-	if (ret_transaction == _ACCOUNT_ERROR_DATABASE_BUSY) {
-		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
-
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET user_name=?, email_address =?, display_name =?, "
-			"icon_path =?, source =?, package_name =? , access_token =?, domain_name =?, auth_type =?, secret =?, sync_support =?,"
-			"txt_custom0=?, txt_custom1=?, txt_custom2=?, txt_custom3=?, txt_custom4=?, "
-			"int_custom0=?, int_custom1=?, int_custom2=?, int_custom3=?, int_custom4=? WHERE _id=? ", ACCOUNT_TABLE);
-
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
-
-	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_svc_query_prepare() failed(%s)(%x).\n", _account_db_err_msg(g_hAccountDB), _account_end_transaction(g_hAccountDB, FALSE)));
-
-	binding_count = _account_convert_account_to_sql(account, hstmt, query);
-	_account_query_bind_int(hstmt, binding_count++, account_id);
-
-	rc = _account_query_step(hstmt);
-	if (rc != SQLITE_DONE)
-		ACCOUNT_SLOGE("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
-
-	_INFO("update query=%s", query);
-
-	/*update capability*/
-	error_code = _account_update_capability(account, account_id);
-	if (error_code != _ACCOUNT_ERROR_NONE && error_code != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("update capability Failed, trying to roll back(%x) !!!\n", ret_transaction);
-		return error_code;
+		error_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+		goto CATCH;
 	}
 
-	/* update custom */
-	error_code = _account_update_custom(account, account_id);
-	if (error_code != _ACCOUNT_ERROR_NONE && error_code != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("update capability Failed, trying to roll back(%x) !!!\n", ret_transaction);
-		return error_code;
+	error_code = _account_update_changed_fields(account, old_account, account_id, changed);
+	if (*changed) {
+		int ret_transaction = _account_end_transaction(g_hAccountDB, error_code == _ACCOUNT_ERROR_NONE);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			ACCOUNT_ERROR("update Failed, trying to roll back(%x) !!!\n", ret_transaction);
+	} else if (error_code == _ACCOUNT_ERROR_NONE) {
+		_INFO("account [%d] is unchanged, nothing written", account_id);
 	}
 
-	ret_transaction = _account_end_transaction(g_hAccountDB, TRUE);
-
 	_INFO("update end");
 
+CATCH:
+	if (old_account)
+		_account_free_account_with_items(old_account);
+
 	return error_code;
 }
 
 
-static int _account_update_account_ex(account_s *account, int account_id)
+static int _account_update_account_ex(account_s *account, int account_id, bool *changed)
 {
-	int				rc = 0, binding_count = 0;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				error_code = _ACCOUNT_ERROR_NONE, count = 0, ret_transaction = 0;
-	account_stmt	hstmt = NULL;
+	int				error_code = _ACCOUNT_ERROR_NONE, count = 0;
+	account_s		*old_account = NULL;
 
 	if (!account->package_name) {
 		ACCOUNT_ERROR("Package name is mandetory field, it can not be NULL!!!!\n");
@@ -1541,7 +2586,7 @@ static int _account_update_account_ex(account_s *account, int account_id)
 		return error_code;
 	}
 
-	error_code = _account_compare_old_record(account, account_id);
+	error_code = _account_compare_old_record(account, account_id, &old_account);
 	if (error_code != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("_account_compare_old_record fail\n");
 		return error_code;
@@ -1549,86 +2594,41 @@ static int _account_update_account_ex(account_s *account, int account_id)
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	}
 
 	if (!account->user_name && !account->display_name && !account->email_address) {
 		ACCOUNT_ERROR("One field should be set among user name, display name, email address\n");
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+		error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+		goto CATCH;
 	}
 
 	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id = %d ", ACCOUNT_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id = ? ", ACCOUNT_TABLE);
 
-	count = _account_get_record_count(g_hAccountDB, query);
+	count = _account_get_record_count_by_int(g_hAccountDB, query, account_id);
 	if (count <= 0) {
 		ACCOUNT_DEBUG(" Account record not found, count = %d\n", count);
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-	}
-
-	/* transaction control required*/
-	ret_transaction = _account_begin_transaction(g_hAccountDB);
-	if (ret_transaction == _ACCOUNT_ERROR_DATABASE_BUSY) {
-		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
-
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET user_name=?, email_address =?, display_name =?, "
-			"icon_path =?, source =?, package_name =? , access_token =?, domain_name =?, auth_type =?, secret =?, sync_support =?,"
-			"txt_custom0=?, txt_custom1=?, txt_custom2=?, txt_custom3=?, txt_custom4=?, "
-			"int_custom0=?, int_custom1=?, int_custom2=?, int_custom3=?, int_custom4=? WHERE _id=? ", ACCOUNT_TABLE);
-
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
-
-	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_svc_query_prepare() failed(%s)(%x).\n", _account_db_err_msg(g_hAccountDB), _account_end_transaction(g_hAccountDB, FALSE)));
-
-	_INFO("account_update_to_db_by_id_ex_p : before convert() : account_id[%d], user_name=%s", account->id, account->user_name);
-	binding_count = _account_convert_account_to_sql(account, hstmt, query);
-	_INFO("account_update_to_db_by_id_ex_p : after convert() : account_id[%d], user_name=%s", account->id, account->user_name);
-	_INFO("account_update_to_db_by_id_ex_p : before bind()");
-	rc = _account_query_bind_int(hstmt, binding_count++, account_id);
-	_INFO("account_update_to_db_by_id_ex_p : after bind() : ret = %d", rc);
-
-	rc = _account_query_step(hstmt);
-	if (rc != SQLITE_DONE)
-		ACCOUNT_SLOGE("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-	_INFO("account_update_to_db_by_id_ex_p : after query_step() : ret = %d", rc);
-
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
-	_INFO("account_update_to_db_by_id_ex_p : after query_filnalize() : ret = %d", rc);
-
-	_INFO("account_update_to_db_by_id_ex_p : before update_capability()");
-	/*update capability*/
-	error_code = _account_update_capability(account, account_id);
-	if (error_code != _ACCOUNT_ERROR_NONE && error_code != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("update capability Failed, trying to roll back(%x) !!!\n", ret_transaction);
-		return error_code;
+		error_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+		goto CATCH;
 	}
-	_INFO("account_update_to_db_by_id_ex_p : after update_capability()");
 
-	_INFO("account_update_to_db_by_id_ex_p : before update_custom()");
-	/* update custom */
-	error_code = _account_update_custom(account, account_id);
-	if (error_code != _ACCOUNT_ERROR_NONE && error_code != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		ret_transaction = _account_end_transaction(g_hAccountDB, FALSE);
-		ACCOUNT_ERROR("update capability Failed, trying to roll back(%x) !!!\n", ret_transaction);
-		return error_code;
+	_INFO("account_update_to_db_by_id_ex_p : before update_changed_fields() : account_id[%d], user_name=%s", account->id, account->user_name);
+	error_code = _account_update_changed_fields(account, old_account, account_id, changed);
+	if (*changed) {
+		int ret_transaction = _account_end_transaction(g_hAccountDB, error_code == _ACCOUNT_ERROR_NONE);
+		if (error_code != _ACCOUNT_ERROR_NONE)
+			ACCOUNT_ERROR("update Failed, trying to roll back(%x) !!!\n", ret_transaction);
+	} else if (error_code == _ACCOUNT_ERROR_NONE) {
+		_INFO("account [%d] is unchanged, nothing written", account_id);
 	}
-	_INFO("account_update_to_db_by_id_ex_p : after update_custom()");
+	_INFO("account_update_to_db_by_id_ex_p : after update_changed_fields() : ret = %d", error_code);
 
-	ret_transaction = _account_end_transaction(g_hAccountDB, TRUE);
+CATCH:
+	if (old_account)
+		_account_free_account_with_items(old_account);
 
 	return error_code;
 }
@@ -1641,21 +2641,21 @@ int _account_update_to_db_by_id(int pid, uid_t uid, account_s* account, int acco
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 	int	error_code = _ACCOUNT_ERROR_NONE;
 	account_s* data = (account_s*)account;
+	bool changed = false;
 
-	pthread_mutex_lock(&account_mutex);
 
-	error_code = _account_update_account(pid, uid, data, account_id);
+	error_code = _account_update_account(pid, uid, data, account_id, &changed);
 
 	if (error_code != _ACCOUNT_ERROR_NONE) {
-		pthread_mutex_unlock(&account_mutex);
 		return error_code;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
+	/* an identical push leaves the record as it was, nobody needs to hear about it */
+	if (!changed)
+		return _ACCOUNT_ERROR_NONE;
+
 
-	char buf[64] = {0,};
-	ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_UPDATE, account_id);
-	_account_insert_delete_update_notification_send(buf);
+	_account_change_noti_queue(_ACCOUNT_NOTI_NAME_UPDATE, account_id, NULL);
 
 	return _ACCOUNT_ERROR_NONE;
 }
@@ -1667,23 +2667,22 @@ int _account_update_to_db_by_id_ex(account_s* account, int account_id)
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 	int	error_code = _ACCOUNT_ERROR_NONE;
 	account_s* data = account;
+	bool changed = false;
 
-	pthread_mutex_lock(&account_mutex);
 
 	_INFO("before update_account_ex() : account_id[%d], user_name=%s", account_id, data->user_name);
-	error_code = _account_update_account_ex(data, account_id);
+	error_code = _account_update_account_ex(data, account_id, &changed);
 	_INFO("after update_account_ex() : account_id[%d], user_name=%s", account_id, data->user_name);
 
 	if (error_code != _ACCOUNT_ERROR_NONE) {
-		pthread_mutex_unlock(&account_mutex);
 		return error_code;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
+	if (!changed)
+		return _ACCOUNT_ERROR_NONE;
+
 
-	char buf[64] = {0,};
-	ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_UPDATE, account_id);
-	_account_insert_delete_update_notification_send(buf);
+	_account_change_noti_queue(_ACCOUNT_NOTI_NAME_UPDATE, account_id, NULL);
 
 	return _ACCOUNT_ERROR_NONE;
 }
@@ -1696,87 +2695,308 @@ int _account_update_to_db_by_user_name(int pid, uid_t uid, account_s* account, c
 
 	int	error_code = _ACCOUNT_ERROR_NONE;
 	account_s *data = (account_s*)account;
+	bool changed = false;
 
-	pthread_mutex_lock(&account_mutex);
-
-	error_code = _account_update_account_by_user_name(pid, uid, data, user_name, package_name);
 
-	pthread_mutex_unlock(&account_mutex);
+	error_code = _account_update_account_by_user_name(pid, uid, data, user_name, package_name, &changed);
 
-	char buf[64] = {0,};
-	ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_UPDATE, data->id);
-	_account_insert_delete_update_notification_send(buf);
+	/* nothing changed when the update failed or the record already matched */
+	if (error_code == _ACCOUNT_ERROR_NONE && changed)
+		change_noti_queue(_ACCOUNT_NOTI_NAME_UPDATE, data->id, package_name);
 
 	return error_code;
 }
 
-GSList* _account_db_query_all(int pid, uid_t uid)
+typedef struct _account_page_filter_s {
+	const char *name;
+	const char *condition;	/* binds the text, then the value when it has a second placeholder */
+	bool binds_value;
+} account_page_filter_s;
+
+/* same matches as the query_all and query_account_by_* methods, in _id order */
+static const account_page_filter_s account_page_filters[] = {
+	{ "all", "", false },
+	{ "user_name", "user_name = ? AND ", false },
+	{ "package_name", "package_name = ? AND ", false },
+	{ "capability", "_id IN (SELECT account_id from " CAPABILITY_TABLE " WHERE key=? AND value=?) AND ", true },
+	{ "capability_type", "_id IN (SELECT account_id from " CAPABILITY_TABLE " WHERE key=?) AND ", false },
+};
+
+static const account_page_filter_s *_account_page_filter_lookup(const char *filter, const char *text, int value)
+{
+	unsigned int i = 0;
+
+	ACCOUNT_RETURN_VAL((filter != NULL), {}, NULL, ("FILTER IS NULL"));
+
+	for (i = 0; i < G_N_ELEMENTS(account_page_filters); i++) {
+		const account_page_filter_s *page_filter = &account_page_filters[i];
+
+		if (strcmp(page_filter->name, filter) != 0)
+			continue;
+
+		ACCOUNT_RETURN_VAL((page_filter->condition[0] == '\0' || text != NULL), {}, NULL, ("filter [%s] needs a text", filter));
+		ACCOUNT_RETURN_VAL((!page_filter->binds_value || (value >= 0 && value < _ACCOUNT_CAPABILITY_STATE_MAX)), {}, NULL,
+				("capability value [%d] is out of range", value));
+
+		return page_filter;
+	}
+
+	ACCOUNT_ERROR("unknown filter [%s]", filter);
+
+	return NULL;
+}
+
+/* the statement selects the accounts of page_filter, or the child rows of those accounts */
+static account_stmt _account_stream_prepare(const char *select, const account_page_filter_s *page_filter, const char *text, int value,
+		int after_id, int limit)
 {
-	//int			error_code = _ACCOUNT_ERROR_NONE;
-	account_stmt	hstmt = NULL;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				rc = 0;
-	GSList			*account_list = NULL;
+	account_stmt	hstmt = NULL;
+	int				binding_count = 1;
 
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, NULL, ("The database isn't connected."));
+	ACCOUNT_SNPRINTF(query, sizeof(query), select, page_filter->condition);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	if (hstmt == NULL)
+		return NULL;
 
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
+	if (page_filter->condition[0] != '\0')
+		_account_query_bind_text(hstmt, binding_count++, text);
+	if (page_filter->binds_value)
+		_account_query_bind_int(hstmt, binding_count++, value);
+	_account_query_bind_int(hstmt, binding_count++, after_id);
+	_account_query_bind_int(hstmt, binding_count++, limit);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s ", ACCOUNT_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	return hstmt;
+}
+
+static char *_account_scope_column_text(request_scope_s *scope, account_stmt hstmt, int column)
+{
+	return request_scope_strdup(scope, (const char *)sqlite3_column_text(hstmt, column));
+}
+
+/* a row of SELECT * FROM account, decoded in table order with the strings carved from scope */
+static account_s *_account_scope_convert_column(request_scope_s *scope, account_stmt hstmt)
+{
+	account_s *account = (account_s *)request_scope_alloc(scope, sizeof(account_s));
+	int column = 0;
+	int i = 0;
+
+	account->id = sqlite3_column_int(hstmt, column++);
+	account->user_name = _account_scope_column_text(scope, hstmt, column++);
+	account->email_address = _account_scope_column_text(scope, hstmt, column++);
+	account->display_name = _account_scope_column_text(scope, hstmt, column++);
+	account->icon_path = _account_scope_column_text(scope, hstmt, column++);
+	account->source = _account_scope_column_text(scope, hstmt, column++);
+	account->package_name = _account_scope_column_text(scope, hstmt, column++);
+	account->access_token = _account_scope_column_text(scope, hstmt, column++);
+	account->domain_name = _account_scope_column_text(scope, hstmt, column++);
+	account->auth_type = sqlite3_column_int(hstmt, column++);
+	account->secret = sqlite3_column_int(hstmt, column++);
+	account->sync_support = sqlite3_column_int(hstmt, column++);
+
+	for (i = 0; i < USER_TXT_CNT; i++)
+		account->user_data_txt[i] = _account_scope_column_text(scope, hstmt, column++);
+	for (i = 0; i < USER_INT_CNT; i++)
+		account->user_data_int[i] = sqlite3_column_int(hstmt, column++);
+
+	return account;
+}
+
+/* takes a (account_id, key, value) row, the list is built backwards and reversed once the account is read */
+static void _account_scope_add_capability(request_scope_s *scope, account_s *account, account_stmt hstmt)
+{
+	account_capability_s *cap_data = (account_capability_s *)request_scope_alloc(scope, sizeof(account_capability_s));
+
+	cap_data->type = _account_scope_column_text(scope, hstmt, 1);
+	cap_data->value = sqlite3_column_int(hstmt, 2);
+
+	account->capablity_list = request_scope_slist_prepend(scope, account->capablity_list, cap_data);
+}
+
+/* takes a (AccountId, Key, Value) row, built backwards the same way */
+static void _account_scope_add_custom(request_scope_s *scope, account_s *account, account_stmt hstmt)
+{
+	account_custom_s *custom_data = (account_custom_s *)request_scope_alloc(scope, sizeof(account_custom_s));
+
+	custom_data->account_id = account->id;
+	/* both live as long as the scope, no copy needed */
+	custom_data->app_id = account->package_name;
+	custom_data->key = _account_scope_column_text(scope, hstmt, 1);
+	custom_data->value = _account_scope_column_text(scope, hstmt, 2);
+
+	account->custom_list = request_scope_slist_prepend(scope, account->custom_list, custom_data);
+}
+
+/* as _remove_sensitive_info_from_non_owning_account(), but the carved token is dropped rather than freed */
+static void _account_scope_remove_sensitive_info(account_s *account, const char *client_appid)
+{
+	if (account->package_name == NULL)
+		return;
+
+	if (client_appid == NULL || strcmp(account->package_name, client_appid) != 0)
+		account->access_token = NULL;
+}
+
+/*
+ * Hands the accounts of page_filter with an _id above after_id to callback in _id order, at most limit (-1 for all) of them.
+ * Only the account being handed out is decoded. Its capability and custom rows come from two more statements,
+ * sorted the same way and walked in step with the account rows, instead of being collected per account first.
+ * Each account is carved from scope and handed back to it once callback returns, so a stream of
+ * any length uses the same block or two.
+ * *last_id is the last account callback took, *more tells whether accounts are left after it.
+ */
+static int _account_stream_accounts(request_scope_s *scope, int pid, uid_t uid, const account_page_filter_s *page_filter, const char *text, int value,
+		int after_id, int limit, account_page_cb callback, void *user_data, int *last_id, bool *more)
+{
+	account_stmt	hstmt = NULL;
+	account_stmt	cap_stmt = NULL;
+	account_stmt	custom_stmt = NULL;
+	account_s		*account_record = NULL;
+	request_scope_mark_s	mark;
+	char			*client_appid = NULL;
+	int				rc = 0, cap_rc = 0, custom_rc = 0, count = 0;
+	int				error_code = _ACCOUNT_ERROR_NONE;
+	/* one row past a limited page tells whether another page follows */
+	int				row_limit = limit < 0 ? -1 : limit + 1;
+
+	*last_id = 0;
+	*more = false;
+
+	hstmt = _account_stream_prepare("SELECT * FROM " ACCOUNT_TABLE " WHERE %s_id > ? ORDER BY _id LIMIT ?",
+			page_filter, text, value, after_id, row_limit);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return NULL;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	}
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	cap_stmt = _account_stream_prepare("SELECT account_id, key, value FROM " CAPABILITY_TABLE " WHERE account_id IN "
+			"(SELECT _id FROM " ACCOUNT_TABLE " WHERE %s_id > ? ORDER BY _id LIMIT ?) ORDER BY account_id, _id",
+			page_filter, text, value, after_id, row_limit);
+	ACCOUNT_CATCH_ERROR(cap_stmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	custom_stmt = _account_stream_prepare("SELECT AccountId, Key, Value FROM " ACCOUNT_CUSTOM_TABLE " WHERE AccountId IN "
+			"(SELECT _id FROM " ACCOUNT_TABLE " WHERE %s_id > ? ORDER BY _id LIMIT ?) ORDER BY AccountId, rowid",
+			page_filter, text, value, after_id, row_limit);
+	ACCOUNT_CATCH_ERROR(custom_stmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	/* asked once for the whole stream rather than for every account */
+	client_appid = _account_get_client_appid(pid, uid);
+	request_scope_mark(scope, &mark);
+
+	cap_rc = _account_query_step(cap_stmt);
+	custom_rc = _account_query_step(custom_stmt);
 
 	rc = _account_query_step(hstmt);
+	while (rc == SQLITE_ROW) {
+		if (limit >= 0 && count == limit) {
+			*more = true;
+			break;
+		}
 
-	account_s *account_record = NULL;
+		account_record = _account_scope_convert_column(scope, hstmt);
 
-	if (rc != SQLITE_ROW) {
-		_ERR("The record isn't found");
-		goto CATCH;
-	}
+		/* child rows of accounts that are gone are skipped over */
+		while (cap_rc == SQLITE_ROW && sqlite3_column_int(cap_stmt, 0) < account_record->id)
+			cap_rc = _account_query_step(cap_stmt);
+		while (cap_rc == SQLITE_ROW && sqlite3_column_int(cap_stmt, 0) == account_record->id) {
+			_account_scope_add_capability(scope, account_record, cap_stmt);
+			cap_rc = _account_query_step(cap_stmt);
+		}
+		account_record->capablity_list = g_slist_reverse(account_record->capablity_list);
 
-	while (rc == SQLITE_ROW) {
-		account_record = (account_s*) malloc(sizeof(account_s));
+		while (custom_rc == SQLITE_ROW && sqlite3_column_int(custom_stmt, 0) < account_record->id)
+			custom_rc = _account_query_step(custom_stmt);
+		while (custom_rc == SQLITE_ROW && sqlite3_column_int(custom_stmt, 0) == account_record->id) {
+			_account_scope_add_custom(scope, account_record, custom_stmt);
+			custom_rc = _account_query_step(custom_stmt);
+		}
+		account_record->custom_list = g_slist_reverse(account_record->custom_list);
 
-		if (account_record == NULL) {
-			ACCOUNT_FATAL("malloc Failed");
+		_account_scope_remove_sensitive_info(account_record, client_appid);
+
+		*last_id = account_record->id;
+		count++;
+
+		if (!callback(account_record, user_data)) {
+			*more = _account_query_step(hstmt) == SQLITE_ROW;
 			break;
 		}
 
-		ACCOUNT_MEMSET(account_record, 0x00, sizeof(account_s));
-		_account_convert_column_to_account(hstmt, account_record);
-		account_list = g_slist_append(account_list, account_record);
+		/* callback is done with it, the next account takes its memory */
+		request_scope_reset(scope, &mark);
+
 		rc = _account_query_step(hstmt);
 	}
+	ACCOUNT_CATCH_ERROR((rc == SQLITE_ROW || rc == SQLITE_DONE), {}, _ACCOUNT_ERROR_DB_FAILED,
+			("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB)));
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_gslist_account_free(account_list); }, NULL, ("finalize error"));
-	hstmt = NULL;
+	_INFO("[%d] accounts of filter [%s] streamed", count, page_filter->name);
 
-	GSList* iter;
+CATCH:
+	_ACCOUNT_FREE(client_appid);
 
-	for (iter = account_list; iter != NULL; iter = g_slist_next(iter)) {
-		account_s *account = NULL;
-		account = (account_s*)iter->data;
-		_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, account->id, (void*)account);
-		_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, account->id, (void*)account);
-	}
+	if (hstmt != NULL)
+		_account_query_release(hstmt);
+	if (cap_stmt != NULL)
+		_account_query_release(cap_stmt);
+	if (custom_stmt != NULL)
+		_account_query_release(custom_stmt);
 
-CATCH:
-	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_gslist_account_free(account_list); }, NULL, ("finalize error"));
-		hstmt = NULL;
-	}
+	return error_code;
+}
+
+/*
+ * Hands every account of filter to callback in _id order, nothing is collected in between.
+ * The filter names and arguments are the ones of _account_query_page().
+ */
+int _account_query_stream(request_scope_s *scope, int pid, uid_t uid, const char *filter, const char *text, int value,
+		account_page_cb callback, void *user_data)
+{
+	const account_page_filter_s *page_filter = NULL;
+	int last_id = 0;
+	bool more = false;
+
+	ACCOUNT_RETURN_VAL((callback != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("CALLBACK IS NULL"));
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
+
+	page_filter = _account_page_filter_lookup(filter, text, value);
+	ACCOUNT_RETURN_VAL((page_filter != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("invalid filter"));
 
-	if (account_list)
-		_remove_sensitive_info_from_non_owning_account_slist(account_list, pid, uid);
+	return _account_stream_accounts(scope, pid, uid, page_filter, text, value, 0, -1, callback, user_data, &last_id, &more);
+}
+
+/*
+ * Hands the accounts of filter with an _id above after_id to callback in _id order, at most limit of them.
+ * *next_cursor is the after_id of the next page, 0 after the last one.
+ */
+int _account_query_page(request_scope_s *scope, int pid, uid_t uid, const char *filter, const char *text, int value,
+		int after_id, int limit, account_page_cb callback, void *user_data, int *next_cursor)
+{
+	const account_page_filter_s *page_filter = NULL;
+	int				error_code = _ACCOUNT_ERROR_NONE;
+	int				last_id = 0;
+	bool			more = false;
+
+	ACCOUNT_RETURN_VAL((callback != NULL && next_cursor != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("CALLBACK IS NULL"));
+	ACCOUNT_RETURN_VAL((after_id >= 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("CURSOR IS LESS THAN 0"));
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
-	return account_list;
+	*next_cursor = 0;
+
+	page_filter = _account_page_filter_lookup(filter, text, value);
+	ACCOUNT_RETURN_VAL((page_filter != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("invalid filter"));
+
+	if (limit <= 0 || limit > ACCOUNT_QUERY_PAGE_MAX)
+		limit = ACCOUNT_QUERY_PAGE_MAX;
+
+	error_code = _account_stream_accounts(scope, pid, uid, page_filter, text, value, after_id, limit, callback, user_data, &last_id, &more);
+	if (error_code == _ACCOUNT_ERROR_NONE && more)
+		*next_cursor = last_id;
+
+	return error_code;
 }
 
 int _account_update_sync_status_by_id(uid_t uid, int account_db_id, const int sync_status)
@@ -1794,37 +3014,34 @@ int _account_update_sync_status_by_id(uid_t uid, int account_db_id, const int sy
 		return _ACCOUNT_ERROR_INVALID_PARAMETER;
 	}
 
-	pthread_mutex_lock(&account_mutex);
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=%d", ACCOUNT_TABLE, account_db_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=?", ACCOUNT_TABLE);
 
-	rc = _account_get_record_count(g_hAccountDB, query);
+	rc = _account_get_record_count_by_int(g_hAccountDB, query, account_db_id);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	if (rc <= 0) {
 		ACCOUNT_SLOGE("account_update_sync_status_by_id : related account item is not existed rc=%d , %s", rc, _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
 		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 	}
 
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET sync_support=? WHERE _id = %d", ACCOUNT_TABLE, account_db_id);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET sync_support=? WHERE _id = ?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
-	_account_query_bind_int(hstmt, count, sync_status);
+	_account_query_bind_int(hstmt, count++, sync_status);
+	_account_query_bind_int(hstmt, count++, account_db_id);
 
 	rc = _account_query_step(hstmt);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
@@ -1832,479 +3049,332 @@ int _account_update_sync_status_by_id(uid_t uid, int account_db_id, const int sy
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_DB_FAILED,
 				("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB)));
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	if (rc != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("_account_query_finalize error");
-		pthread_mutex_unlock(&account_mutex);
 		return rc;
 	}
 
-	char buf[64] = {0,};
-	ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_SYNC_UPDATE, account_db_id);
-	_account_insert_delete_update_notification_send(buf);
+	_account_change_noti_queue(_ACCOUNT_NOTI_NAME_SYNC_UPDATE, account_db_id, NULL);
 
 	hstmt = NULL;
 	error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		pthread_mutex_unlock(&account_mutex);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
 
 	return error_code;
 }
 
-int _account_query_account_by_account_id(int pid, uid_t uid, int account_db_id, account_s *account_record)
-{
-	_INFO("_account_query_account_by_account_id() start, account_db_id=[%d]", account_db_id);
+typedef struct _account_patch_field_s {
+	unsigned int field;
+	const char *name;
+	bool is_text;
+	int max;	/* exclusive upper bound of an integer field, 0 for none */
+} account_patch_field_s;
+
+/* package_name is not in here, an account stays with the package that added it */
+static const account_patch_field_s account_patch_fields[] = {
+	{ _ACCOUNT_PATCH_USER_NAME, "user_name", true, 0 },
+	{ _ACCOUNT_PATCH_EMAIL_ADDRESS, "email_address", true, 0 },
+	{ _ACCOUNT_PATCH_DISPLAY_NAME, "display_name", true, 0 },
+	{ _ACCOUNT_PATCH_ICON_PATH, "icon_path", true, 0 },
+	{ _ACCOUNT_PATCH_SOURCE, "source", true, 0 },
+	{ _ACCOUNT_PATCH_ACCESS_TOKEN, "access_token", true, 0 },
+	{ _ACCOUNT_PATCH_DOMAIN_NAME, "domain_name", true, 0 },
+	{ _ACCOUNT_PATCH_AUTH_TYPE, "auth_type", false, _ACCOUNT_AUTH_TYPE_MAX },
+	{ _ACCOUNT_PATCH_SECRET, "secret", false, _ACCOUNT_SECRECY_MAX },
+	{ _ACCOUNT_PATCH_SYNC_SUPPORT, "sync_support", false, _ACCOUNT_SYNC_MAX },
+	{ _ACCOUNT_PATCH_USER_TEXT0 << 0, "txt_custom0", true, 0 },
+	{ _ACCOUNT_PATCH_USER_TEXT0 << 1, "txt_custom1", true, 0 },
+	{ _ACCOUNT_PATCH_USER_TEXT0 << 2, "txt_custom2", true, 0 },
+	{ _ACCOUNT_PATCH_USER_TEXT0 << 3, "txt_custom3", true, 0 },
+	{ _ACCOUNT_PATCH_USER_TEXT0 << 4, "txt_custom4", true, 0 },
+	{ _ACCOUNT_PATCH_USER_INT0 << 0, "int_custom0", false, 0 },
+	{ _ACCOUNT_PATCH_USER_INT0 << 1, "int_custom1", false, 0 },
+	{ _ACCOUNT_PATCH_USER_INT0 << 2, "int_custom2", false, 0 },
+	{ _ACCOUNT_PATCH_USER_INT0 << 3, "int_custom3", false, 0 },
+	{ _ACCOUNT_PATCH_USER_INT0 << 4, "int_custom4", false, 0 },
+};
 
+/*
+ * Sets the fields in field_mask to the matching entries of values (a{sv}) with one UPDATE.
+ * Every field in field_mask has to be in values, texts as s and integers as i.
+ * The user, email and display name can not be set to an empty text.
+ */
+int _account_patch_by_id(int pid, uid_t uid, int account_db_id, unsigned int field_mask, GVariant *values)
+{
+	account_changed_column_s columns[ACCOUNT_UPDATE_COLUMN_CNT];
+	account_s		*token_account = NULL;
+	const char		*user_name = NULL;
+	char			*current_appid = NULL;
+	char			*package_name = NULL;
 	int				error_code = _ACCOUNT_ERROR_NONE;
-	account_stmt	hstmt = NULL;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				rc = 0;
+	int				column_count = 0, changes = 0;
+	bool			in_transaction = false;
+	unsigned int	i = 0;
 
 	ACCOUNT_RETURN_VAL((account_db_id > 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT INDEX IS LESS THAN 0"));
-	ACCOUNT_RETURN_VAL(account_record != NULL, {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT IS NULL"));
+	ACCOUNT_RETURN_VAL((values != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("VALUES ARE NULL"));
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-
-	ACCOUNT_DEBUG("starting db operations");
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id = %d", ACCOUNT_TABLE, account_db_id);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	rc = _account_db_err_code(g_hAccountDB);
-	_INFO("after _account_prepare_query, rc=[%d]", rc);
-
-	if (rc == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
-
-	ACCOUNT_DEBUG("before _account_query_step");
-	rc = _account_query_step(hstmt);
-	ACCOUNT_DEBUG("after _account_query_step returned [%d]", rc);
-	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
-
-	while (rc == SQLITE_ROW) {
-		ACCOUNT_DEBUG("before _account_convert_column_to_account");
-		_account_convert_column_to_account(hstmt, account_record);
-		ACCOUNT_DEBUG("after _account_convert_column_to_account");
-		ACCOUNT_DEBUG("user_name = %s, user_txt[0] = %s, user_int[1] = %d", account_record->user_name, account_record->user_data_txt[0], account_record->user_data_int[1]);
-		rc = _account_query_step(hstmt);
-	}
-
-	ACCOUNT_DEBUG("account_record->id=[%d]", account_record->id);
-
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-
-	ACCOUNT_DEBUG("before _account_query_capability_by_account_id");
-	_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, account_record->id, (void*)account_record);
-	ACCOUNT_DEBUG("after _account_query_capability_by_account_id");
-
-	ACCOUNT_DEBUG("before _account_query_custom_by_account_id");
-	_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, account_record->id, (void*)account_record);
-	ACCOUNT_DEBUG("after _account_query_custom_by_account_id");
-
-	hstmt = NULL;
-	error_code = _ACCOUNT_ERROR_NONE;
-
-CATCH:
-	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-		hstmt = NULL;
-	}
-
-	if (account_record)
-		_remove_sensitive_info_from_non_owning_account(account_record, pid, uid);
-
-	pthread_mutex_unlock(&account_mutex);
-	ACCOUNT_DEBUG("_account_query_account_by_account_id end [%d]", error_code);
-
-	return error_code;
-}
-
-GList* _account_query_account_by_user_name(int pid, uid_t uid, const char *user_name, int *error_code)
-{
-	*error_code = _ACCOUNT_ERROR_NONE;
-	account_stmt	hstmt = NULL;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				rc = 0;
-	account_s *account_head = NULL;
-
-	if (user_name == NULL) {
-		_ERR("USER NAME IS NULL");
-		*error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
-		goto CATCH;
-	}
-
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE user_name = ?", ACCOUNT_TABLE);
-
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
-		goto CATCH;
+	if (field_mask == 0 || (field_mask & ~_ACCOUNT_PATCH_ALL) != 0) {
+		ACCOUNT_ERROR("invalid field mask [%x]", field_mask);
+		return _ACCOUNT_ERROR_INVALID_PARAMETER;
 	}
 
-	int binding_count = 1;
-	_account_query_bind_text(hstmt, binding_count++, user_name);
-
-	rc = _account_query_step(hstmt);
+	for (i = 0; i < G_N_ELEMENTS(account_patch_fields); i++) {
+		const account_patch_field_s *field = &account_patch_fields[i];
+		account_changed_column_s *column = &columns[column_count];
+		gint32 value = 0;
 
-	if (rc != SQLITE_ROW) {
-		_ERR("The record isn't found");
-		*error_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-		goto CATCH;
-	}
+		if ((field_mask & field->field) == 0)
+			continue;
 
-	int tmp = 0;
+		column->name = field->name;
+		column->is_text = field->is_text;
 
-	account_head = (account_s*) malloc(sizeof(account_s));
-	if (account_head == NULL) {
-		ACCOUNT_FATAL("malloc Failed");
-		if (hstmt != NULL) {
-			rc = _account_query_finalize(hstmt);
-			if (rc != _ACCOUNT_ERROR_NONE) {
-				_ERR("finalize error");
-				*error_code = rc;
+		if (field->is_text) {
+			column->text = NULL;
+			if (!g_variant_lookup(values, field->name, "&s", &column->text)) {
+				ACCOUNT_ERROR("[%s] is missing or not a text", field->name);
+				error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
 				goto CATCH;
 			}
-			hstmt = NULL;
-		}
-		*error_code = _ACCOUNT_ERROR_OUT_OF_MEMORY;
-		goto CATCH;
-	}
-	ACCOUNT_MEMSET(account_head, 0x00, sizeof(account_s));
-
-	while (rc == SQLITE_ROW) {
-		account_s* account_record = NULL;
-
-		account_record = (account_s*) malloc(sizeof(account_s));
-
-		if (account_record == NULL) {
-			ACCOUNT_FATAL("malloc Failed");
-			break;
+			if (column->text[0] == '\0' && (field->field & (_ACCOUNT_PATCH_USER_NAME | _ACCOUNT_PATCH_EMAIL_ADDRESS | _ACCOUNT_PATCH_DISPLAY_NAME))) {
+				ACCOUNT_ERROR("[%s] can not be cleared", field->name);
+				error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+				goto CATCH;
+			}
+		} else {
+			/* int_custom0..4 take any value, as on the full update, only the enums are range checked */
+			if (!g_variant_lookup(values, field->name, "i", &value) || (field->max > 0 && (value < 0 || value >= field->max))) {
+				ACCOUNT_ERROR("[%s] is missing or out of range", field->name);
+				error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+				goto CATCH;
+			}
+			column->value = value;
 		}
-		ACCOUNT_MEMSET(account_record, 0x00, sizeof(account_s));
-
-		_account_convert_column_to_account(hstmt, account_record);
-
-		account_head->account_list = g_list_append(account_head->account_list, account_record);
-
-		rc = _account_query_step(hstmt);
-		tmp++;
-	}
-
-	rc = _account_query_finalize(hstmt);
-
-	if (rc != _ACCOUNT_ERROR_NONE) {
-		_ERR("finalize error");
-		*error_code = rc;
-		goto CATCH;
-	}
-
-	hstmt = NULL;
-
-	GList *iter;
 
-	tmp = g_list_length(account_head->account_list);
+		if (field->field == _ACCOUNT_PATCH_USER_NAME)
+			user_name = column->text;
 
-	for (iter = account_head->account_list; iter != NULL; iter = g_list_next(iter)) {
-		//account_h account;
-		//account = (account_h)iter->data;
+		/* the token is stored encrypted, same as on the full update */
+		if (field->field == _ACCOUNT_PATCH_ACCESS_TOKEN && column->text) {
+			token_account = (account_s *)calloc(1, sizeof(account_s));
+			ACCOUNT_CATCH_ERROR(token_account != NULL, {}, _ACCOUNT_ERROR_OUT_OF_MEMORY, ("Out of Memory"));
+			token_account->access_token = _account_dup_text(column->text);
 
-		account_s *testaccount = (account_s*)iter->data;
-
-		_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, testaccount->id, (void*)testaccount);
-		_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, testaccount->id, (void*)testaccount);
-	}
-
-	*error_code = _ACCOUNT_ERROR_NONE;
-
-CATCH:
-	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		if (rc != _ACCOUNT_ERROR_NONE) {
-			_ERR("finalize error");
-			*error_code = rc;
+			error_code = encrypt_access_token(token_account);
+			ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("_encrypt_access_token error"));
+			column->text = token_account->access_token;
 		}
-		hstmt = NULL;
-	}
-
-	pthread_mutex_unlock(&account_mutex);
-
-	if (account_head) {
-		_remove_sensitive_info_from_non_owning_account_list(account_head->account_list, pid, uid);
-		GList* result = account_head->account_list;
-		_ACCOUNT_FREE(account_head);
-		return result;
-	}
-
-	return NULL;
-}
-
-GList*
-_account_query_account_by_capability(int pid, uid_t uid, const char* capability_type, const int capability_value, int *error_code)
-{
-	*error_code = _ACCOUNT_ERROR_NONE;
-	account_stmt	hstmt = NULL;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	int				rc = 0;
 
-	ACCOUNT_RETURN_VAL((capability_type != NULL), { *error_code = _ACCOUNT_ERROR_INVALID_PARAMETER; }, NULL, ("capability_type IS NULL"));
-
-	if ((capability_value  < 0) || (capability_value >= _ACCOUNT_CAPABILITY_STATE_MAX)) {
-		ACCOUNT_SLOGE("(%s)-(%d) capability_value is not equal to 0 or 1.\n", __FUNCTION__, __LINE__);
-		*error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
-		return NULL;
-	}
-
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), { *error_code = _ACCOUNT_ERROR_DB_NOT_OPENED; }, NULL, ("The database isn't connected."));
-
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id IN (SELECT account_id from %s WHERE key=? AND value=?)", ACCOUNT_TABLE, CAPABILITY_TABLE);
-
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
-		return NULL;
+		column_count++;
 	}
 
-	int binding_count = 1;
-	_account_query_bind_text(hstmt, binding_count++, capability_type);
-	_account_query_bind_int(hstmt, binding_count++, capability_value);
-
-	rc = _account_query_step(hstmt);
-
-	account_s* account_head = NULL;
-
-	ACCOUNT_CATCH_ERROR_P(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
+	/* Check permission of requested appid */
+	current_appid = _account_get_client_appid(pid, uid);
+	error_code = _account_get_package_name_from_account_id(account_db_id, &package_name);
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE && package_name != NULL), {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("No package name with account_id\n"));
 
-	int tmp = 0;
+	error_code = _account_check_client_app_group(current_appid, package_name, uid);
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_PERMISSION_DENIED, ("No permission to update\n"));
 
-	account_head = (account_s*) malloc(sizeof(account_s));
-	if (account_head == NULL) {
-		ACCOUNT_FATAL("malloc Failed");
-		if (hstmt != NULL) {
-			rc = _account_query_finalize(hstmt);
-			ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), { *error_code = rc; }, NULL, ("finalize error"));
-			hstmt = NULL;
-		}
-		*error_code = _ACCOUNT_ERROR_OUT_OF_MEMORY;
-		return NULL;
+	/* a new user name goes to the capability rows as well */
+	if (user_name) {
+		error_code = _account_begin_transaction(g_hAccountDB);
+		ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("_account_begin_transaction fail(%d)", error_code));
+		in_transaction = true;
 	}
-	ACCOUNT_MEMSET(account_head, 0x00, sizeof(account_s));
-
-	while (rc == SQLITE_ROW) {
-		account_s* account_record = NULL;
-
-		account_record = (account_s*) malloc(sizeof(account_s));
-
-		if (account_record == NULL) {
-			ACCOUNT_FATAL("malloc Failed");
-			break;
-		}
-		ACCOUNT_MEMSET(account_record, 0x00, sizeof(account_s));
-
-		_account_convert_column_to_account(hstmt, account_record);
 
-		account_head->account_list = g_list_append(account_head->account_list, account_record);
+	error_code = _account_update_changed_columns(columns, column_count, account_db_id, &changes);
+	ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("account patch failed(%d)", error_code));
 
-		rc = _account_query_step(hstmt);
-		tmp++;
+	if (changes > 0 && user_name) {
+		error_code = _account_update_capability_column("user_name", user_name, account_db_id);
+		ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("update capability failed(%d)", error_code));
 	}
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_CATCH_ERROR_P((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
-
-	GList *iter;
-
-
-	tmp = g_list_length(account_head->account_list);
-
-	for (iter = account_head->account_list; iter != NULL; iter = g_list_next(iter)) {
-		//account_h account = NULL;
-		//account = (account_h)iter->data;
-		account_s* testaccount = (account_s*)iter->data;
-
-		_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, testaccount->id, (void*)testaccount);
-		_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, testaccount->id, (void*)testaccount);
-
+	if (in_transaction) {
+		in_transaction = false;
+		error_code = _account_end_transaction(g_hAccountDB, true);
+		ACCOUNT_CATCH_ERROR((error_code == _ACCOUNT_ERROR_NONE), {}, error_code, ("_account_end_transaction fail(%d)", error_code));
 	}
 
-	*error_code = _ACCOUNT_ERROR_NONE;
+	if (changes > 0)
+		_account_change_noti_queue(field_mask == _ACCOUNT_PATCH_SYNC_SUPPORT ? _ACCOUNT_NOTI_NAME_SYNC_UPDATE : _ACCOUNT_NOTI_NAME_UPDATE, account_db_id, NULL);
+	else
+		_INFO("account [%d] already holds the patched values, nothing written", account_db_id);
 
 CATCH:
-	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		if (rc != _ACCOUNT_ERROR_NONE) {
-			*error_code = rc;
-			_ERR("finalize error");
-		}
-		hstmt = NULL;
-	}
+	if (in_transaction)
+		_account_end_transaction(g_hAccountDB, false);
 
-	if (*error_code != _ACCOUNT_ERROR_NONE && account_head) {
-		_account_glist_account_free(account_head->account_list);
-		_ACCOUNT_FREE(account_head);
-		account_head = NULL;
-	}
-
-	pthread_mutex_unlock(&account_mutex);
+	if (token_account)
+		_account_free_account_with_items(token_account);
 
-	if (account_head) {
-		_remove_sensitive_info_from_non_owning_account_list(account_head->account_list, pid, uid);
-		GList* result = account_head->account_list;
-		_ACCOUNT_FREE(account_head);
-		return result;
-	}
+	_ACCOUNT_FREE(current_appid);
+	_ACCOUNT_FREE(package_name);
 
-	return NULL;
+	return error_code;
 }
 
-GList* _account_query_account_by_capability_type(int pid, uid_t uid, const char* capability_type, int *error_code)
+/* *account_record is carved from scope along with its capabilities and custom rows */
+int _account_query_account_by_account_id(request_scope_s *scope, int pid, uid_t uid, int account_db_id, account_s **account_record)
 {
-	*error_code = _ACCOUNT_ERROR_NONE;
+	_INFO("_account_query_account_by_account_id() start, account_db_id=[%d]", account_db_id);
+
+	int				error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt	hstmt = NULL;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	account_s		*account = NULL;
+	char			*client_appid = NULL;
 	int				rc = 0;
 
-	ACCOUNT_RETURN_VAL((capability_type != NULL), { *error_code = _ACCOUNT_ERROR_INVALID_PARAMETER; }, NULL, ("capability_type IS NULL"));
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), { *error_code = _ACCOUNT_ERROR_DB_NOT_OPENED; },
-					   NULL, ("The database isn't connected."));
-
-	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE _id IN (SELECT account_id from %s WHERE key=?)", ACCOUNT_TABLE, CAPABILITY_TABLE);
+	ACCOUNT_RETURN_VAL((account_db_id > 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT INDEX IS LESS THAN 0"));
+	ACCOUNT_RETURN_VAL(account_record != NULL, {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT IS NULL"));
+	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	*account_record = NULL;
 
+	hstmt = _account_prepare_cached_query(g_hAccountDB, "SELECT * FROM " ACCOUNT_TABLE " WHERE _id = ?");
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
-		return NULL;
+		error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		goto CATCH;
 	}
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
-	int binding_count = 1;
-	_account_query_bind_text(hstmt, binding_count++, capability_type);
-
+	_account_query_bind_int(hstmt, 1, account_db_id);
 	rc = _account_query_step(hstmt);
+	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
+
+	account = _account_scope_convert_column(scope, hstmt);
+	_account_query_release(hstmt);
 
-	account_s* account_head = NULL;
+	hstmt = _account_prepare_cached_query(g_hAccountDB, "SELECT account_id, key, value FROM " CAPABILITY_TABLE " WHERE account_id = ? ORDER BY _id");
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
-	ACCOUNT_CATCH_ERROR_P(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
+	_account_query_bind_int(hstmt, 1, account_db_id);
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW)
+		_account_scope_add_capability(scope, account, hstmt);
+	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_DB_FAILED, ("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB)));
+	account->capablity_list = g_slist_reverse(account->capablity_list);
+	_account_query_release(hstmt);
 
-	int tmp = 0;
+	hstmt = _account_prepare_cached_query(g_hAccountDB, "SELECT AccountId, Key, Value FROM " ACCOUNT_CUSTOM_TABLE " WHERE AccountId = ? ORDER BY rowid");
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
-	account_head = (account_s*) malloc(sizeof(account_s));
-	if (account_head == NULL) {
-		ACCOUNT_FATAL("malloc Failed");
-		if (hstmt != NULL) {
-			rc = _account_query_finalize(hstmt);
-			ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), { *error_code = rc; }, NULL, ("finalize error"));
-			hstmt = NULL;
-		}
-		*error_code = _ACCOUNT_ERROR_OUT_OF_MEMORY;
-		return NULL;
-	}
-	ACCOUNT_MEMSET(account_head, 0x00, sizeof(account_s));
+	_account_query_bind_int(hstmt, 1, account_db_id);
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW)
+		_account_scope_add_custom(scope, account, hstmt);
+	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_DB_FAILED, ("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB)));
+	account->custom_list = g_slist_reverse(account->custom_list);
 
-	while (rc == SQLITE_ROW) {
-		account_s* account_record = NULL;
+	client_appid = _account_get_client_appid(pid, uid);
+	_account_scope_remove_sensitive_info(account, client_appid);
+	_ACCOUNT_FREE(client_appid);
 
-		account_record = (account_s*) malloc(sizeof(account_s));
+	*account_record = account;
 
-		if (account_record == NULL) {
-			ACCOUNT_FATAL("malloc Failed");
-			break;
-		}
-		ACCOUNT_MEMSET(account_record, 0x00, sizeof(account_s));
+CATCH:
+	if (hstmt != NULL)
+		_account_query_release(hstmt);
 
-		_account_convert_column_to_account(hstmt, account_record);
+	ACCOUNT_DEBUG("_account_query_account_by_account_id end [%d]", error_code);
 
-		account_head->account_list = g_list_append(account_head->account_list, account_record);
+	return error_code;
+}
 
-		rc = _account_query_step(hstmt);
-		tmp++;
+static int _account_delete_by_package_name_from_db(const char *package_name)
+{
+	account_stmt	hstmt = NULL;
+	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	int				rc = 0;
+	int				ret_transaction = 0;
+	int				error_code = _ACCOUNT_ERROR_NONE;
+	GSList			*account_ids = NULL;
+	GSList			*iter = NULL;
+	const char		*delete_queries[] = {
+		"DELETE FROM %s WHERE account_id IN (SELECT _id FROM %s WHERE package_name = ?)",
+		"DELETE FROM %s WHERE AccountId IN (SELECT _id FROM %s WHERE package_name = ?)",
+		"DELETE FROM %s WHERE package_name = ?",
+	};
+	const char		*delete_tables[] = { CAPABILITY_TABLE, ACCOUNT_CUSTOM_TABLE, ACCOUNT_TABLE };
+	int				i = 0;
+
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT _id FROM %s WHERE package_name = ?", ACCOUNT_TABLE);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_CATCH_ERROR_P((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	_account_query_bind_text(hstmt, 1, package_name);
+	while (_account_query_step(hstmt) == SQLITE_ROW)
+		account_ids = g_slist_prepend(account_ids, GINT_TO_POINTER(sqlite3_column_int(hstmt, 0)));
+	_account_query_release(hstmt);
 	hstmt = NULL;
 
-	GList *iter;
+	if (account_ids == NULL) {
+		ACCOUNT_ERROR("no account of package [%s]", package_name);
+		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+	}
+	account_ids = g_slist_reverse(account_ids);
+
+	/* transaction control required*/
+	ret_transaction = _account_begin_transaction(g_hAccountDB);
+	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("account_delete_by_package_name:_account_begin_transaction fail %d\n", ret_transaction);
+		g_slist_free(account_ids);
+		return ret_transaction;
+	}
 
+	/* capability and custom rows go first, they are found through the account rows */
+	for (i = 0; i < G_N_ELEMENTS(delete_tables); i++) {
+		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+		ACCOUNT_SNPRINTF(query, sizeof(query), delete_queries[i], delete_tables[i], ACCOUNT_TABLE);
 
-	tmp = g_list_length(account_head->account_list);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+		ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
+				("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
 
-	for (iter = account_head->account_list; iter != NULL; iter = g_list_next(iter)) {
-		account_s* testaccount = (account_s*)iter->data;
+		_account_query_bind_text(hstmt, 1, package_name);
 
-		_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, testaccount->id, (void*)testaccount);
-		_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, testaccount->id, (void*)testaccount);
+		rc = _account_query_step(hstmt);
+		ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_DB_FAILED,
+				("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB)));
 
+		_account_query_release(hstmt);
+		hstmt = NULL;
 	}
 
-	*error_code = _ACCOUNT_ERROR_NONE;
-
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		if (rc != _ACCOUNT_ERROR_NONE) {
-			*error_code = rc;
-			_ERR("finalize error");
-		}
+		_account_query_release(hstmt);
 		hstmt = NULL;
 	}
 
-	if ((*error_code != _ACCOUNT_ERROR_NONE) && account_head) {
-		_account_glist_account_free(account_head->account_list);
-		_ACCOUNT_FREE(account_head);
-		account_head = NULL;
+	ret_transaction = _account_end_transaction(g_hAccountDB, error_code == _ACCOUNT_ERROR_NONE);
+	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("account_delete_by_package_name:_account_end_transaction fail %d\n", ret_transaction);
+		if (error_code == _ACCOUNT_ERROR_NONE)
+			error_code = ret_transaction;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
-
-	if (account_head) {
-		_remove_sensitive_info_from_non_owning_account_list(account_head->account_list, pid, uid);
-		GList* result = account_head->account_list;
-		_ACCOUNT_FREE(account_head);
-		return result;
+	if (error_code == _ACCOUNT_ERROR_NONE) {
+		for (iter = account_ids; iter != NULL; iter = g_slist_next(iter))
+			change_noti_queue(_ACCOUNT_NOTI_NAME_DELETE, GPOINTER_TO_INT(iter->data), package_name);
 	}
+	g_slist_free(account_ids);
 
-	return NULL;
-}
-
-GList* account_server_query_account_by_package_name(const char* package_name, int *error_code, int pid, uid_t uid)
-{
-	_INFO("account_server_query_account_by_package_name start");
-
-	GList * account_list = NULL;
-	*error_code = _ACCOUNT_ERROR_NONE;
-
-	ACCOUNT_RETURN_VAL((package_name != NULL), { *error_code = _ACCOUNT_ERROR_INVALID_PARAMETER; }, NULL, ("PACKAGE NAME IS NULL"));
-	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), { *error_code = _ACCOUNT_ERROR_DB_NOT_OPENED; }, NULL, ("The database isn't connected."));
-
-	account_list = _account_query_account_by_package_name(g_hAccountDB, package_name, error_code, pid, uid);
-
-	_INFO("account_server_query_account_by_package_name end");
-
-	return account_list;
+	return error_code;
 }
 
 int account_server_delete_account_by_package_name(const char* package_name, bool permission, int pid, uid_t uid)
@@ -2316,7 +3386,19 @@ int account_server_delete_account_by_package_name(const char* package_name, bool
 	ACCOUNT_RETURN_VAL((package_name != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("PACKAGE NAME IS NULL"));
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
-	error_code = _account_delete_account_by_package_name(g_hAccountDB, package_name, permission, pid, uid);
+	if (permission) {
+		char *current_appid = _account_get_client_appid(pid, uid);
+
+		error_code = _account_check_client_app_group(current_appid, package_name, uid);
+		_ACCOUNT_FREE(current_appid);
+		if (error_code != _ACCOUNT_ERROR_NONE) {
+			ACCOUNT_ERROR("No permission to delete\n");
+			return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		}
+	}
+
+	/* done here instead of account-common, so the removed ids can go out in one change signal */
+	error_code = _account_delete_by_package_name_from_db(package_name);
 
 	_INFO("account_server_delete_account_by_package_name end");
 
@@ -2336,12 +3418,11 @@ int _account_delete(int pid, uid_t uid, int account_id)
 
 	int count = -1;
 	/* Check requested ID to delete */
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id=%d", ACCOUNT_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE _id=?", ACCOUNT_TABLE);
 
-	count = _account_get_record_count(g_hAccountDB, query);
+	count = _account_get_record_count_by_int(g_hAccountDB, query, account_id);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
@@ -2355,7 +3436,7 @@ int _account_delete(int pid, uid_t uid, int account_id)
 	char* current_appid = NULL;
 	char *package_name = NULL;
 
-	current_appid = _account_get_current_appid(pid, uid);
+	current_appid = _account_get_client_appid(pid, uid);
 
 	error_code = _account_get_package_name_from_account_id(account_id, &package_name);
 
@@ -2367,13 +3448,13 @@ int _account_delete(int pid, uid_t uid, int account_id)
 	}
 	ACCOUNT_DEBUG("DELETE:account_id[%d],current_appid[%s]package_name[%s]", account_id, current_appid, package_name);
 
-	error_code = _account_check_appid_group_with_package_name(current_appid, package_name, uid);
+	error_code = _account_check_client_app_group(current_appid, package_name, uid);
 
 	_ACCOUNT_FREE(current_appid);
-	_ACCOUNT_FREE(package_name);
 
 	if (error_code != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("No permission to delete\n");
+		_ACCOUNT_FREE(package_name);
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
@@ -2381,74 +3462,80 @@ int _account_delete(int pid, uid_t uid, int account_id)
 	ret_transaction = _account_begin_transaction(g_hAccountDB);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		_ACCOUNT_FREE(package_name);
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	if (ret_transaction == _ACCOUNT_ERROR_DATABASE_BUSY) {
 		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
+		_ACCOUNT_FREE(package_name);
 		return _ACCOUNT_ERROR_DATABASE_BUSY;
 	}
 
 	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("account_delete:_account_begin_transaction fail %d\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
+		_ACCOUNT_FREE(package_name);
 		return ret_transaction;
 	}
 
 	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE account_id = %d", CAPABILITY_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE account_id = ?", CAPABILITY_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		_ACCOUNT_FREE(package_name);
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
 			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
 
+	_account_query_bind_int(hstmt, 1, account_id);
+
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), { _ACCOUNT_FREE(package_name); }, rc, ("finalize error"));
 	hstmt = NULL;
 
 	ACCOUNT_MEMSET(query, 0, sizeof(query));
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE _id = %d", ACCOUNT_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE _id = ?", ACCOUNT_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
 			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
 
+	_account_query_bind_int(hstmt, 1, account_id);
+
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found. id=%d, rc=%d\n", account_id, rc));
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	rc = _account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), { _ACCOUNT_FREE(package_name); }, rc, ("finalize error"));
 	hstmt = NULL;
 
 	/* delete custom data */
 	ACCOUNT_MEMSET(query, 0, sizeof(query));
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AccountId = %d", ACCOUNT_CUSTOM_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AccountId = ?", ACCOUNT_CUSTOM_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
 			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
 
+	_account_query_bind_int(hstmt, 1, account_id);
+
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found. id=%d, rc=%d\n", account_id, rc));
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == _ACCOUNT_ERROR_NONE, {}, rc, ("finalize error", account_id, rc));
 	hstmt = NULL;
 
@@ -2456,7 +3543,7 @@ int _account_delete(int pid, uid_t uid, int account_id)
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			ACCOUNT_ERROR("rc (%d)", rc);
 			is_success = FALSE;
@@ -2470,14 +3557,12 @@ CATCH:
 	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("account_delete:_account_end_transaction fail %d, is_success=%d\n", ret_transaction, is_success);
 	} else {
-		if (is_success == true) {
-			char buf[64] = {0,};
-			ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_DELETE, account_id);
-			_account_insert_delete_update_notification_send(buf);
-		}
+		if (is_success == true)
+			change_noti_queue(_ACCOUNT_NOTI_NAME_DELETE, account_id, package_name);
 	}
 
-	pthread_mutex_unlock(&account_mutex);
+	_ACCOUNT_FREE(package_name);
+
 
 	return error_code;
 }
@@ -2500,7 +3585,7 @@ static int _account_query_account_by_username_and_package(const char* username,
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE user_name = ? and package_name = ?", ACCOUNT_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -2520,7 +3605,7 @@ static int _account_query_account_by_username_and_package(const char* username,
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	_account_query_capability_by_account_id(g_hAccountDB, _account_add_capability_to_account_cb, account_record->id, (void*)account_record);
 	_account_query_custom_by_account_id(g_hAccountDB, _account_add_custom_to_account_cb, account_record->id, (void*)account_record);
@@ -2530,12 +3615,11 @@ static int _account_query_account_by_username_and_package(const char* username,
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
 
-	pthread_mutex_unlock(&account_mutex);
 
 	return error_code;
 }
@@ -2612,13 +3696,13 @@ int _account_delete_from_db_by_user_name(int pid, uid_t uid, const char *user_na
 	char* current_appid = NULL;
 	char* package_name_temp = NULL;
 
-	current_appid = _account_get_current_appid(pid, uid);
+	current_appid = _account_get_client_appid(pid, uid);
 
 	package_name_temp = _account_dup_text(package_name);
 
 	ACCOUNT_DEBUG("DELETE:user_name[%s],current_appid[%s], package_name[%s]", user_name, current_appid, package_name_temp);
 
-	error_code = _account_check_appid_group_with_package_name(current_appid, package_name_temp, uid);
+	error_code = _account_check_client_app_group(current_appid, package_name_temp, uid);
 
 	_ACCOUNT_FREE(current_appid);
 	_ACCOUNT_FREE(package_name_temp);
@@ -2651,18 +3735,15 @@ int _account_delete_from_db_by_user_name(int pid, uid_t uid, const char *user_na
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	_INFO("");
 	if (ret_transaction == _ACCOUNT_ERROR_DATABASE_BUSY) {
 		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
 		return _ACCOUNT_ERROR_DATABASE_BUSY;
 	} else if (ret_transaction != _ACCOUNT_ERROR_NONE) {
 		ACCOUNT_ERROR("account_delete:_account_begin_transaction fail %d\n", ret_transaction);
-		pthread_mutex_unlock(&account_mutex);
 		return ret_transaction;
 	}
 
@@ -2670,11 +3751,10 @@ int _account_delete_from_db_by_user_name(int pid, uid_t uid, const char *user_na
 	ACCOUNT_MEMSET(query, 0, sizeof(query));
 	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AccountId = ?", ACCOUNT_CUSTOM_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		_account_end_transaction(g_hAccountDB, FALSE);
-		pthread_mutex_unlock(&account_mutex);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
@@ -2687,148 +3767,425 @@ int _account_delete_from_db_by_user_name(int pid, uid_t uid, const char *user_na
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	hstmt = NULL;
+
+	/* delete capability */
+	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE user_name = ? and package_name = ?", CAPABILITY_TABLE);
+
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
+			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
+
+	binding_count = 1;
+	_account_query_bind_text(hstmt, binding_count++, user_name);
+	_account_query_bind_text(hstmt, binding_count++, package_name);
+
+	rc = _account_query_step(hstmt);
+	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
+
+	rc = _account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	hstmt = NULL;
+
+	ACCOUNT_MEMSET(query, 0, sizeof(query));
+
+	_INFO("");
+	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE user_name = ? and package_name = ?", ACCOUNT_TABLE);
+
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
+	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
+			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
+
+	_INFO("");
+	binding_count = 1;
+	_account_query_bind_text(hstmt, binding_count++, user_name);
+	_account_query_bind_text(hstmt, binding_count++, package_name);
+
+	rc = _account_query_step(hstmt);
+	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found. user_name=%s, package_name=%s, rc=%d\n", user_name, package_name, rc));
+
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+	is_success = TRUE;
+
 	hstmt = NULL;
 
-	/* delete capability */
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE user_name = ? and package_name = ?", CAPABILITY_TABLE);
+CATCH:
+	if (hstmt != NULL) {
+		rc = _account_query_release(hstmt);
+		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
+		hstmt = NULL;
+	}
+
+	ret_transaction = _account_end_transaction(g_hAccountDB, is_success);
+
+	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_ERROR("account_svc_delete:_account_svc_end_transaction fail %d, is_success=%d\n", ret_transaction, is_success);
+	} else {
+		if (is_success == true)
+			change_noti_queue(_ACCOUNT_NOTI_NAME_DELETE, account_id, package_name);
+	}
+
+
+	return error_code;
+}
+
+
+int _account_get_total_count_from_db(gboolean include_hidden, int *count)
+{
+	if (!count) {
+		ACCOUNT_SLOGE("(%s)-(%d) count is NULL.\n", __FUNCTION__, __LINE__);
+		return _ACCOUNT_ERROR_INVALID_PARAMETER;
+	}
+
+	if (!g_hAccountDB) {
+		ACCOUNT_ERROR("DB is not opened\n");
+		return _ACCOUNT_ERROR_DB_NOT_OPENED;
+	}
+
+	/* kept up to date by the account_count triggers, a single row instead of a table scan */
+	account_stmt hstmt = _account_prepare_cached_query(g_hAccountDB, _account_db_has_count_table()
+			? "SELECT total, visible FROM " ACCOUNT_COUNT_TABLE " WHERE package_name = ''"
+			: "SELECT COUNT(*), IFNULL(SUM(secret IS 2), 0) FROM " ACCOUNT_TABLE);
+	int rc = -1;
+
+	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	}
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_cached_query() failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
+
+	rc = _account_query_step(hstmt);
+	if (rc == SQLITE_ROW) {
+		*count = sqlite3_column_int(hstmt, include_hidden ? 0 : 1);
+	} else if (rc == SQLITE_DONE) {
+		*count = 0;
+	} else {
+		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
+		_account_query_release(hstmt);
+		return _ACCOUNT_ERROR_DB_FAILED;
+	}
+
+	_account_query_release(hstmt);
+
+	if (*count < 0) {
+		ACCOUNT_ERROR("[ERROR] Number of account : %d, End", *count);
+		return _ACCOUNT_ERROR_DB_FAILED;
+	}
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+
+int account_server_query_app_id_exist(const char* app_id)
+{
+	_INFO("account_server_query_app_id_exist start app_id=[%s]", app_id);
+	int ret = _ACCOUNT_ERROR_NONE;
+
+	ret = _account_type_query_app_id_exist_from_all_db(g_hAccountDB, g_hAccountGlobalDB, app_id);
+
+	_INFO("account_server_query_app_id_exist end error_code=[%d]", ret);
+
+	return ret;
+}
+
+static account_stmt _account_type_catalog_prepare(sqlite3 *account_db_handle, const char *table, int *error_code)
+{
+	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
+	account_stmt hstmt = NULL;
+
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s", table);
+	hstmt = _account_prepare_cached_query(account_db_handle, query);
+
+	if (_account_db_err_code(account_db_handle) == SQLITE_PERM) {
+		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(account_db_handle));
+		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+	} else if (hstmt == NULL) {
+		*error_code = _ACCOUNT_ERROR_DB_FAILED;
+	} else {
+		*error_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	return hstmt;
+}
+
+/* one pass over each type table, instead of a label and a provider feature query per type */
+static int _account_type_catalog_load(type_cache_catalog_s *catalog, void *user_data)
+{
+	sqlite3 *account_db_handle = (sqlite3 *)user_data;
+	account_stmt hstmt = NULL;
+	int error_code = _ACCOUNT_ERROR_NONE;
+	int rc = 0;
+
+	hstmt = _account_type_catalog_prepare(account_db_handle, ACCOUNT_TYPE_TABLE, &error_code);
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, error_code, ("account type query failed"));
+
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW) {
+		account_type_s *account_type_record = create_empty_account_type_instance();
+		if (account_type_record == NULL) {
+			ACCOUNT_FATAL("malloc Failed");
+			_account_query_release(hstmt);
+			return _ACCOUNT_ERROR_OUT_OF_MEMORY;
+		}
+		_account_type_convert_column_to_account_type(hstmt, account_type_record);
+		type_cache_catalog_add_account_type(catalog, account_type_record);
+	}
+	_account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == SQLITE_DONE), {}, _ACCOUNT_ERROR_DB_FAILED, ("account type step failed(%d)", rc));
+
+	hstmt = _account_type_catalog_prepare(account_db_handle, LABEL_TABLE, &error_code);
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, error_code, ("label query failed"));
+
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW) {
+		label_s label_record;
+		ACCOUNT_MEMSET(&label_record, 0x00, sizeof(label_s));
+		_account_type_convert_column_to_label(hstmt, &label_record);
+		type_cache_catalog_add_label(catalog, label_record.app_id, label_record.label, label_record.locale);
+		_ACCOUNT_FREE(label_record.app_id);
+		_ACCOUNT_FREE(label_record.label);
+		_ACCOUNT_FREE(label_record.locale);
+	}
+	_account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == SQLITE_DONE), {}, _ACCOUNT_ERROR_DB_FAILED, ("label step failed(%d)", rc));
+
+	hstmt = _account_type_catalog_prepare(account_db_handle, PROVIDER_FEATURE_TABLE, &error_code);
+	ACCOUNT_RETURN_VAL((hstmt != NULL), {}, error_code, ("provider feature query failed"));
+
+	while ((rc = _account_query_step(hstmt)) == SQLITE_ROW) {
+		provider_feature_s feature_record;
+		ACCOUNT_MEMSET(&feature_record, 0x00, sizeof(provider_feature_s));
+		_account_type_convert_column_to_provider_feature(hstmt, &feature_record);
+		type_cache_catalog_add_provider_feature(catalog, feature_record.app_id, feature_record.key);
+		_ACCOUNT_FREE(feature_record.app_id);
+		_ACCOUNT_FREE(feature_record.key);
+	}
+	_account_query_release(hstmt);
+	ACCOUNT_RETURN_VAL((rc == SQLITE_DONE), {}, _ACCOUNT_ERROR_DB_FAILED, ("provider feature step failed(%d)", rc));
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/* NULL when the catalog can't be loaded, callers then query the db as before */
+static type_cache_catalog_s *_account_type_catalog_get(void)
+{
+	char account_db_path[256] = {0, };
+
+	if (g_hAccountDB == NULL || account_db_conn == NULL)
+		return NULL;
+
+	ACCOUNT_GET_USER_DB_PATH(account_db_path, sizeof(account_db_path), account_db_conn->uid);
+
+	return type_cache_get_user_catalog(account_db_conn->uid, account_db_path, _account_type_catalog_load, g_hAccountDB);
+}
+
+static type_cache_catalog_s *_account_type_catalog_get_from_global_db(void)
+{
+	char account_db_path[256] = {0, };
+
+	if (g_hAccountGlobalDB == NULL)
+		return NULL;
+
+	ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
+
+	return type_cache_get_global_catalog(account_db_path, _account_type_catalog_load, g_hAccountGlobalDB);
+}
+
+/*
+ * Both in the directory packaging/account-manager.spec creates for the daemon, the files
+ * are replaced by a rename and the daemon may not create files next to the db itself.
+ */
+static void _account_type_catalog_file_path(char *path, size_t size, const char *suffix)
+{
+	char account_db_path[256] = {0, };
+
+	ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
+	ACCOUNT_SNPRINTF(path, size, "%s.%s/%s", account_db_path, ACCOUNT_TYPE_CATALOG_DIR_SUFFIX, suffix);
+}
+
+/* the install time index first, it wins over the snapshot for the global db */
+void _account_type_catalog_snapshot_load(void)
+{
+	char file_path[256] = {0, };
+
+	_account_type_catalog_file_path(file_path, sizeof(file_path), ACCOUNT_TYPE_CATALOG_INDEX_SUFFIX);
+	type_cache_index_load(file_path);
+
+	_account_type_catalog_file_path(file_path, sizeof(file_path), ACCOUNT_TYPE_CATALOG_SNAPSHOT_SUFFIX);
+	type_cache_snapshot_load(file_path);
+}
+
+/* after _account_db_pool_destroy(), a db still open would change its files once closed */
+void _account_type_catalog_snapshot_save(void)
+{
+	char file_path[256] = {0, };
+
+	_account_type_catalog_file_path(file_path, sizeof(file_path), ACCOUNT_TYPE_CATALOG_SNAPSHOT_SUFFIX);
+	type_cache_snapshot_save(file_path);
+}
+
+/* run by the installer for the first start, later the daemon rewrites the index when it finds it stale */
+int _account_type_catalog_index_build(void)
+{
+	char account_db_path[256] = {0, };
+	char index_path[256] = {0, };
+	int ret = _ACCOUNT_ERROR_NONE;
+
+	ret = _account_global_db_open();
+	ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, ret, ("global db open failed"));
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
+	_account_type_catalog_file_path(index_path, sizeof(index_path), ACCOUNT_TYPE_CATALOG_INDEX_SUFFIX);
 
-	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
-			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
+	if (!type_cache_index_build(index_path, account_db_path, _account_type_catalog_load, g_hAccountGlobalDB))
+		ret = _ACCOUNT_ERROR_DB_FAILED;
 
-	binding_count = 1;
-	_account_query_bind_text(hstmt, binding_count++, user_name);
-	_account_query_bind_text(hstmt, binding_count++, package_name);
+	_account_global_db_close();
+	_account_db_pool_destroy();
 
-	rc = _account_query_step(hstmt);
-	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
+	return ret;
+}
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
+/* packaging/account-manager.spec runs this as root, the daemon itself only ever reads the global db */
+int _account_global_db_migrate(void)
+{
+	char account_db_path[256] = {0, };
+	sqlite3 *handle = NULL;
+	int ret = _ACCOUNT_ERROR_NONE;
 
-	ACCOUNT_MEMSET(query, 0, sizeof(query));
+	ACCOUNT_GET_GLOBAL_DB_PATH(account_db_path, sizeof(account_db_path));
 
-	_INFO("");
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE user_name = ? and package_name = ?", ACCOUNT_TABLE);
+	ret = _account_db_conn_open(account_db_path, &handle, 0);
+	ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, ret, ("global db open failed"));
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	ACCOUNT_CATCH_ERROR(hstmt != NULL, {}, _ACCOUNT_ERROR_DB_FAILED,
-			("_account_svc_query_prepare(%s) failed(%s).\n", query, _account_db_err_msg(g_hAccountDB)));
+	/*
+	 * Not WAL: its -shm file would have to be writable by every read only client, and sqlite
+	 * deletes it with the -wal file when the last connection closes. A WAL db is converted back.
+	 */
+	if (sqlite3_exec(handle, "PRAGMA journal_mode = PERSIST", NULL, NULL, NULL) != SQLITE_OK)
+		_ERR("global db journal_mode failed (%s)", _account_db_err_msg(handle));
 
-	_INFO("");
-	binding_count = 1;
-	_account_query_bind_text(hstmt, binding_count++, user_name);
-	_account_query_bind_text(hstmt, binding_count++, package_name);
+	ret = _account_db_create_tables(handle);
+	if (ret == _ACCOUNT_ERROR_NONE)
+		ret = _account_db_migrate(handle);
+	if (ret == _ACCOUNT_ERROR_NONE)
+		_INFO("global db at schema version [%d]", _account_db_get_user_version(handle));
 
-	rc = _account_query_step(hstmt);
-	ACCOUNT_CATCH_ERROR(rc == SQLITE_DONE, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found. user_name=%s, package_name=%s, rc=%d\n", user_name, package_name, rc));
+	_account_db_handle_close(handle);
 
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	is_success = TRUE;
+	return ret;
+}
 
-	hstmt = NULL;
+/* leaves an idle global db connection and its account types behind for the first request */
+void _account_db_pool_prewarm(void)
+{
+	type_cache_catalog_s *catalog = NULL;
 
-CATCH:
-	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-		hstmt = NULL;
-	}
+	if (_account_global_db_open() != _ACCOUNT_ERROR_NONE)
+		return;
 
-	ret_transaction = _account_end_transaction(g_hAccountDB, is_success);
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog)
+		type_cache_catalog_unref(catalog);
 
-	if (ret_transaction != _ACCOUNT_ERROR_NONE) {
-		ACCOUNT_ERROR("account_svc_delete:_account_svc_end_transaction fail %d, is_success=%d\n", ret_transaction, is_success);
-	} else {
-		if (is_success == true) {
-			char buf[64] = {0,};
-			ACCOUNT_SNPRINTF(buf, sizeof(buf), "%s:%d", _ACCOUNT_NOTI_NAME_DELETE, account_id);
-			_account_insert_delete_update_notification_send(buf);
-		}
-	}
+	_account_global_db_close();
+}
 
-	pthread_mutex_unlock(&account_mutex);
+/* called after every account type write to the user db, even a failed one may have changed rows */
+static void _account_type_catalog_invalidate(void)
+{
+	if (account_db_conn == NULL)
+		return;
 
-	return error_code;
+	type_cache_invalidate_user(account_db_conn->uid);
+	app_group_cache_invalidate_represented();
 }
 
+/* the catalog stays referenced until the scope is freed, its records are handed out as they are */
+static void _account_type_catalog_hold(request_scope_s *scope, type_cache_catalog_s *catalog)
+{
+	request_scope_add_cleanup(scope, (GDestroyNotify)type_cache_catalog_unref, catalog);
+}
 
-int _account_get_total_count_from_db(gboolean include_hidden, int *count)
+/* appends the catalog records themselves */
+static GSList *_account_type_catalog_borrow_list(GSList *account_type_list, GSList *catalog_list)
 {
-	if (!count) {
-		ACCOUNT_SLOGE("(%s)-(%d) count is NULL.\n", __FUNCTION__, __LINE__);
-		return _ACCOUNT_ERROR_INVALID_PARAMETER;
-	}
+	GSList *borrow_list = NULL;
+	GSList *iter = NULL;
 
-	if (!g_hAccountDB) {
-		ACCOUNT_ERROR("DB is not opened\n");
-		return _ACCOUNT_ERROR_DB_NOT_OPENED;
-	}
+	for (iter = catalog_list; iter != NULL; iter = g_slist_next(iter))
+		borrow_list = g_slist_prepend(borrow_list, iter->data);
 
-	char query[1024] = {0, };
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
+	return g_slist_concat(account_type_list, g_slist_reverse(borrow_list));
+}
 
-	if (include_hidden)
-		ACCOUNT_SNPRINTF(query, sizeof(query), "select count(*) from %s", ACCOUNT_TABLE);
-	else
-		ACCOUNT_SNPRINTF(query, sizeof(query), "select count(*) from %s where secret = %d", ACCOUNT_TABLE, _ACCOUNT_SECRECY_VISIBLE);
+static void _account_type_record_destroy(gpointer data)
+{
+	_account_type_free_account_type_with_items((account_type_s *)data);
+}
 
-	*count = _account_get_record_count(g_hAccountDB, query);
+/* appends records read from the db without the catalog, the scope frees them like the borrowed ones */
+static GSList *_account_type_list_to_scope(request_scope_s *scope, GSList *account_type_list, GSList *record_list)
+{
+	GSList *iter = NULL;
 
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		pthread_mutex_unlock(&account_mutex);
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	}
+	for (iter = record_list; iter != NULL; iter = g_slist_next(iter))
+		request_scope_add_cleanup(scope, _account_type_record_destroy, iter->data);
 
-	int rc = -1;
-	int ncount = 0;
-	account_stmt pStmt = NULL;
+	return g_slist_concat(account_type_list, record_list);
+}
 
-	rc = sqlite3_prepare_v2(g_hAccountDB, query, strlen(query), &pStmt, NULL);
-	if (SQLITE_OK != rc) {
-		ACCOUNT_SLOGE("sqlite3_prepare_v2() failed(%d, %s).", rc, _account_db_err_msg(g_hAccountDB));
-		sqlite3_finalize(pStmt);
-		return _ACCOUNT_ERROR_DB_FAILED;
-	}
+static int _account_type_catalog_query_by_app_id(type_cache_catalog_s *catalog, const char *app_id, account_type_s **account_type_record)
+{
+	const account_type_s *account_type = type_cache_lookup_app_id(catalog, app_id);
 
-	rc = sqlite3_step(pStmt);
-	if (SQLITE_ROW != rc) {
-		ACCOUNT_ERROR("[ERROR] sqlite3_step() failed\n");
-		sqlite3_finalize(pStmt);
+	if (account_type == NULL)
 		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-	}
 
-	ncount = sqlite3_column_int(pStmt, 0);
+	/* read only, the marshalling does not write to it */
+	*account_type_record = (account_type_s *)account_type;
 
-	*count = ncount;
+	return _ACCOUNT_ERROR_NONE;
+}
 
-	sqlite3_finalize(pStmt);
+static int _account_type_catalog_query_label(type_cache_catalog_s *catalog, const char *app_id, const char *locale, char **label)
+{
+	const char *label_text = type_cache_lookup_label(catalog, app_id, locale);
 
-	if (ncount < 0) {
-		ACCOUNT_ERROR("[ERROR] Number of account : %d, End", ncount);
-		return _ACCOUNT_ERROR_DB_FAILED;
-	}
+	if (label_text == NULL)
+		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+
+	_ACCOUNT_FREE(*label);
+	*label = _account_dup_text(label_text);
 
 	return _ACCOUNT_ERROR_NONE;
 }
 
+static int _account_type_catalog_query_by_provider_feature(request_scope_s *scope, type_cache_catalog_s *catalog, const char *key,
+		GSList **account_type_list)
+{
+	GSList *catalog_list = type_cache_lookup_provider_feature(catalog, key);
 
-int account_server_query_app_id_exist(const char* app_id)
+	if (catalog_list == NULL)
+		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
+
+	*account_type_list = _account_type_catalog_borrow_list(*account_type_list, catalog_list);
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+static int _account_type_catalog_query_all(request_scope_s *scope, type_cache_catalog_s *catalog, GSList **account_type_list)
 {
-	_INFO("account_server_query_app_id_exist start app_id=[%s]", app_id);
-	int ret = _ACCOUNT_ERROR_NONE;
+	GSList *catalog_list = type_cache_get_all(catalog);
 
-	ret = _account_type_query_app_id_exist_from_all_db(g_hAccountDB, g_hAccountGlobalDB, app_id);
+	if (catalog_list == NULL)
+		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 
-	_INFO("account_server_query_app_id_exist end error_code=[%d]", ret);
+	*account_type_list = _account_type_catalog_borrow_list(*account_type_list, catalog_list);
 
-	return ret;
+	return _ACCOUNT_ERROR_NONE;
 }
 
 int account_server_insert_account_type_to_user_db(account_type_s *account_type, int *account_type_id, uid_t uid)
@@ -2847,6 +4204,7 @@ int account_server_insert_account_type_to_user_db(account_type_s *account_type,
 	}
 
 	ret = _account_type_insert_to_db(g_hAccountDB, account_type, account_type_id);
+	_account_type_catalog_invalidate();
 	_INFO("account_server_insert_account_type_to_user_db end error_code=[%d]", ret);
 
 	return ret;
@@ -2860,6 +4218,7 @@ int account_server_delete_account_type_by_app_id_from_user_db(const char * app_i
 	int ret = _ACCOUNT_ERROR_NONE;
 
 	ret = _account_type_delete_by_app_id(g_hAccountDB, app_id);
+	_account_type_catalog_invalidate();
 	_INFO("account_server_delete_account_type_by_app_id_from_user_db end error_code=[%d]", ret);
 
 	return ret;
@@ -2882,7 +4241,7 @@ GSList* _account_type_query_provider_feature_by_app_id_from_global_db(const char
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE app_id = ?", PROVIDER_FEATURE_TABLE);
 	_INFO("account query=[%s]", query);
 
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -2899,6 +4258,8 @@ GSList* _account_type_query_provider_feature_by_app_id_from_global_db(const char
 
 	provider_feature_s* feature_record = NULL;
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 
 		feature_record = (provider_feature_s*) malloc(sizeof(provider_feature_s));
@@ -2913,16 +4274,17 @@ GSList* _account_type_query_provider_feature_by_app_id_from_global_db(const char
 		_account_type_convert_column_to_provider_feature(hstmt, feature_record);
 
 		_INFO("Adding account feature_list");
-		feature_list = g_slist_append(feature_list, feature_record);
+		g_ptr_array_add(result_set, feature_record);
 
 		rc = _account_query_step(hstmt);
 	}
+	feature_list = _account_result_to_slist(feature_list, result_set);
 
 	*error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			*error_code = rc;
 			_ERR("global db fianlize error");
@@ -2954,7 +4316,7 @@ GSList* _account_type_query_provider_feature_by_app_id(const char* app_id, int *
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE app_id = ?", PROVIDER_FEATURE_TABLE);
 	_INFO("account query=[%s]", query);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -2972,6 +4334,8 @@ GSList* _account_type_query_provider_feature_by_app_id(const char* app_id, int *
 
 	provider_feature_s* feature_record = NULL;
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 
 		feature_record = (provider_feature_s*) malloc(sizeof(provider_feature_s));
@@ -2986,20 +4350,21 @@ GSList* _account_type_query_provider_feature_by_app_id(const char* app_id, int *
 		_account_type_convert_column_to_provider_feature(hstmt, feature_record);
 
 		_INFO("Adding account feature_list");
-		feature_list = g_slist_append(feature_list, feature_record);
+		g_ptr_array_add(result_set, feature_record);
 
 		rc = _account_query_step(hstmt);
 	}
+	feature_list = _account_result_to_slist(feature_list, result_set);
 
 	*error_code = _ACCOUNT_ERROR_NONE;
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR_P((rc == _ACCOUNT_ERROR_NONE), { *error_code = rc; }, rc, ("account finalize error"));
 	hstmt = NULL;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			*error_code = rc;
 			_ERR("account fianlize error");
@@ -3036,7 +4401,7 @@ int _account_type_query_provider_feature_cb_by_app_id_from_global_db(account_typ
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE app_id = ?", PROVIDER_FEATURE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
@@ -3076,7 +4441,7 @@ int _account_type_query_provider_feature_cb_by_app_id_from_global_db(account_typ
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			error_code = rc;
 			_ERR("global db finalize error[%d]", rc);
@@ -3104,7 +4469,7 @@ int _account_type_query_provider_feature_cb_by_app_id(account_type_provider_feat
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE app_id = ?", PROVIDER_FEATURE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -3140,7 +4505,7 @@ int _account_type_query_provider_feature_cb_by_app_id(account_type_provider_feat
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -3148,7 +4513,7 @@ int _account_type_query_provider_feature_cb_by_app_id(account_type_provider_feat
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -3186,19 +4551,26 @@ bool _account_type_query_supported_feature_from_global_db(const char* app_id, co
 
 	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int record_count = 0;
+	type_cache_catalog_s *catalog = NULL;
 
 	if (app_id == NULL || capability == NULL) {
 		*error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
 		return false;
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s where app_id='%s' and key='%s'", PROVIDER_FEATURE_TABLE, app_id, capability);
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog != NULL) {
+		record_count = type_cache_has_provider_feature(catalog, app_id, capability) ? 1 : 0;
+		type_cache_catalog_unref(catalog);
+	} else {
+		ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s where app_id=? and key=?", PROVIDER_FEATURE_TABLE);
 
-	record_count = _account_get_record_count(g_hAccountGlobalDB, query);
+		record_count = _account_get_record_count_by_text(g_hAccountGlobalDB, query, app_id, capability);
 
-	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
-		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
+			ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
+			*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+		}
 	}
 
 	if (record_count <= 0) {
@@ -3219,20 +4591,27 @@ bool _account_type_query_supported_feature(const char* app_id, const char* capab
 
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				record_count = 0;
+	type_cache_catalog_s	*catalog = NULL;
 
 	if (app_id == NULL || capability == NULL) {
 		*error_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
 		return false;
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s where app_id='%s' and key='%s'", PROVIDER_FEATURE_TABLE, app_id, capability);
+	catalog = _account_type_catalog_get();
+	if (catalog != NULL) {
+		record_count = type_cache_has_provider_feature(catalog, app_id, capability) ? 1 : 0;
+		type_cache_catalog_unref(catalog);
+	} else {
+		ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) FROM %s where app_id=? and key=?", PROVIDER_FEATURE_TABLE);
 
-	record_count = _account_get_record_count(g_hAccountDB, query);
+		record_count = _account_get_record_count_by_text(g_hAccountDB, query, app_id, capability);
 
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
-		return false;
+		if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+			ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
+			*error_code = _ACCOUNT_ERROR_PERMISSION_DENIED;
+			return false;
+		}
 	}
 
 	if (record_count <= 0) {
@@ -3266,7 +4645,7 @@ static int _account_type_update_provider_feature(sqlite3 *account_db_handle, acc
 	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE app_id=? ", PROVIDER_FEATURE_TABLE);
-	hstmt = _account_prepare_query(account_db_handle, query);
+	hstmt = _account_prepare_cached_query(account_db_handle, query);
 
 	if (_account_db_err_code(account_db_handle) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(account_db_handle));
@@ -3281,7 +4660,7 @@ static int _account_type_update_provider_feature(sqlite3 *account_db_handle, acc
 		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
 		return _ACCOUNT_ERROR_DB_FAILED;
 	}
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -3294,9 +4673,9 @@ static int _account_type_update_provider_feature(sqlite3 *account_db_handle, acc
 		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(app_id, key) VALUES "
 				"(?, ?) ", PROVIDER_FEATURE_TABLE);
 
-		hstmt = _account_prepare_query(account_db_handle, query);
+		hstmt = _account_prepare_cached_query(account_db_handle, query);
 
-		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(account_db_handle)));
+		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_cached_query() failed(%s).\n", _account_db_err_msg(account_db_handle)));
 
 		provider_feature_s* feature_data = NULL;
 		feature_data = (provider_feature_s*)iter->data;
@@ -3312,7 +4691,7 @@ static int _account_type_update_provider_feature(sqlite3 *account_db_handle, acc
 			ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
 			break;
 		}
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -3334,7 +4713,7 @@ static int _account_type_update_label(sqlite3 *account_db_handle, account_type_s
 	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AppId=? ", LABEL_TABLE);
-	hstmt = _account_prepare_query(account_db_handle, query);
+	hstmt = _account_prepare_cached_query(account_db_handle, query);
 
 	if (_account_db_err_code(account_db_handle) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(account_db_handle));
@@ -3349,7 +4728,7 @@ static int _account_type_update_label(sqlite3 *account_db_handle, account_type_s
 		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
 		return _ACCOUNT_ERROR_DB_FAILED;
 	}
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -3362,9 +4741,9 @@ static int _account_type_update_label(sqlite3 *account_db_handle, account_type_s
 		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(AppId, Label, Locale) VALUES "
 				"(?, ?, ?) ", LABEL_TABLE);
 
-		hstmt = _account_prepare_query(account_db_handle, query);
+		hstmt = _account_prepare_cached_query(account_db_handle, query);
 
-		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query() failed(%s).\n", _account_db_err_msg(account_db_handle)));
+		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_cached_query() failed(%s).\n", _account_db_err_msg(account_db_handle)));
 
 		label_s* label_data = NULL;
 		label_data = (label_s*)iter->data;
@@ -3382,7 +4761,7 @@ static int _account_type_update_label(sqlite3 *account_db_handle, account_type_s
 			ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
 			break;
 		}
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -3407,7 +4786,7 @@ static int _account_type_update_account(sqlite3 *account_db_handle, account_type
 	ACCOUNT_SNPRINTF(query, sizeof(query), "UPDATE %s SET AppId=?, ServiceProviderId=?, IconPath=?, "
 			"SmallIconPath=?, MultipleAccountSupport=? WHERE AppId=? ", ACCOUNT_TYPE_TABLE);
 
-	hstmt = _account_prepare_query(account_db_handle, query);
+	hstmt = _account_prepare_cached_query(account_db_handle, query);
 
 	if (_account_db_err_code(account_db_handle) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(account_db_handle));
@@ -3426,7 +4805,7 @@ static int _account_type_update_account(sqlite3 *account_db_handle, account_type
 	if (rc != SQLITE_DONE)
 		ACCOUNT_ERROR("account_db_query_step() failed(%d, %s)", rc, _account_db_err_msg(account_db_handle));
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -3448,11 +4827,10 @@ int _account_type_update_to_db_by_app_id(account_type_s* account_type, const cha
 
 	account_type_s* data = account_type;
 
-	pthread_mutex_lock(&account_mutex);
 
 	error_code = _account_type_update_account(g_hAccountDB, data, app_id);
+	_account_type_catalog_invalidate();
 
-	pthread_mutex_unlock(&account_mutex);
 
 	return error_code;
 }
@@ -3471,7 +4849,7 @@ GSList* _account_type_get_label_list_by_app_id_from_global_db(const char* app_id
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", LABEL_TABLE);
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
@@ -3487,6 +4865,8 @@ GSList* _account_type_get_label_list_by_app_id_from_global_db(const char* app_id
 
 	label_s* label_record = NULL;
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		label_record = (label_s*) malloc(sizeof(label_s));
 
@@ -3500,16 +4880,17 @@ GSList* _account_type_get_label_list_by_app_id_from_global_db(const char* app_id
 		_account_type_convert_column_to_label(hstmt, label_record);
 
 		_INFO("Adding account label_list");
-		label_list = g_slist_append(label_list, label_record);
+		g_ptr_array_add(result_set, label_record);
 
 		rc = _account_query_step(hstmt);
 	}
+	label_list = _account_result_to_slist(label_list, result_set);
 
 	*error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE)
 			_ERR("global db finalize error[%d]", rc);
 		hstmt = NULL;
@@ -3534,7 +4915,7 @@ GSList* _account_type_get_label_list_by_app_id(const char* app_id, int *error_co
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", LABEL_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -3549,6 +4930,8 @@ GSList* _account_type_get_label_list_by_app_id(const char* app_id, int *error_co
 
 	label_s* label_record = NULL;
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		label_record = (label_s*) malloc(sizeof(label_s));
 
@@ -3562,12 +4945,13 @@ GSList* _account_type_get_label_list_by_app_id(const char* app_id, int *error_co
 		_account_type_convert_column_to_label(hstmt, label_record);
 
 		_INFO("Adding account label_list");
-		label_list = g_slist_append(label_list, label_record);
+		g_ptr_array_add(result_set, label_record);
 
 		rc = _account_query_step(hstmt);
 	}
+	label_list = _account_result_to_slist(label_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	if (rc != _ACCOUNT_ERROR_NONE) {
 			_account_type_gslist_label_free(label_list);
 			*error_code = rc;
@@ -3580,7 +4964,7 @@ GSList* _account_type_get_label_list_by_app_id(const char* app_id, int *error_co
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			_account_type_gslist_label_free(label_list);
 			*error_code = rc;
@@ -3614,7 +4998,7 @@ int _account_type_query_label_by_app_id_from_global_db(account_type_label_cb cal
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", LABEL_TABLE);
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
@@ -3655,7 +5039,7 @@ int _account_type_query_label_by_app_id_from_global_db(account_type_label_cb cal
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE)
 			_ERR("global db finalize error[%d]", rc);
 		hstmt = NULL;
@@ -3680,7 +5064,7 @@ int _account_type_query_label_by_app_id(account_type_label_cb callback, const ch
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", LABEL_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -3720,7 +5104,7 @@ int _account_type_query_label_by_app_id(account_type_label_cb callback, const ch
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -3728,7 +5112,7 @@ int _account_type_query_label_by_app_id(account_type_label_cb callback, const ch
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -3797,7 +5181,7 @@ bool _account_get_provider_feature_cb(char* app_id, char* key, void* user_data)
 	return TRUE;
 }
 
-int _account_type_query_by_app_id_from_global_db(const char* app_id, account_type_s** account_type_record)
+int _account_type_query_by_app_id_from_global_db(request_scope_s *scope, const char* app_id, account_type_s** account_type_record)
 {
 	_INFO("_account_type_query_by_app_id_from_global_db start");
 
@@ -3805,15 +5189,23 @@ int _account_type_query_by_app_id_from_global_db(const char* app_id, account_typ
 	account_stmt	hstmt = NULL;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				rc = 0, binding_count = 1;
+	type_cache_catalog_s	*catalog = NULL;
 
 	ACCOUNT_RETURN_VAL((app_id != 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("APP ID IS NULL"));
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 	ACCOUNT_RETURN_VAL((g_hAccountGlobalDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_by_app_id(catalog, app_id, account_type_record);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", ACCOUNT_TYPE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
@@ -3826,13 +5218,14 @@ int _account_type_query_by_app_id_from_global_db(const char* app_id, account_typ
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
 
 	*account_type_record = create_empty_account_type_instance();
+	request_scope_add_cleanup(scope, _account_type_record_destroy, *account_type_record);
 
 	while (rc == SQLITE_ROW) {
 		_account_type_convert_column_to_account_type(hstmt, *account_type_record);
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_CATCH_ERROR((rc == _ACCOUNT_ERROR_NONE), {_ERR("global db finalize error rc=[%d]", rc); }, rc, ("finalize error"));
 	_account_type_query_label_by_app_id_from_global_db(_account_get_label_text_cb, app_id, (void*)(*account_type_record));
 	_account_type_query_provider_feature_cb_by_app_id_from_global_db(_account_get_provider_feature_cb, app_id, (void*)(*account_type_record));
@@ -3842,7 +5235,7 @@ int _account_type_query_by_app_id_from_global_db(const char* app_id, account_typ
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -3852,7 +5245,7 @@ CATCH:
 	return error_code;
 }
 
-int _account_type_query_by_app_id(const char* app_id, account_type_s** account_type_record)
+int _account_type_query_by_app_id(request_scope_s *scope, const char* app_id, account_type_s** account_type_record)
 {
 	_INFO("_account_type_query_by_app_id start");
 
@@ -3860,15 +5253,23 @@ int _account_type_query_by_app_id(const char* app_id, account_type_s** account_t
 	account_stmt	hstmt = NULL;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				rc = 0, binding_count = 1;
+	type_cache_catalog_s	*catalog = NULL;
 
 	ACCOUNT_RETURN_VAL((app_id != 0), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("APP ID IS NULL"));
 	ACCOUNT_RETURN_VAL((account_type_record != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("account type record(account_type_s**) is NULL"));
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
 
+	catalog = _account_type_catalog_get();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_by_app_id(catalog, app_id, account_type_record);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ?", ACCOUNT_TYPE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -3886,13 +5287,14 @@ int _account_type_query_by_app_id(const char* app_id, account_type_s** account_t
 		error_code = _ACCOUNT_ERROR_OUT_OF_MEMORY;
 		goto CATCH;
 	}
+	request_scope_add_cleanup(scope, _account_type_record_destroy, *account_type_record);
 
 	while (rc == SQLITE_ROW) {
 		_account_type_convert_column_to_account_type(hstmt, *account_type_record);
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	_account_type_query_label_by_app_id(_account_get_label_text_cb, app_id, (void*)(*account_type_record));
 	_account_type_query_provider_feature_cb_by_app_id(_account_get_provider_feature_cb, app_id, (void*)(*account_type_record));
@@ -3902,26 +5304,27 @@ int _account_type_query_by_app_id(const char* app_id, account_type_s** account_t
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
 
 	if (error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND)
-		error_code = _account_type_query_by_app_id_from_global_db(app_id, account_type_record);
+		error_code = _account_type_query_by_app_id_from_global_db(scope, app_id, account_type_record);
 
 	_INFO("_account_type_query_by_app_id end [%d]", error_code);
 
 	return error_code;
 }
 
-int _account_type_query_by_provider_feature_from_global_db(const char* key, GSList **account_type_list_all)
+int _account_type_query_by_provider_feature_from_global_db(request_scope_s *scope, const char* key, GSList **account_type_list_all)
 {
 	int error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt	hstmt = NULL;
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				rc = 0;
 	GSList			*account_type_list = NULL;
+	type_cache_catalog_s	*catalog = NULL;
 
 	_INFO("_account_type_query_by_provider_feature_from_global_db start key=%s", key);
 	if (key == NULL) {
@@ -3936,11 +5339,18 @@ int _account_type_query_by_provider_feature_from_global_db(const char* key, GSLi
 		goto CATCH;
 	}
 
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_by_provider_feature(scope, catalog, key, account_type_list_all);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId IN (SELECT app_id from %s WHERE key=?)", ACCOUNT_TYPE_TABLE, PROVIDER_FEATURE_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
@@ -3961,6 +5371,8 @@ int _account_type_query_by_provider_feature_from_global_db(const char* key, GSLi
 		goto CATCH;
 	}
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		account_type_record = (account_type_s*) malloc(sizeof(account_type_s));
 
@@ -3971,11 +5383,12 @@ int _account_type_query_by_provider_feature_from_global_db(const char* key, GSLi
 
 		ACCOUNT_MEMSET(account_type_record, 0x00, sizeof(account_type_s));
 		_account_type_convert_column_to_account_type(hstmt, account_type_record);
-		account_type_list = g_slist_append(account_type_list, account_type_record);
+		g_ptr_array_add(result_set, account_type_record);
 		rc = _account_query_step(hstmt);
 	}
+	account_type_list = _account_result_to_slist(account_type_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	if (rc != _ACCOUNT_ERROR_NONE) {
 		_account_type_gslist_account_type_free(account_type_list);
 		ACCOUNT_ERROR("finalize error(%s)", rc);
@@ -3994,20 +5407,13 @@ int _account_type_query_by_provider_feature_from_global_db(const char* key, GSLi
 		_INFO("add label & provider_feature");
 	}
 
-	for (iter = account_type_list; iter != NULL; iter = g_slist_next(iter)) {
-
-		account_type_s *account_type = NULL;
-		account_type = (account_type_s*)iter->data;
-		*account_type_list_all = g_slist_append(*account_type_list_all, account_type);
-		_INFO("add account_type");
-	}
-	g_slist_free(account_type_list);
+	*account_type_list_all = _account_type_list_to_scope(scope, *account_type_list_all, account_type_list);
 
 	error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			ACCOUNT_ERROR("finalize error(%s)", rc);
 			return rc;
@@ -4020,13 +5426,14 @@ CATCH:
 	return error_code;
 }
 
-GSList* _account_type_query_by_provider_feature(const char* key, int *error_code)
+GSList* _account_type_query_by_provider_feature(request_scope_s *scope, const char* key, int *error_code)
 {
 	*error_code = _ACCOUNT_ERROR_NONE;
 	account_stmt hstmt = NULL;
 	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int rc = 0;
 	GSList *account_type_list = NULL;
+	type_cache_catalog_s *catalog = NULL;
 
 	_INFO("account_type_query_by_provider_feature start key=%s", key);
 	if (key == NULL) {
@@ -4041,11 +5448,18 @@ GSList* _account_type_query_by_provider_feature(const char* key, int *error_code
 		goto CATCH;
 	}
 
+	catalog = _account_type_catalog_get();
+	if (catalog != NULL) {
+		*error_code = _account_type_catalog_query_by_provider_feature(scope, catalog, key, &account_type_list);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId IN (SELECT app_id from %s WHERE key=?)", ACCOUNT_TYPE_TABLE, PROVIDER_FEATURE_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -4066,6 +5480,8 @@ GSList* _account_type_query_by_provider_feature(const char* key, int *error_code
 		goto CATCH;
 	}
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		account_type_record = (account_type_s*) malloc(sizeof(account_type_s));
 
@@ -4076,13 +5492,15 @@ GSList* _account_type_query_by_provider_feature(const char* key, int *error_code
 
 		ACCOUNT_MEMSET(account_type_record, 0x00, sizeof(account_type_s));
 		_account_type_convert_column_to_account_type(hstmt, account_type_record);
-		account_type_list = g_slist_append(account_type_list, account_type_record);
+		g_ptr_array_add(result_set, account_type_record);
 		rc = _account_query_step(hstmt);
 	}
+	account_type_list = _account_result_to_slist(account_type_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	if (rc != _ACCOUNT_ERROR_NONE) {
 		_account_type_gslist_account_type_free(account_type_list);
+		account_type_list = NULL;
 		ACCOUNT_ERROR("finalize error(%s)", rc);
 		*error_code = rc;
 		goto CATCH;
@@ -4098,11 +5516,12 @@ GSList* _account_type_query_by_provider_feature(const char* key, int *error_code
 		_account_type_query_provider_feature_cb_by_app_id(_account_get_provider_feature_cb, account_type->app_id, (void*)account_type);
 	}
 
+	account_type_list = _account_type_list_to_scope(scope, NULL, account_type_list);
 	*error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		if (rc != _ACCOUNT_ERROR_NONE) {
 			*error_code = rc;
 			return NULL;
@@ -4111,10 +5530,10 @@ CATCH:
 	}
 
 	if (*error_code == _ACCOUNT_ERROR_NONE || *error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		rc = _account_type_query_by_provider_feature_from_global_db(key, &account_type_list);
+		rc = _account_type_query_by_provider_feature_from_global_db(scope, key, &account_type_list);
 		if (rc != _ACCOUNT_ERROR_NONE && rc != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
 			ACCOUNT_ERROR("_account_type_query_by_provider_feature_from_global_db fail=[%d]", rc);
-			_account_type_gslist_account_type_free(account_type_list);
+			g_slist_free(account_type_list);
 			return NULL;
 		}
 		if (rc == _ACCOUNT_ERROR_NONE)
@@ -4126,21 +5545,29 @@ CATCH:
 	return account_type_list;
 }
 
-int _account_type_query_all_from_global_db(GSList **account_type_list_all)
+int _account_type_query_all_from_global_db(request_scope_s *scope, GSList **account_type_list_all)
 {
 	account_stmt	hstmt = NULL;
 	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int rc = _ACCOUNT_ERROR_NONE;
 	int error_code = _ACCOUNT_ERROR_NONE;
 	GSList *account_type_list = NULL;
+	type_cache_catalog_s *catalog = NULL;
 
 	_INFO("_account_type_query_all_in_global_db start");
 	ACCOUNT_RETURN_VAL((g_hAccountGlobalDB != NULL), {}, NULL, ("The database isn't connected."));
 
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_all(scope, catalog, account_type_list_all);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s ", ACCOUNT_TYPE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	rc = _account_query_step(hstmt);
 
@@ -4157,6 +5584,8 @@ int _account_type_query_all_from_global_db(GSList **account_type_list_all)
 		goto CATCH;
 	}
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		account_type_record = (account_type_s*) malloc(sizeof(account_type_s));
 
@@ -4167,11 +5596,12 @@ int _account_type_query_all_from_global_db(GSList **account_type_list_all)
 
 		ACCOUNT_MEMSET(account_type_record, 0x00, sizeof(account_type_s));
 		_account_type_convert_column_to_account_type(hstmt, account_type_record);
-		account_type_list = g_slist_append(account_type_list, account_type_record);
+		g_ptr_array_add(result_set, account_type_record);
 		rc = _account_query_step(hstmt);
 	}
+	account_type_list = _account_result_to_slist(account_type_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_type_gslist_account_type_free(account_type_list); }, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -4184,18 +5614,13 @@ int _account_type_query_all_from_global_db(GSList **account_type_list_all)
 		_account_type_query_provider_feature_cb_by_app_id_from_global_db(_account_get_provider_feature_cb, account_type->app_id, (void*)account_type);
 	}
 
-	for (iter = account_type_list; iter != NULL; iter = g_slist_next(iter)) {
-		account_type_s *account_type = NULL;
-		account_type = (account_type_s*)iter->data;
-		*account_type_list_all = g_slist_append(*account_type_list_all, account_type);
-	}
-	g_slist_free(account_type_list);
+	*account_type_list_all = _account_type_list_to_scope(scope, *account_type_list_all, account_type_list);
 
 	error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_type_gslist_account_type_free(account_type_list); }, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -4205,21 +5630,29 @@ CATCH:
 	return error_code;
 }
 
-GSList* _account_type_query_all(void)
+GSList* _account_type_query_all(request_scope_s *scope)
 {
 	account_stmt hstmt = NULL;
 	char query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int rc = 0;
 	int error_code = _ACCOUNT_ERROR_NONE;
 	GSList *account_type_list = NULL;
+	type_cache_catalog_s *catalog = NULL;
 
 	_INFO("_account_type_query_all start");
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, NULL, ("The database isn't connected."));
 
+	catalog = _account_type_catalog_get();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_all(scope, catalog, &account_type_list);
+		_account_type_catalog_hold(scope, catalog);
+		goto CATCH;
+	}
+
 	ACCOUNT_MEMSET(query, 0x00, ACCOUNT_SQL_LEN_MAX);
 
 	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s ", ACCOUNT_TYPE_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	rc = _account_query_step(hstmt);
 
@@ -4236,6 +5669,8 @@ GSList* _account_type_query_all(void)
 		goto CATCH;
 	}
 
+	GPtrArray *result_set = g_ptr_array_new();
+
 	while (rc == SQLITE_ROW) {
 		account_type_record = (account_type_s*) malloc(sizeof(account_type_s));
 
@@ -4246,11 +5681,12 @@ GSList* _account_type_query_all(void)
 
 		ACCOUNT_MEMSET(account_type_record, 0x00, sizeof(account_type_s));
 		_account_type_convert_column_to_account_type(hstmt, account_type_record);
-		account_type_list = g_slist_append(account_type_list, account_type_record);
+		g_ptr_array_add(result_set, account_type_record);
 		rc = _account_query_step(hstmt);
 	}
+	account_type_list = _account_result_to_slist(account_type_list, result_set);
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_type_gslist_account_type_free(account_type_list); }, NULL, ("finalize error"));
 	hstmt = NULL;
 
@@ -4263,20 +5699,21 @@ GSList* _account_type_query_all(void)
 		_account_type_query_provider_feature_cb_by_app_id(_account_get_provider_feature_cb, account_type->app_id, (void*)account_type);
 	}
 
+	account_type_list = _account_type_list_to_scope(scope, NULL, account_type_list);
 	error_code = _ACCOUNT_ERROR_NONE;
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {_account_type_gslist_account_type_free(account_type_list); }, NULL, ("finalize error"));
 		hstmt = NULL;
 	}
 
 	if (error_code == _ACCOUNT_ERROR_NONE || error_code == _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
-		error_code = _account_type_query_all_from_global_db(&account_type_list);
+		error_code = _account_type_query_all_from_global_db(scope, &account_type_list);
 		if (rc != _ACCOUNT_ERROR_NONE && rc != _ACCOUNT_ERROR_RECORD_NOT_FOUND) {
 			ACCOUNT_ERROR("_account_type_query_all_from_global_db fail=[%d]", rc);
-			_account_type_gslist_account_type_free(account_type_list);
+			g_slist_free(account_type_list);
 			return NULL;
 		}
 	}
@@ -4294,6 +5731,7 @@ int _account_type_query_label_by_locale_from_global_db(const char* app_id, const
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				rc = 0, binding_count = 1;
 	char*			converted_locale = NULL;
+	type_cache_catalog_s	*catalog = NULL;
 
 	ACCOUNT_RETURN_VAL((app_id != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("NO APP ID"));
 	ACCOUNT_RETURN_VAL((g_hAccountGlobalDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
@@ -4318,17 +5756,28 @@ int _account_type_query_label_by_locale_from_global_db(const char* app_id, const
 	}
 	g_strfreev(tokens);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ? AND Locale = '%s' ", LABEL_TABLE, converted_locale);
-	_ACCOUNT_FREE(converted_locale);
+	catalog = _account_type_catalog_get_from_global_db();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_label(catalog, app_id, converted_locale, label);
+		type_cache_catalog_unref(catalog);
+		_ACCOUNT_FREE(converted_locale);
+		goto CATCH;
+	}
+
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ? AND Locale = ? ", LABEL_TABLE);
 
-	hstmt = _account_prepare_query(g_hAccountGlobalDB, query);
+	hstmt = _account_prepare_cached_query(g_hAccountGlobalDB, query);
 
 	if (_account_db_err_code(g_hAccountGlobalDB) == SQLITE_PERM) {
+		_ACCOUNT_FREE(converted_locale);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountGlobalDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	_account_query_bind_text(hstmt, binding_count++, app_id);
+	/* converted_locale is freed before the step, let sqlite keep its own copy */
+	sqlite3_bind_text(hstmt, binding_count++, converted_locale, -1, SQLITE_TRANSIENT);
+	_ACCOUNT_FREE(converted_locale);
 
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
@@ -4356,7 +5805,7 @@ int _account_type_query_label_by_locale_from_global_db(const char* app_id, const
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -4364,7 +5813,7 @@ int _account_type_query_label_by_locale_from_global_db(const char* app_id, const
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -4382,6 +5831,7 @@ int _account_type_query_label_by_locale(const char* app_id, const char* locale,
 	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
 	int				rc = 0, binding_count = 1;
 	char*			converted_locale = NULL;
+	type_cache_catalog_s	*catalog = NULL;
 
 	ACCOUNT_RETURN_VAL((app_id != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("NO APP ID"));
 	ACCOUNT_RETURN_VAL((g_hAccountDB != NULL), {}, _ACCOUNT_ERROR_DB_NOT_OPENED, ("The database isn't connected."));
@@ -4406,17 +5856,28 @@ int _account_type_query_label_by_locale(const char* app_id, const char* locale,
 	}
 	g_strfreev(tokens);
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ? AND Locale = '%s' ", LABEL_TABLE, converted_locale);
-	_ACCOUNT_FREE(converted_locale);
+	catalog = _account_type_catalog_get();
+	if (catalog != NULL) {
+		error_code = _account_type_catalog_query_label(catalog, app_id, converted_locale, label);
+		type_cache_catalog_unref(catalog);
+		_ACCOUNT_FREE(converted_locale);
+		goto CATCH;
+	}
 
-	hstmt = _account_prepare_query(g_hAccountDB, query);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT * FROM %s WHERE AppId = ? AND Locale = ? ", LABEL_TABLE);
+
+	hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
+		_ACCOUNT_FREE(converted_locale);
 		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
 	_account_query_bind_text(hstmt, binding_count++, app_id);
+	/* converted_locale is freed before the step, let sqlite keep its own copy */
+	sqlite3_bind_text(hstmt, binding_count++, converted_locale, -1, SQLITE_TRANSIENT);
+	_ACCOUNT_FREE(converted_locale);
 
 	rc = _account_query_step(hstmt);
 	ACCOUNT_CATCH_ERROR(rc == SQLITE_ROW, {}, _ACCOUNT_ERROR_RECORD_NOT_FOUND, ("The record isn't found.\n"));
@@ -4444,7 +5905,7 @@ int _account_type_query_label_by_locale(const char* app_id, const char* locale,
 		rc = _account_query_step(hstmt);
 	}
 
-	rc = _account_query_finalize(hstmt);
+	rc = _account_query_release(hstmt);
 	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 	hstmt = NULL;
 
@@ -4452,7 +5913,7 @@ int _account_type_query_label_by_locale(const char* app_id, const char* locale,
 
 CATCH:
 	if (hstmt != NULL) {
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 	}
@@ -4480,9 +5941,9 @@ static int _account_insert_custom(account_s *account, int account_id)
 		return _ACCOUNT_ERROR_NONE;
 	}
 
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=%d", ACCOUNT_TABLE, account_id);
+	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=?", ACCOUNT_TABLE);
 
-	rc = _account_get_record_count(g_hAccountDB, query);
+	rc = _account_get_record_count_by_int(g_hAccountDB, query, account_id);
 
 	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 		ACCOUNT_ERROR("Access failed(%d, %s)", _account_db_err_msg(g_hAccountDB));
@@ -4505,7 +5966,7 @@ static int _account_insert_custom(account_s *account, int account_id)
 		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s (AccountId, AppId, Key, Value) VALUES "
 				"(?, ?, ?, ?) ", ACCOUNT_CUSTOM_TABLE);
 
-		hstmt = _account_prepare_query(g_hAccountDB, query);
+		hstmt = _account_prepare_cached_query(g_hAccountDB, query);
 
 		if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
 			ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
@@ -4533,7 +5994,7 @@ static int _account_insert_custom(account_s *account, int account_id)
 			break;
 		}
 
-		rc = _account_query_finalize(hstmt);
+		rc = _account_query_release(hstmt);
 		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
 		hstmt = NULL;
 
@@ -4544,101 +6005,3 @@ static int _account_insert_custom(account_s *account, int account_id)
 	return _ACCOUNT_ERROR_NONE;
 }
 
-static int _account_update_custom(account_s *account, int account_id)
-{
-	int				rc, count = 1;
-	char			query[ACCOUNT_SQL_LEN_MAX] = {0, };
-	account_stmt	hstmt = NULL;
-
-	ACCOUNT_RETURN_VAL((account != NULL), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("ACCOUNT HANDLE IS NULL"));
-
-	if (g_slist_length(account->custom_list) == 0) {
-		ACCOUNT_DEBUG("_account_update_custom, no custom data\n");
-		return _ACCOUNT_ERROR_NONE;
-	}
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "SELECT COUNT(*) from %s where _id=%d", ACCOUNT_TABLE, account_id);
-
-	rc = _account_get_record_count(g_hAccountDB, query);
-
-	if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-		ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
-	} else if (_account_db_err_code(g_hAccountDB) == SQLITE_BUSY) {
-		ACCOUNT_ERROR("database busy(%s)", _account_db_err_msg(g_hAccountDB));
-		pthread_mutex_unlock(&account_mutex);
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	}
-
-	if (rc <= 0) {
-		ACCOUNT_SLOGE("_account_update_custom : related account item is not existed rc=%d , %s", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_RECORD_NOT_FOUND;
-	}
-
-	ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-
-	ACCOUNT_SNPRINTF(query, sizeof(query), "DELETE FROM %s WHERE AccountId=? ", ACCOUNT_CUSTOM_TABLE);
-	hstmt = _account_prepare_query(g_hAccountDB, query);
-	count = 1;
-	_account_query_bind_int(hstmt, count++, (int)account_id);
-	rc = _account_query_step(hstmt);
-
-	if (rc == SQLITE_BUSY) {
-		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_DATABASE_BUSY;
-	} else if (rc != SQLITE_DONE) {
-		ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-		return _ACCOUNT_ERROR_DB_FAILED;
-	}
-
-	rc = _account_query_finalize(hstmt);
-	ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-	hstmt = NULL;
-
-	GSList *iter;
-
-	for (iter = account->custom_list; iter != NULL; iter = g_slist_next(iter)) {
-		int ret;
-		count = 1;
-		ACCOUNT_MEMSET(query, 0x00, sizeof(query));
-		ACCOUNT_SNPRINTF(query, sizeof(query), "INSERT INTO %s(AccountId, AppId, Key, Value) VALUES "
-				"(?, ?, ?, ?) ", ACCOUNT_CUSTOM_TABLE);
-
-		hstmt = _account_prepare_query(g_hAccountDB, query);
-
-		if (_account_db_err_code(g_hAccountDB) == SQLITE_PERM) {
-			ACCOUNT_ERROR("Access failed(%s)", _account_db_err_msg(g_hAccountDB));
-			return _ACCOUNT_ERROR_PERMISSION_DENIED;
-		}
-
-		ACCOUNT_RETURN_VAL((hstmt != NULL), {}, _ACCOUNT_ERROR_DB_FAILED, ("_account_prepare_query(g_hAccountDB, ) failed(%s).\n", _account_db_err_msg(g_hAccountDB)));
-
-		account_custom_s* custom_data = NULL;
-		custom_data = (account_custom_s*)iter->data;
-
-		ret = _account_query_bind_int(hstmt, count++, (int)account_id);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Int binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)account->package_name);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)custom_data->key);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-		ret = _account_query_bind_text(hstmt, count++, (char*)custom_data->value);
-		ACCOUNT_RETURN_VAL((ret == _ACCOUNT_ERROR_NONE), {}, _ACCOUNT_ERROR_INVALID_PARAMETER, ("Text binding fail"));
-
-		rc = _account_query_step(hstmt);
-
-		if (rc != SQLITE_DONE) {
-			ACCOUNT_ERROR("_account_query_step() failed(%d, %s)", rc, _account_db_err_msg(g_hAccountDB));
-			break;
-		}
-
-		rc = _account_query_finalize(hstmt);
-		ACCOUNT_RETURN_VAL((rc == _ACCOUNT_ERROR_NONE), {}, rc, ("finalize error"));
-		hstmt = NULL;
-
-	}
-
-	return _ACCOUNT_ERROR_NONE;
-}
-
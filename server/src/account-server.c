@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <pthread.h>
 #include <glib.h>
 #if !GLIB_CHECK_VERSION(2, 31, 0)
 #include <glib/gmacros.h>
@@ -36,15 +37,83 @@
 #include <account_err.h>
 
 #include "account-server-db.h"
+#include "app-group-cache.h"
+#include "appid-cache.h"
+#include "change-noti.h"
+#include "client-cache.h"
 #include "lifecycle.h"
+#include "method-stats.h"
+#include "request-scope.h"
+#include "type-cache.h"
 #define _PRIVILEGE_ACCOUNT_READ "http://tizen.org/privilege/account.read"
 #define _PRIVILEGE_ACCOUNT_WRITE "http://tizen.org/privilege/account.write"
 
 #define ACCOUNT_MGR_DBUS_PATH       "/org/tizen/account/manager"
+#define ACCOUNT_MGR_EXT_DBUS_INTERFACE "org.tizen.account.manager.ext"
+#define ACCOUNT_MGR_STATS_DBUS_INTERFACE "org.tizen.account.manager.Stats"
+/* accounts stored by one account_add_batch call, the writer is held for the whole batch */
+#define ACCOUNT_ADD_BATCH_MAX 1024
+/* a page is cut short once its accounts marshal to this many bytes, far below the bus message limit */
+#define ACCOUNT_QUERY_PAGE_BYTES (512 * 1024)
+#define CYNARA_CACHE_SIZE 100
 static guint owner_id = 0;
 static AccountManager* account_mgr_server_obj = NULL;
 static GMainLoop *mainloop = NULL;
 static cynara *p_cynara;
+/* the cynara handle is not thread safe and handlers run on worker threads */
+static pthread_mutex_t cynara_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* cynara, the package listener and the global db are set up here while the bus name is claimed */
+static GThread *startup_thread = NULL;
+
+/* methods the generated account-mgr-stub does not carry, exported next to it on the same path */
+static const gchar account_mgr_ext_introspection_xml[] =
+	"<node>"
+	"  <interface name='"ACCOUNT_MGR_EXT_DBUS_INTERFACE"'>"
+	"    <method name='account_add_batch'>"
+	"      <arg type='aa{sv}' name='account_data_list' direction='in'/>"
+	"      <arg type='i' name='uid' direction='in'/>"
+	"      <arg type='ai' name='account_db_ids' direction='out'/>"
+	"    </method>"
+	"    <method name='account_query_page'>"
+	"      <arg type='s' name='filter' direction='in'/>"
+	"      <arg type='s' name='text' direction='in'/>"
+	"      <arg type='i' name='value' direction='in'/>"
+	"      <arg type='i' name='after_id' direction='in'/>"
+	"      <arg type='i' name='limit' direction='in'/>"
+	"      <arg type='i' name='uid' direction='in'/>"
+	"      <arg type='aa{sv}' name='account_list' direction='out'/>"
+	"      <arg type='i' name='next_cursor' direction='out'/>"
+	"    </method>"
+	"    <method name='account_patch'>"
+	"      <arg type='i' name='account_db_id' direction='in'/>"
+	"      <arg type='u' name='field_mask' direction='in'/>"
+	"      <arg type='a{sv}' name='values' direction='in'/>"
+	"      <arg type='i' name='uid' direction='in'/>"
+	"    </method>"
+	"    <signal name='"CHANGE_NOTI_SIGNAL"'>"
+	"      <arg type='a(sis)' name='changes'/>"
+	"    </signal>"
+	"  </interface>"
+	"</node>";
+static GDBusNodeInfo *account_mgr_ext_node = NULL;
+static guint account_mgr_ext_registration_id = 0;
+
+/* per method call counts and phase latencies, see method-stats.h */
+static const gchar account_mgr_stats_introspection_xml[] =
+	"<node>"
+	"  <interface name='"ACCOUNT_MGR_STATS_DBUS_INTERFACE"'>"
+	"    <method name='get_method_stats'>"
+	"      <arg type='at' name='bucket_bounds' direction='out'/>"
+	"      <arg type='a{s(ta{it}a{s(tttat)})}' name='methods' direction='out'/>"
+	"    </method>"
+	"    <method name='reset_method_stats'/>"
+	"  </interface>"
+	"</node>";
+static GDBusNodeInfo *account_mgr_stats_node = NULL;
+static guint account_mgr_stats_registration_id = 0;
+
+/* seconds the shutdown waits for calls the skeleton already dispatched */
+#define ACCOUNT_DRAIN_TIMEOUT 10
 
 //static gboolean has_owner = FALSE;
 
@@ -74,7 +143,7 @@ GDBusErrorEntry _account_svc_errors[] = {
 };
 
 static guint
-_get_client_pid(GDBusMethodInvocation* invoc)
+__get_client_pid(GDBusMethodInvocation* invoc)
 {
 	const char *name = NULL;
 	name = g_dbus_method_invocation_get_sender(invoc);
@@ -86,12 +155,18 @@ _get_client_pid(GDBusMethodInvocation* invoc)
 
 
 	guint pid = -1;
+	uid_t uid = 0;
 	GError *error = NULL;
 	GVariant *_ret;
 
+	GDBusConnection* conn = g_dbus_method_invocation_get_connection(invoc);
+	if (client_cache_get_peer_creds(conn, name, &pid, &uid, NULL) == 0) {
+		_INFO("process Id = [%u]", pid);
+		return pid;
+	}
+
 	_INFO("calling GetConnectionUnixProcessID");
 
-	GDBusConnection* conn = g_dbus_method_invocation_get_connection(invoc);
 	_ret = g_dbus_connection_call_sync(conn,
 			"org.freedesktop.DBus",
 			"/org/freedesktop/DBus",
@@ -113,6 +188,18 @@ _get_client_pid(GDBusMethodInvocation* invoc)
 	return pid;
 }
 
+static guint
+_get_client_pid(GDBusMethodInvocation* invoc)
+{
+	guint pid = -1;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_PID);
+	pid = __get_client_pid(invoc);
+	method_stats_phase_end(METHOD_STATS_PHASE_PID);
+
+	return pid;
+}
+
 static GQuark
 __ACCOUNT_ERROR_quark(void)
 {
@@ -126,12 +213,45 @@ __ACCOUNT_ERROR_quark(void)
 	return (GQuark) quark_volatile;
 }
 
+/* called with cynara_mutex held, a failed initialization is retried by the next check */
+static int __initialize_cynara(void)
+{
+	int ret = -1;
+	cynara_configuration *p_conf = NULL;
+
+	if (p_cynara != NULL)
+		return CYNARA_API_SUCCESS;
+
+	ret = cynara_configuration_create(&p_conf);
+	if (ret == CYNARA_API_SUCCESS) {
+		ret = cynara_configuration_set_cache_size(p_conf, CYNARA_CACHE_SIZE);
+		if (ret != CYNARA_API_SUCCESS)
+			_ERR("cynara_configuration_set_cache_size fail, ret = %d", ret);
+	} else {
+		_ERR("cynara_configuration_create fail, ret = %d", ret);
+	}
+
+	ret = cynara_initialize(&p_cynara, p_conf);
+	cynara_configuration_destroy(p_conf);
+	if (ret != CYNARA_API_SUCCESS) {
+		_ERR("CYNARA Initialization fail, ret = %d", ret);
+		p_cynara = NULL;
+	}
+
+	return ret;
+}
+
 static int __check_privilege_by_cynara(const char *client, const char *session, const char *user, const char *privilege)
 {
 	int ret;
 	char err_buf[128] = {0,};
 
-	ret = cynara_check(p_cynara, client, session, user, privilege);
+	/* a check coming in before the startup thread is done waits for it here */
+	pthread_mutex_lock(&cynara_mutex);
+	ret = __initialize_cynara();
+	if (ret == CYNARA_API_SUCCESS)
+		ret = cynara_check(p_cynara, client, session, user, privilege);
+	pthread_mutex_unlock(&cynara_mutex);
 	switch (ret) {
 	case CYNARA_API_ACCESS_ALLOWED:
 		_DBG("cynara_check success");
@@ -166,19 +286,27 @@ int __get_information_for_cynara_check(GDBusMethodInvocation *invocation, char *
 		return -1;
 	}
 
-	ret = cynara_creds_gdbus_get_user(gdbus_conn, sender, USER_METHOD_DEFAULT, user);
-	if (ret != CYNARA_API_SUCCESS) {
-		_ERR("cynara_creds_gdbus_get_user failed, ret = %d", ret);
-		return -1;
-	}
+	guint pid = -1;
+	uid_t uid = 0;
 
-	ret = cynara_creds_gdbus_get_client(gdbus_conn, sender, CLIENT_METHOD_DEFAULT, client);
-	if (ret != CYNARA_API_SUCCESS) {
-		_ERR("cynara_creds_gdbus_get_client failed, ret = %d", ret);
-		return -1;
-	}
+	/* cynara's default creds methods are the uid and the smack label, both come with the peer creds */
+	if (client_cache_get_peer_creds(gdbus_conn, sender, &pid, &uid, client) == 0 && *client != NULL) {
+		*user = g_strdup_printf("%u", uid);
+	} else {
+		ret = cynara_creds_gdbus_get_user(gdbus_conn, sender, USER_METHOD_DEFAULT, user);
+		if (ret != CYNARA_API_SUCCESS) {
+			_ERR("cynara_creds_gdbus_get_user failed, ret = %d", ret);
+			return -1;
+		}
 
-	guint pid = _get_client_pid(invocation);
+		ret = cynara_creds_gdbus_get_client(gdbus_conn, sender, CLIENT_METHOD_DEFAULT, client);
+		if (ret != CYNARA_API_SUCCESS) {
+			_ERR("cynara_creds_gdbus_get_client failed, ret = %d", ret);
+			return -1;
+		}
+
+		pid = _get_client_pid(invocation);
+	}
 	_INFO("client Id = [%u]", pid);
 
 	*session = cynara_session_from_pid(pid);
@@ -190,21 +318,30 @@ int __get_information_for_cynara_check(GDBusMethodInvocation *invocation, char *
 	return _ACCOUNT_ERROR_NONE;
 }
 
-int _check_privilege(GDBusMethodInvocation *invocation, const char* privilege)
+static int __check_privilege(GDBusMethodInvocation *invocation, const char* privilege)
 {
 	int ret = -1;
 	char *client = NULL;
 	char *session = NULL;
 	char *user = NULL;
+	const char *sender = g_dbus_method_invocation_get_sender(invocation);
 
-	ret = __get_information_for_cynara_check(invocation, &client, &user, &session);
-	if (ret != _ACCOUNT_ERROR_NONE) {
-		_ERR("__get_information_for_cynara_check failed");
-		g_free(client);
-		g_free(user);
-		_ACCOUNT_FREE(session);
+	if (client_cache_lookup_privilege(sender, privilege)) {
+		_DBG("cached privilege hit, sender=%s, privilege=%s", sender, privilege);
+		return _ACCOUNT_ERROR_NONE;
+	}
 
-		return _ACCOUNT_ERROR_PERMISSION_DENIED;
+	if (!client_cache_lookup_creds(sender, &client, &user, &session)) {
+		ret = __get_information_for_cynara_check(invocation, &client, &user, &session);
+		if (ret != _ACCOUNT_ERROR_NONE) {
+			_ERR("__get_information_for_cynara_check failed");
+			g_free(client);
+			g_free(user);
+			_ACCOUNT_FREE(session);
+
+			return _ACCOUNT_ERROR_PERMISSION_DENIED;
+		}
+		client_cache_store_creds(sender, client, user, session);
 	}
 
 	ret = __check_privilege_by_cynara(client, session, user, privilege);
@@ -217,6 +354,9 @@ int _check_privilege(GDBusMethodInvocation *invocation, const char* privilege)
 		return _ACCOUNT_ERROR_PERMISSION_DENIED;
 	}
 
+	/* only grants are cached, denials and cynara errors are asked again next time */
+	client_cache_store_privilege(sender, privilege);
+
 	g_free(client);
 	g_free(user);
 	_ACCOUNT_FREE(session);
@@ -224,6 +364,17 @@ int _check_privilege(GDBusMethodInvocation *invocation, const char* privilege)
 	return _ACCOUNT_ERROR_NONE;
 }
 
+int _check_privilege(GDBusMethodInvocation *invocation, const char* privilege)
+{
+	int ret = -1;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_PRIVILEGE);
+	ret = __check_privilege(invocation, privilege);
+	method_stats_phase_end(METHOD_STATS_PHASE_PRIVILEGE);
+
+	return ret;
+}
+
 int _check_priviliege_account_read(GDBusMethodInvocation *invocation)
 {
 	return _check_privilege(invocation, _PRIVILEGE_ACCOUNT_READ);
@@ -238,6 +389,7 @@ gboolean account_manager_account_add(AccountManager *obj, GDBusMethodInvocation
 {
 	_INFO("account_manager_account_add start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	int db_id = -1;
 	account_s* account = NULL;
@@ -284,6 +436,7 @@ gboolean account_manager_account_add(AccountManager *obj, GDBusMethodInvocation
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -308,23 +461,48 @@ RETURN:
 
 	_account_free_account_with_items(account);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_add end");
 
 	return true;
 }
 
+typedef struct _account_list_reply_s {
+	GVariantBuilder builder;
+	int count;
+} account_list_reply_s;
+
+/* every account goes into the reply as soon as it is read, nothing else is kept of it */
+static bool _account_list_add_cb(account_s *account, void *user_data)
+{
+	account_list_reply_s *reply = (account_list_reply_s *)user_data;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
+	g_variant_builder_add_value(&reply->builder, marshal_account(account));
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
+	reply->count++;
+
+	return true;
+}
+
 gboolean
 account_manager_account_query_all(AccountManager *obj, GDBusMethodInvocation *invocation, gint uid)
 {
 	_INFO("account_manager_account_query_all start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_list_variant = NULL;
+	account_list_reply_s reply;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 	_INFO("client Id = [%u]", pid);
 
+	reply.count = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
 	int return_code = _check_priviliege_account_read(invocation);
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
@@ -345,26 +523,27 @@ account_manager_account_query_all(AccountManager *obj, GDBusMethodInvocation *in
 
 	//Mode checking not required, since default mode is read.
 
-	GSList *account_list = NULL;
-	account_list = _account_db_query_all(pid, (uid_t)uid);
+	return_code = _account_query_stream(scope, pid, (uid_t)uid, "all", NULL, 0, _account_list_add_cb, &reply);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_stream() error, ret = %d", return_code);
+		goto RETURN;
+	}
 
-	if (account_list == NULL) {
+	if (reply.count == 0) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 		_ERR("No account found.");
 		goto RETURN;
 	}
 
-	_INFO("account_list length= [%d]", g_slist_length(account_list));
+	_INFO("account_list length= [%d]", reply.count);
 
-	return_code = 0;
-	_INFO("before calling marshal_account_list");
-	account_list_variant = marshal_account_list(account_list);
-	_account_gslist_account_free(account_list);
-	_INFO("after calling marshal_account_list");
+	account_list_variant = g_variant_builder_end(&reply.builder);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_list_variant == NULL) {
+		g_variant_builder_clear(&reply.builder);
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
 		g_dbus_method_invocation_return_gerror(invocation, error);
 		g_error_free(error);
@@ -384,6 +563,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_query_all end");
 
@@ -395,8 +577,11 @@ account_manager_account_type_query_all(AccountManager *obj, GDBusMethodInvocatio
 {
 	_INFO("account_manager_account_query_all start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_type_list_variant = NULL;
+	GSList *account_type_list = NULL;
+	request_scope_s *scope = request_scope_new();
 	guint pid = _get_client_pid(invocation);
 	_INFO("client Id = [%u]", pid);
 
@@ -420,8 +605,7 @@ account_manager_account_type_query_all(AccountManager *obj, GDBusMethodInvocatio
 
 	//Mode checking not required, since default mode is read.
 
-	GSList *account_type_list = NULL;
-	account_type_list = _account_type_query_all();
+	account_type_list = _account_type_query_all(scope);
 
 	if (account_type_list == NULL) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
@@ -433,11 +617,13 @@ account_manager_account_type_query_all(AccountManager *obj, GDBusMethodInvocatio
 
 	return_code = 0;
 	_INFO("before calling marshal_account_type_list");
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
 	account_type_list_variant = marshal_account_type_list(account_type_list);
-	_account_type_gslist_account_type_free(account_type_list);
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
 	_INFO("after calling marshal_account_type_list");
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_type_list_variant == NULL) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -459,6 +645,10 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	g_slist_free(account_type_list);
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_query_all end");
 
@@ -470,6 +660,7 @@ account_manager_account_type_add(AccountManager *obj, GDBusMethodInvocation *inv
 {
 	_INFO("account_manager_account_type_add start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	int db_id = -1;
 	account_type_s *account_type = NULL;
@@ -518,6 +709,7 @@ account_manager_account_type_add(AccountManager *obj, GDBusMethodInvocation *inv
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -542,6 +734,7 @@ RETURN:
 
 	_account_type_free_account_type_with_items(account_type);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_type_add end");
 
@@ -556,6 +749,7 @@ account_manager_account_delete_from_db_by_id(AccountManager *object,
 {
 	_INFO("account_manager_account_delete_from_db_by_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	guint pid = _get_client_pid(invocation);
 	_INFO("client Id = [%u]", pid);
@@ -594,6 +788,7 @@ account_manager_account_delete_from_db_by_id(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -616,6 +811,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_delete_from_db_by_id end");
 
@@ -631,6 +827,7 @@ account_manager_account_delete_from_db_by_user_name(AccountManager *object,
 {
 	_INFO("account_manager_account_delete_from_db_by_user_name start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	guint pid = _get_client_pid(invocation);
 	_INFO("client Id = [%u]", pid);
@@ -669,6 +866,7 @@ account_manager_account_delete_from_db_by_user_name(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -691,6 +889,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_delete_from_db_by_user_name end");
 
@@ -706,6 +905,7 @@ account_manager_account_delete_from_db_by_package_name(AccountManager *object,
 {
 	_INFO("account_manager_account_delete_from_db_by_package_name start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	int return_code = _ACCOUNT_ERROR_NONE;
 
@@ -748,6 +948,7 @@ account_manager_account_delete_from_db_by_package_name(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -770,6 +971,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_delete_from_db_by_package_name end");
 
@@ -785,6 +987,7 @@ account_manager_account_update_to_db_by_id(AccountManager *object,
 {
 	_INFO("account_manager_account_update_to_db_by_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	account_s *account = NULL;
 
@@ -832,6 +1035,7 @@ account_manager_account_update_to_db_by_id(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -856,6 +1060,7 @@ RETURN:
 
 	_account_free_account_with_items(account);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_update_to_db_by_id end");
 
@@ -872,6 +1077,7 @@ account_manager_handle_account_update_to_db_by_user_name(AccountManager *object,
 {
 	_INFO("account_manager_handle_account_update_to_db_by_user_name start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	account_s* account = NULL;
 
@@ -919,6 +1125,7 @@ account_manager_handle_account_update_to_db_by_user_name(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -943,6 +1150,7 @@ RETURN:
 
 	_account_free_account_with_items(account);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_update_to_db_by_user_name end");
 
@@ -958,6 +1166,7 @@ account_manager_handle_account_type_query_label_by_locale(AccountManager *object
 {
 	_INFO("account_manager_handle_account_type_query_label_by_locale start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	char *label_name = NULL;
 	guint pid = _get_client_pid(invocation);
@@ -992,6 +1201,7 @@ account_manager_handle_account_type_query_label_by_locale(AccountManager *object
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -1015,6 +1225,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_label_by_locale end");
 
@@ -1029,8 +1240,11 @@ account_manager_handle_account_type_query_by_provider_feature(AccountManager *ob
 {
 	_INFO("account_manager_handle_account_type_query_by_provider_feature start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_type_list_variant = NULL;
+	GSList *account_type_list = NULL;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 
@@ -1056,9 +1270,7 @@ account_manager_handle_account_type_query_by_provider_feature(AccountManager *ob
 
 	//Mode checking not required, since default mode is read.
 
-	GSList *account_type_list = NULL;
-
-	account_type_list = _account_type_query_by_provider_feature(key, &return_code);
+	account_type_list = _account_type_query_by_provider_feature(scope, key, &return_code);
 	if (return_code != 0) {
 		_ERR("_account_type_query_by_provider_feature=[%d]", return_code);
 		goto RETURN;
@@ -1078,11 +1290,13 @@ account_manager_handle_account_type_query_by_provider_feature(AccountManager *ob
 	_INFO("account_type_list length= [%d]", g_slist_length(account_type_list));
 
 	_INFO("before calling marshal_account_type_list");
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
 	account_type_list_variant = marshal_account_type_list(account_type_list);
-	_account_type_gslist_account_type_free(account_type_list);
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
 	_INFO("after calling marshal_account_type_list");
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_type_list_variant == NULL) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), _ACCOUNT_ERROR_RECORD_NOT_FOUND, "RecordNotFound");
@@ -1104,6 +1318,10 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	g_slist_free(account_type_list);
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_by_provider_feature end");
 
@@ -1115,6 +1333,7 @@ account_manager_account_get_total_count_from_db(AccountManager *object, GDBusMet
 {
 	_INFO("account_manager_account_get_total_count_from_db start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	int count = -1;
 	guint pid = _get_client_pid(invocation);
@@ -1149,6 +1368,7 @@ account_manager_account_get_total_count_from_db(AccountManager *object, GDBusMet
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -1171,6 +1391,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_account_get_total_count_from_db end");
 
@@ -1183,9 +1404,11 @@ account_manager_handle_account_query_account_by_account_id(AccountManager *objec
 {
 	_INFO("account_manager_handle_account_query_account_by_account_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_variant = NULL;
 	account_s* account_data = NULL;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 
@@ -1209,20 +1432,16 @@ account_manager_handle_account_query_account_by_account_id(AccountManager *objec
 		goto RETURN;
 	}
 
-	account_data = create_empty_account_instance();
-	if (account_data == NULL) {
-		_ERR("out of memory");
-		return_code = _ACCOUNT_ERROR_DB_FAILED;
-		goto RETURN;
-	}
-
 	_INFO("before _account_query_account_by_account_id");
-	return_code = _account_query_account_by_account_id(pid, (uid_t)uid, account_db_id, account_data);
+	return_code = _account_query_account_by_account_id(scope, pid, (uid_t)uid, account_db_id, &account_data);
 	_INFO("after _account_query_account_by_return_code=[%d]", return_code);
-	_INFO("user_name = %s, user_data_txt[0] = %s, user_data_int[1] = %d", account_data->user_name, account_data->user_data_txt[0], account_data->user_data_int[1]);
 
-	if (return_code == _ACCOUNT_ERROR_NONE)
+	if (return_code == _ACCOUNT_ERROR_NONE) {
+		_INFO("user_name = %s, user_data_txt[0] = %s, user_data_int[1] = %d", account_data->user_name, account_data->user_data_txt[0], account_data->user_data_int[1]);
+		method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
 		account_variant = marshal_account(account_data);
+		method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
+	}
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_account_type_query_label_by_locale error");
@@ -1230,6 +1449,7 @@ account_manager_handle_account_query_account_by_account_id(AccountManager *objec
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_variant == NULL || return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -1251,8 +1471,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
-	_account_free_account_with_items(account_data);
+	request_scope_free(scope);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_account_by_account_id end");
 
@@ -1267,12 +1488,18 @@ account_manager_handle_account_query_account_by_user_name(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_query_account_by_user_name start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_list_variant = NULL;
+	account_list_reply_s reply;
+	request_scope_s *scope = request_scope_new();
 	guint pid = _get_client_pid(invocation);
 
 	_INFO("client Id = [%u]", pid);
 
+	reply.count = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
 	int return_code = _check_priviliege_account_read(invocation);
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
@@ -1293,31 +1520,27 @@ account_manager_handle_account_query_account_by_user_name(AccountManager *obj,
 
 	//Mode checking not required, since default mode is read.
 
-	GList *account_list = NULL;
-
-	account_list = _account_query_account_by_user_name(pid, (uid_t)uid, user_name, &return_code);
+	return_code = _account_query_stream(scope, pid, (uid_t)uid, "user_name", user_name, 0, _account_list_add_cb, &reply);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_account_by_user_name error");
+		goto RETURN;
+	}
 
-	if (account_list == NULL) {
+	if (reply.count == 0) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 		_ERR("No account found.");
 		goto RETURN;
 	}
 
-	_INFO("account_list length= [%d]", g_list_length(account_list));
-
-	_INFO("before calling marshal_account_list_double");
-	account_list_variant = marshal_account_list_double(account_list);
-	_account_glist_account_free(account_list);
-	_INFO("after calling marshal_account_list_double");
+	_INFO("account_list length= [%d]", reply.count);
 
-	if (return_code != _ACCOUNT_ERROR_NONE) {
-		_ERR("_account_query_account_by_user_name error");
-		goto RETURN;
-	}
+	account_list_variant = g_variant_builder_end(&reply.builder);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_list_variant == NULL) {
+		g_variant_builder_clear(&reply.builder);
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), _ACCOUNT_ERROR_RECORD_NOT_FOUND, "RecordNotFound");
 		g_dbus_method_invocation_return_gerror(invocation, error);
 		g_error_free(error);
@@ -1337,6 +1560,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_account_by_user_name end");
 
@@ -1351,12 +1577,18 @@ account_manager_handle_account_query_account_by_package_name(AccountManager *obj
 {
 	_INFO("account_manager_handle_account_query_account_by_package_name start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_list_variant = NULL;
+	account_list_reply_s reply;
+	request_scope_s *scope = request_scope_new();
 	guint pid = _get_client_pid(invocation);
 
 	_INFO("client Id = [%u]", pid);
 
+	reply.count = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
 	int return_code = _check_priviliege_account_read(invocation);
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
@@ -1377,29 +1609,27 @@ account_manager_handle_account_query_account_by_package_name(AccountManager *obj
 
 	//Mode checking not required, since default mode is read.
 
-	GList *account_list = NULL;
-
-	account_list = account_server_query_account_by_package_name(package_name, &return_code, pid, (uid_t)uid);
+	return_code = _account_query_stream(scope, pid, (uid_t)uid, "package_name", package_name, 0, _account_list_add_cb, &reply);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_account_by_package_name error");
+		goto RETURN;
+	}
 
-	if (account_list == NULL) {
+	if (reply.count == 0) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 		_ERR("No account found.");
 		goto RETURN;
 	}
 
-	_INFO("account_list length= [%d]", g_list_length(account_list));
+	_INFO("account_list length= [%d]", reply.count);
 
-	account_list_variant = marshal_account_list_double(account_list);
-	_account_glist_account_free(account_list);
-
-	if (return_code != _ACCOUNT_ERROR_NONE) {
-		_ERR("_account_query_account_by_package_name error");
-		goto RETURN;
-	}
+	account_list_variant = g_variant_builder_end(&reply.builder);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_list_variant == NULL) {
+		g_variant_builder_clear(&reply.builder);
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
 		g_dbus_method_invocation_return_gerror(invocation, error);
 		g_error_free(error);
@@ -1420,6 +1650,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_account_by_package_name start");
 
@@ -1435,13 +1668,19 @@ account_manager_handle_account_query_account_by_capability(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_query_account_by_capability start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_list_variant = NULL;
+	account_list_reply_s reply;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 
 	_INFO("client Id = [%u]", pid);
 
+	reply.count = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
 	int return_code = _check_priviliege_account_read(invocation);
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
@@ -1462,31 +1701,27 @@ account_manager_handle_account_query_account_by_capability(AccountManager *obj,
 
 	//Mode checking not required, since default mode is read.
 
-	GList *account_list = NULL;
-
-	_INFO("before _account_query_account_by_capability");
-	account_list = _account_query_account_by_capability(pid, (uid_t)uid, capability_type, capability_value, &return_code);
-	_INFO("after _account_query_account_by_capability");
+	return_code = _account_query_stream(scope, pid, (uid_t)uid, "capability", capability_type, capability_value, _account_list_add_cb, &reply);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_account_by_capability error");
+		goto RETURN;
+	}
 
-	if (account_list == NULL) {
+	if (reply.count == 0) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 		_ERR("No account found.");
 		goto RETURN;
 	}
 
-	_INFO("account_list length= [%d]", g_list_length(account_list));
+	_INFO("account_list length= [%d]", reply.count);
 
-	account_list_variant = marshal_account_list_double(account_list);
-	_account_glist_account_free(account_list);
-
-	if (return_code != _ACCOUNT_ERROR_NONE) {
-		_ERR("_account_query_account_by_capability error");
-		goto RETURN;
-	}
+	account_list_variant = g_variant_builder_end(&reply.builder);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_list_variant == NULL) {
+		g_variant_builder_clear(&reply.builder);
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), _ACCOUNT_ERROR_RECORD_NOT_FOUND, "RecordNotFound");
 		g_dbus_method_invocation_return_gerror(invocation, error);
 		g_error_free(error);
@@ -1506,6 +1741,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_account_by_capability end");
 
@@ -1520,13 +1758,19 @@ account_manager_handle_account_query_account_by_capability_type(AccountManager *
 {
 	_INFO("account_manager_handle_account_query_account_by_capability_type start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* account_list_variant = NULL;
+	account_list_reply_s reply;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 
 	_INFO("client Id = [%u]", pid);
 
+	reply.count = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
 	int return_code = _check_priviliege_account_read(invocation);
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
@@ -1548,31 +1792,27 @@ account_manager_handle_account_query_account_by_capability_type(AccountManager *
 
 	//Mode checking not required, since default mode is read.
 
-	GList *account_list = NULL;
-
-	account_list = _account_query_account_by_capability_type(pid, (uid_t)uid, capability_type, &return_code);
+	return_code = _account_query_stream(scope, pid, (uid_t)uid, "capability_type", capability_type, 0, _account_list_add_cb, &reply);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_account_by_capability_type error");
+		goto RETURN;
+	}
 
-	if (account_list == NULL) {
+	if (reply.count == 0) {
 		return_code = _ACCOUNT_ERROR_RECORD_NOT_FOUND;
 		_ERR("No account found.");
 		goto RETURN;
 	}
 
-	_INFO("account_list length= [%d]", g_list_length(account_list));
-
-	_INFO("before calling marshal_account_list_double");
-	account_list_variant = marshal_account_list_double(account_list);
-	_account_glist_account_free(account_list);
-	_INFO("after calling marshal_account_list_double");
+	_INFO("account_list length= [%d]", reply.count);
 
-	if (return_code != _ACCOUNT_ERROR_NONE) {
-		_ERR("_account_query_account_by_capability_type error");
-		goto RETURN;
-	}
+	account_list_variant = g_variant_builder_end(&reply.builder);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (account_list_variant == NULL) {
+		g_variant_builder_clear(&reply.builder);
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), _ACCOUNT_ERROR_RECORD_NOT_FOUND, "RecordNotFound");
 		g_dbus_method_invocation_return_gerror(invocation, error);
 		g_error_free(error);
@@ -1592,6 +1832,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	request_scope_free(scope);
+
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_account_by_capability_type end");
 
@@ -1606,6 +1849,7 @@ account_manager_handle_account_query_capability_by_account_id(AccountManager *ob
 {
 	_INFO("account_manager_handle_account_query_capability_by_account_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GVariant* capability_list_variant = NULL;
 
@@ -1646,7 +1890,9 @@ account_manager_handle_account_query_capability_by_account_id(AccountManager *ob
 	_INFO("capability_list length= [%d]", g_slist_length(capability_list));
 
 	_INFO("before calling marshal_capability_list");
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
 	capability_list_variant = marshal_capability_list(capability_list);
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
 	_account_gslist_capability_free(capability_list);
 	_INFO("after calling marshal_capability_list");
 
@@ -1656,6 +1902,7 @@ account_manager_handle_account_query_capability_by_account_id(AccountManager *ob
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (capability_list_variant == NULL) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), _ACCOUNT_ERROR_RECORD_NOT_FOUND, "RecordNotFound");
@@ -1677,6 +1924,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_query_capability_by_account_id end");
 
@@ -1692,6 +1940,7 @@ account_manager_handle_account_update_sync_status_by_id(AccountManager *object,
 {
 	_INFO("account_manager_handle_account_update_sync_status_by_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	guint pid = _get_client_pid(invocation);
 
@@ -1731,6 +1980,7 @@ account_manager_handle_account_update_sync_status_by_id(AccountManager *object,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -1753,6 +2003,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_update_sync_status_by_id end");
 
@@ -1767,6 +2018,7 @@ account_manager_handle_account_type_query_provider_feature_by_app_id(AccountMana
 {
 	_INFO("account_manager_handle_account_type_query_provider_feature_by_app_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GSList* feature_record_list = NULL;
 	GVariant* feature_record_list_variant = NULL;
@@ -1812,6 +2064,7 @@ account_manager_handle_account_type_query_provider_feature_by_app_id(AccountMana
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -1834,6 +2087,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_provider_feature_by_app_id end");
 
@@ -1849,6 +2103,7 @@ account_manager_handle_account_type_query_supported_feature(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_query_supported_feature start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	int is_supported = 0;
 	guint pid = _get_client_pid(invocation);
@@ -1883,6 +2138,7 @@ account_manager_handle_account_type_query_supported_feature(AccountManager *obj,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -1905,6 +2161,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_supported_feature end");
 
@@ -1920,6 +2177,7 @@ account_manager_handle_account_type_update_to_db_by_app_id(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_update_to_db_by_app_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	account_type_s* account_type = NULL;
 
@@ -1963,6 +2221,7 @@ account_manager_handle_account_type_update_to_db_by_app_id(AccountManager *obj,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -1987,6 +2246,7 @@ RETURN:
 
 	_account_type_free_account_type_with_items(account_type);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_update_to_db_by_app_id end");
 
@@ -2001,6 +2261,7 @@ account_manager_handle_account_type_delete_by_app_id(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_delete_by_app_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	guint pid = _get_client_pid(invocation);
 
@@ -2040,6 +2301,7 @@ account_manager_handle_account_type_delete_by_app_id(AccountManager *obj,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -2062,6 +2324,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_delete_by_app_id end");
 
@@ -2076,6 +2339,7 @@ account_manager_handle_account_type_query_label_by_app_id(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_query_label_by_app_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	GSList* label_list = NULL;
 	GVariant* label_list_variant = NULL;
@@ -2115,6 +2379,7 @@ account_manager_handle_account_type_query_label_by_app_id(AccountManager *obj,
 	_account_type_gslist_label_free(label_list);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
@@ -2137,6 +2402,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_label_by_app_id end");
 
@@ -2151,9 +2417,11 @@ account_manager_handle_account_type_query_by_app_id(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_query_by_app_id start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	account_type_s* account_type = NULL;
 	GVariant* account_type_variant = NULL;
+	request_scope_s *scope = request_scope_new();
 
 	guint pid = _get_client_pid(invocation);
 
@@ -2178,7 +2446,7 @@ account_manager_handle_account_type_query_by_app_id(AccountManager *obj,
 	}
 
 	_INFO("before _account_type_query_by_app_id");
-	return_code = _account_type_query_by_app_id(app_id, &account_type);
+	return_code = _account_type_query_by_app_id(scope, app_id, &account_type);
 	_INFO("after _account_type_query_by_app_id=[%d]", return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
@@ -2192,9 +2460,12 @@ account_manager_handle_account_type_query_by_app_id(AccountManager *obj,
 		goto RETURN;
 	}
 
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
 	account_type_variant = marshal_account_type(account_type);
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -2218,8 +2489,9 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
-	_account_type_free_account_type_with_items(account_type);
+	request_scope_free(scope);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_by_app_id end");
 	return true;
@@ -2233,6 +2505,7 @@ account_manager_handle_account_type_query_app_id_exist(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_type_query_app_id_exist start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	guint pid = _get_client_pid(invocation);
 
@@ -2266,6 +2539,7 @@ account_manager_handle_account_type_query_app_id_exist(AccountManager *obj,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -2289,6 +2563,7 @@ RETURN:
 		return_code = _ACCOUNT_ERROR_NONE;
 	}
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("account_manager_handle_account_type_query_app_id_exist end");
 
@@ -2304,6 +2579,7 @@ account_manager_handle_account_update_to_db_by_id_ex(AccountManager *obj,
 {
 	_INFO("account_manager_handle_account_update_to_db_by_id_ex start");
 	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
 
 	account_s* account = NULL;
 	guint pid = _get_client_pid(invocation);
@@ -2351,6 +2627,7 @@ account_manager_handle_account_update_to_db_by_id_ex(AccountManager *obj,
 	}
 
 RETURN:
+	method_stats_call_result(return_code);
 
 	if (return_code != _ACCOUNT_ERROR_NONE) {
 		_ERR("Account SVC is returning error [%d]", return_code);
@@ -2376,11 +2653,410 @@ RETURN:
 
 	_account_free_account_with_items(account);
 
+	method_stats_call_end();
 	lifecycle_method_call_inactive();
 	_INFO("in account_manager_handle_account_update_to_db_by_id_ex_p end");
 	return true;
 }
 
+static void
+account_manager_handle_account_add_batch(GDBusMethodInvocation *invocation, GVariant *parameters)
+{
+	_INFO("account_manager_handle_account_add_batch start");
+	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
+
+	GVariant *account_data_list = NULL;
+	GVariant *account_data = NULL;
+	GVariantIter iter;
+	GVariantBuilder builder;
+	GSList *account_list = NULL;
+	int *db_ids = NULL;
+	gint uid = 0;
+	int count = 0;
+	int i = 0;
+
+	guint pid = _get_client_pid(invocation);
+	_INFO("client Id = [%u]", pid);
+
+	g_variant_get(parameters, "(@aa{sv}i)", &account_data_list, &uid);
+
+	int return_code = _check_priviliege_account_read(invocation);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _check_priviliege_account_write(invocation);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_check_priviliege_account_write failed, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	count = g_variant_n_children(account_data_list);
+	if (count <= 0 || count > ACCOUNT_ADD_BATCH_MAX) {
+		_ERR("invalid batch size [%d]", count);
+		return_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+		goto RETURN;
+	}
+
+	g_variant_iter_init(&iter, account_data_list);
+	while ((account_data = g_variant_iter_next_value(&iter)) != NULL) {
+		account_s *account = umarshal_account(account_data);
+		g_variant_unref(account_data);
+		if (account == NULL) {
+			_ERR("account unmarshalling failed");
+			return_code = _ACCOUNT_ERROR_INVALID_PARAMETER;
+			goto RETURN;
+		}
+		account_list = g_slist_prepend(account_list, account);
+	}
+	account_list = g_slist_reverse(account_list);
+
+	db_ids = (int *)calloc(count, sizeof(int));
+	if (db_ids == NULL) {
+		_ERR("Memory Allocation Failed");
+		return_code = _ACCOUNT_ERROR_OUT_OF_MEMORY;
+		goto RETURN;
+	}
+
+	return_code = _account_db_open(1, pid, uid);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_global_db_open();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_global_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_insert_list_to_db(account_list, pid, (int)uid, db_ids);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_insert_list_to_db() error");
+		goto RETURN;
+	}
+
+RETURN:
+	method_stats_call_result(return_code);
+
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("Account SVC is returning error [%d]", return_code);
+		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
+		g_dbus_method_invocation_return_gerror(invocation, error);
+		g_error_free(error);
+	} else {
+		g_variant_builder_init(&builder, G_VARIANT_TYPE("ai"));
+		for (i = 0; i < count; i++)
+			g_variant_builder_add(&builder, "i", db_ids[i]);
+		g_dbus_method_invocation_return_value(invocation, g_variant_new("(ai)", &builder));
+	}
+
+	return_code = _account_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	return_code = _account_global_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_global_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	_account_gslist_account_free(account_list);
+	_ACCOUNT_FREE(db_ids);
+	g_variant_unref(account_data_list);
+
+	method_stats_call_end();
+	lifecycle_method_call_inactive();
+	_INFO("account_manager_handle_account_add_batch end");
+}
+
+typedef struct _account_page_reply_s {
+	GVariantBuilder builder;
+	gsize size;
+} account_page_reply_s;
+
+static bool _account_page_add_cb(account_s *account, void *user_data)
+{
+	account_page_reply_s *reply = (account_page_reply_s *)user_data;
+	GVariant *account_variant = NULL;
+
+	method_stats_phase_begin(METHOD_STATS_PHASE_MARSHAL);
+	account_variant = marshal_account(account);
+	method_stats_phase_end(METHOD_STATS_PHASE_MARSHAL);
+
+	/* the account that crosses the budget is still taken, so every page moves the cursor */
+	reply->size += g_variant_get_size(account_variant);
+	g_variant_builder_add_value(&reply->builder, account_variant);
+
+	return reply->size < ACCOUNT_QUERY_PAGE_BYTES;
+}
+
+/* query_all and query_account_by_* one page at a time, keyed on _id */
+static void
+account_manager_handle_account_query_page(GDBusMethodInvocation *invocation, GVariant *parameters)
+{
+	_INFO("account_manager_handle_account_query_page start");
+	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
+
+	account_page_reply_s reply;
+	request_scope_s *scope = request_scope_new();
+	const gchar *filter = NULL;
+	const gchar *text = NULL;
+	gint value = 0;
+	gint after_id = 0;
+	gint limit = 0;
+	gint uid = 0;
+	int next_cursor = 0;
+
+	guint pid = _get_client_pid(invocation);
+	_INFO("client Id = [%u]", pid);
+
+	g_variant_get(parameters, "(&s&siiii)", &filter, &text, &value, &after_id, &limit, &uid);
+
+	reply.size = 0;
+	g_variant_builder_init(&reply.builder, G_VARIANT_TYPE("aa{sv}"));
+
+	int return_code = _check_priviliege_account_read(invocation);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_db_open(0, pid, uid);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_global_db_open();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_global_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_query_page(scope, pid, (uid_t)uid, filter, text, value, after_id, limit,
+			_account_page_add_cb, &reply, &next_cursor);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_query_page() error [%d], filter [%s]", return_code, filter);
+		goto RETURN;
+	}
+
+	_INFO("page after [%d] is [%zu] bytes, next cursor [%d]", after_id, reply.size, next_cursor);
+
+RETURN:
+	method_stats_call_result(return_code);
+
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("Account SVC is returning error [%d]", return_code);
+		g_variant_builder_clear(&reply.builder);
+		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
+		g_dbus_method_invocation_return_gerror(invocation, error);
+		g_error_free(error);
+	} else {
+		g_dbus_method_invocation_return_value(invocation, g_variant_new("(aa{sv}i)", &reply.builder, next_cursor));
+	}
+
+	return_code = _account_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	return_code = _account_global_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_global_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	request_scope_free(scope);
+
+	method_stats_call_end();
+	lifecycle_method_call_inactive();
+	_INFO("account_manager_handle_account_query_page end");
+}
+
+/* sets only the fields in field_mask, an access token refresh no longer ships the whole account */
+static void
+account_manager_handle_account_patch(GDBusMethodInvocation *invocation, GVariant *parameters)
+{
+	_INFO("account_manager_handle_account_patch start");
+	lifecycle_method_call_active();
+	method_stats_call_begin(invocation);
+
+	GVariant *values = NULL;
+	gint account_db_id = 0;
+	guint field_mask = 0;
+	gint uid = 0;
+
+	guint pid = _get_client_pid(invocation);
+	_INFO("client Id = [%u]", pid);
+
+	g_variant_get(parameters, "(iu@a{sv}i)", &account_db_id, &field_mask, &values, &uid);
+
+	int return_code = _check_priviliege_account_read(invocation);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_check_priviliege_account_read failed, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _check_priviliege_account_write(invocation);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_check_priviliege_account_write failed, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_db_open(1, pid, uid);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_global_db_open();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_global_db_open() error, ret = %d", return_code);
+		goto RETURN;
+	}
+
+	return_code = _account_patch_by_id(pid, (uid_t)uid, account_db_id, field_mask, values);
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("_account_patch_by_id() error [%d], field_mask [%x]", return_code, field_mask);
+		goto RETURN;
+	}
+
+RETURN:
+	method_stats_call_result(return_code);
+
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		_ERR("Account SVC is returning error [%d]", return_code);
+		GError* error = g_error_new(__ACCOUNT_ERROR_quark(), return_code, "RecordNotFound");
+		g_dbus_method_invocation_return_gerror(invocation, error);
+		g_error_free(error);
+	} else {
+		g_dbus_method_invocation_return_value(invocation, NULL);
+	}
+
+	return_code = _account_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	return_code = _account_global_db_close();
+	if (return_code != _ACCOUNT_ERROR_NONE) {
+		ACCOUNT_DEBUG("_account_global_db_close() fail[%d]", return_code);
+		return_code = _ACCOUNT_ERROR_NONE;
+	}
+
+	g_variant_unref(values);
+
+	method_stats_call_end();
+	lifecycle_method_call_inactive();
+	_INFO("account_manager_handle_account_patch end");
+}
+
+static void
+account_mgr_ext_method_thread(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+	GDBusMethodInvocation *invocation = (GDBusMethodInvocation *)task_data;
+	const gchar *method_name = g_dbus_method_invocation_get_method_name(invocation);
+	GVariant *parameters = g_dbus_method_invocation_get_parameters(invocation);
+
+	if (g_strcmp0(method_name, "account_add_batch") == 0)
+		account_manager_handle_account_add_batch(invocation, parameters);
+	else if (g_strcmp0(method_name, "account_query_page") == 0)
+		account_manager_handle_account_query_page(invocation, parameters);
+	else if (g_strcmp0(method_name, "account_patch") == 0)
+		account_manager_handle_account_patch(invocation, parameters);
+	else
+		g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+				"Unknown method [%s]", method_name);
+
+	lifecycle_method_call_inactive();
+	g_task_return_boolean(task, TRUE);
+}
+
+static void
+account_mgr_ext_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path,
+		const gchar *interface_name, const gchar *method_name, GVariant *parameters,
+		GDBusMethodInvocation *invocation, gpointer user_data)
+{
+	GTask *task = NULL;
+
+	/* counted from here, the shutdown also waits for a call still queued for a worker */
+	lifecycle_method_call_active();
+
+	/* same worker pool the skeleton dispatches to, the invocation is consumed by the reply */
+	task = g_task_new(NULL, NULL, NULL, NULL);
+	g_task_set_task_data(task, invocation, NULL);
+	g_task_run_in_thread(task, account_mgr_ext_method_thread);
+	g_object_unref(task);
+}
+
+static const GDBusInterfaceVTable account_mgr_ext_vtable = {
+	account_mgr_ext_method_call,
+	NULL,
+	NULL
+};
+
+/* an extra interface next to the generated one on ACCOUNT_MGR_DBUS_PATH, *node is kept for the vtable's lifetime */
+static bool _register_interface(GDBusConnection *connection, const gchar *introspection_xml,
+		const GDBusInterfaceVTable *vtable, GDBusNodeInfo **node, guint *registration_id)
+{
+	GError *error = NULL;
+
+	*node = g_dbus_node_info_new_for_xml(introspection_xml, &error);
+	if (*node == NULL) {
+		_ERR("introspection parse failed [%s]", error ? error->message : "");
+		g_clear_error(&error);
+		return false;
+	}
+
+	*registration_id = g_dbus_connection_register_object(connection,
+			ACCOUNT_MGR_DBUS_PATH,
+			(*node)->interfaces[0],
+			vtable,
+			NULL,
+			NULL,
+			&error);
+	if (*registration_id == 0) {
+		_ERR("register %s failed [%s]", (*node)->interfaces[0]->name, error ? error->message : "");
+		g_clear_error(&error);
+		g_dbus_node_info_unref(*node);
+		*node = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/* only a snapshot under the stats lock, answered on the main loop without going through lifecycle */
+static void
+account_mgr_stats_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path,
+		const gchar *interface_name, const gchar *method_name, GVariant *parameters,
+		GDBusMethodInvocation *invocation, gpointer user_data)
+{
+	if (g_strcmp0(method_name, "get_method_stats") == 0) {
+		g_dbus_method_invocation_return_value(invocation, method_stats_to_variant());
+	} else if (g_strcmp0(method_name, "reset_method_stats") == 0) {
+		method_stats_reset();
+		g_dbus_method_invocation_return_value(invocation, NULL);
+	} else {
+		g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+				"Unknown method [%s]", method_name);
+	}
+}
+
+static const GDBusInterfaceVTable account_mgr_stats_vtable = {
+	account_mgr_stats_method_call,
+	NULL,
+	NULL
+};
+
 static void
 on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data)
 {
@@ -2394,11 +3070,25 @@ on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_da
 		}
 
 		interface = G_DBUS_INTERFACE_SKELETON(account_mgr_server_obj);
+		/* handlers run on gio's worker pool, a slow query no longer holds up the main loop */
+		g_dbus_interface_skeleton_set_flags(interface, G_DBUS_INTERFACE_SKELETON_FLAGS_HANDLE_METHOD_INVOCATIONS_IN_THREAD);
 		if (!g_dbus_interface_skeleton_export(interface, connection, ACCOUNT_MGR_DBUS_PATH, NULL)) {
 			_ERR("export failed!!");
 			return;
 		}
 
+		client_cache_init(connection);
+
+		if (!_register_interface(connection, account_mgr_ext_introspection_xml, &account_mgr_ext_vtable,
+				&account_mgr_ext_node, &account_mgr_ext_registration_id))
+			_ERR("%s is not available", ACCOUNT_MGR_EXT_DBUS_INTERFACE);
+
+		if (!_register_interface(connection, account_mgr_stats_introspection_xml, &account_mgr_stats_vtable,
+				&account_mgr_stats_node, &account_mgr_stats_registration_id))
+			_ERR("%s is not available", ACCOUNT_MGR_STATS_DBUS_INTERFACE);
+
+		change_noti_init(connection, ACCOUNT_MGR_DBUS_PATH, ACCOUNT_MGR_EXT_DBUS_INTERFACE);
+
 		_INFO("connecting account signals start");
 
 		g_signal_connect(account_mgr_server_obj, "handle_account_add",
@@ -2495,10 +3185,66 @@ void terminate_main_loop()
 		_ERR("account manager's g_mainloop is NULL");
 }
 
+static void _account_mgr_server_obj_finalized(gpointer data, GObject *where_the_object_was)
+{
+	*(bool *)data = true;
+}
+
+static gboolean _account_mgr_drain_timeout_cb(gpointer data)
+{
+	*(bool *)data = true;
+
+	return G_SOURCE_REMOVE;
+}
+
+/*
+ * Left the main loop, so no call is dispatched to the worker pool any more. Whatever is still queued
+ * or running there uses the db pool and the caches, which are only torn down once it is done.
+ */
+static void _finalize_dbus(void)
+{
+	GDBusConnection *connection = NULL;
+	bool finalized = false;
+	bool timed_out = false;
+	guint timeout_id = 0;
+
+	if (account_mgr_server_obj) {
+		connection = g_dbus_interface_skeleton_get_connection(G_DBUS_INTERFACE_SKELETON(account_mgr_server_obj));
+		if (connection && account_mgr_ext_registration_id)
+			g_dbus_connection_unregister_object(connection, account_mgr_ext_registration_id);
+		if (connection && account_mgr_stats_registration_id)
+			g_dbus_connection_unregister_object(connection, account_mgr_stats_registration_id);
+		account_mgr_ext_registration_id = 0;
+		account_mgr_stats_registration_id = 0;
+
+		g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(account_mgr_server_obj));
+
+		/*
+		 * A call handed to a worker holds the skeleton until its task completes on this context,
+		 * so it is gone once every call the skeleton dispatched is.
+		 */
+		g_object_weak_ref(G_OBJECT(account_mgr_server_obj), _account_mgr_server_obj_finalized, &finalized);
+		g_object_unref(account_mgr_server_obj);
+		account_mgr_server_obj = NULL;
+
+		timeout_id = g_timeout_add_seconds(ACCOUNT_DRAIN_TIMEOUT, _account_mgr_drain_timeout_cb, &timed_out);
+		while (!finalized && !timed_out)
+			g_main_context_iteration(NULL, TRUE);
+		if (!timed_out)
+			g_source_remove(timeout_id);
+		else
+			_ERR("skeleton still referenced after [%d] sec", ACCOUNT_DRAIN_TIMEOUT);
+	}
+
+	/* calls of the extra interface are counted from their dispatch, the skeleton's ones are done by now */
+	lifecycle_wait_method_calls_done();
+}
+
 static void
 on_name_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data)
 {
 		_INFO("on_name_acquired");
+		lifecycle_name_acquired();
 }
 
 static void
@@ -2535,8 +3281,32 @@ static bool _initialize_dbus()
 
 static void _terminate_server_by_timeout()
 {
-	lifecycle_method_call_active();
-	lifecycle_method_call_inactive();
+	lifecycle_init();
+}
+
+/*
+ * Runs next to the main loop, which meanwhile connects to the bus and takes the name.
+ * Everything done here is also set up on demand, the first call just may wait less.
+ */
+static gpointer _startup_thread_func(gpointer data)
+{
+	gint64 begin = g_get_monotonic_time();
+
+	/* the first privilege check would otherwise pay for the connection to cynara */
+	pthread_mutex_lock(&cynara_mutex);
+	__initialize_cynara();
+	pthread_mutex_unlock(&cynara_mutex);
+
+	/* nothing is pushed as thread default, so package events still come in on the main loop */
+	app_group_cache_init();
+
+	/* before the prewarm, which then builds the global catalog from the snapshot */
+	_account_type_catalog_snapshot_load();
+	_account_db_pool_prewarm();
+
+	_INFO("startup thread done in [%lld] msec", (long long)((g_get_monotonic_time() - begin) / 1000));
+
+	return NULL;
 }
 
 static void _initialize()
@@ -2544,7 +3314,11 @@ static void _initialize()
 #if !GLIB_CHECK_VERSION(2, 35, 0)
 	g_type_init();
 #endif
-	int ret = -1;
+	GError *error = NULL;
+
+	/* start of the cold start latency */
+	_terminate_server_by_timeout();
+	method_stats_init();
 
 	if (_initialize_dbus() == false) {
 		/* because dbus's initialize failed, we cannot continue any more. */
@@ -2552,17 +3326,23 @@ static void _initialize()
 		exit(1);
 	}
 
-	ret = cynara_initialize(&p_cynara, NULL);
-	if (ret != CYNARA_API_SUCCESS) {
-		_ERR("CYNARA Initialization fail");
-		exit(1);
+	startup_thread = g_thread_try_new("account-startup", _startup_thread_func, NULL, &error);
+	if (startup_thread == NULL) {
+		/* cynara and the global db are still set up by the first call that needs them */
+		_ERR("g_thread_try_new failed (%s)", error ? error->message : "");
+		g_clear_error(&error);
+		app_group_cache_init();
 	}
-
-	_terminate_server_by_timeout();
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+	/* packaging/account-manager.spec runs these, the schema first and the index from the result */
+	if (argc > 1 && g_strcmp0(argv[1], "--migrate-global-db") == 0)
+		return _account_global_db_migrate() == _ACCOUNT_ERROR_NONE ? 0 : 1;
+	if (argc > 1 && g_strcmp0(argv[1], "--build-catalog-index") == 0)
+		return _account_type_catalog_index_build() == _ACCOUNT_ERROR_NONE ? 0 : 1;
+
 	_INFO("Starting Accounts SVC");
 
 	mainloop = g_main_loop_new(NULL, FALSE);
@@ -2577,7 +3357,24 @@ int main()
 
 	_INFO("g_main_loop_run");
 
-	cynara_finish(p_cynara);
+	if (startup_thread)
+		g_thread_join(startup_thread);
+	lifecycle_finish();
+	_finalize_dbus();
+	method_stats_finish();
+	change_noti_finish();
+	client_cache_finish();
+	appid_cache_finish();
+	app_group_cache_finish();
+	if (account_mgr_ext_node)
+		g_dbus_node_info_unref(account_mgr_ext_node);
+	if (account_mgr_stats_node)
+		g_dbus_node_info_unref(account_mgr_stats_node);
+	_account_db_pool_destroy();
+	_account_type_catalog_snapshot_save();
+	type_cache_finish();
+	if (p_cynara)
+		cynara_finish(p_cynara);
 
 	_INFO("Ending Accounts SVC");
 
@@ -0,0 +1,204 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <glib.h>
+#include <package-manager.h>
+#include <dlog.h>
+#include <dbg.h>
+
+#include "app-group-cache.h"
+#include "type-cache.h"
+
+/* each map is dropped as a whole when it grows past this */
+#define APP_GROUP_CACHE_MAX_ENTRIES 256
+
+static GHashTable *app_group_cache_groups = NULL;	/* "uid\nappid\npackage_name" set */
+static GHashTable *app_group_cache_represented = NULL;	/* "uid\nappid" -> verified appid */
+static pkgmgr_client *app_group_cache_listener = NULL;
+static unsigned int app_group_cache_generation = 0;
+static pthread_mutex_t app_group_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void app_group_cache_clear(GHashTable **table)
+{
+	if (*table) {
+		g_hash_table_destroy(*table);
+		*table = NULL;
+	}
+}
+
+static int app_group_cache_pkgmgr_cb(uid_t target_uid, int req_id, const char *pkg_type, const char *pkgid,
+		const char *key, const char *val, const void *pmsg, void *data)
+{
+	/* the app list of the package and its account types may both change in between */
+	if (g_strcmp0(key, "start") != 0 && g_strcmp0(key, "end") != 0)
+		return 0;
+
+	_INFO("package [%s] %s [%s], app group cache dropped", pkgid, key, val);
+
+	pthread_mutex_lock(&app_group_cache_mutex);
+	app_group_cache_clear(&app_group_cache_groups);
+	app_group_cache_clear(&app_group_cache_represented);
+	app_group_cache_generation++;
+	pthread_mutex_unlock(&app_group_cache_mutex);
+
+	/* the installer writes the account types of the package to the global db */
+	type_cache_invalidate_global();
+
+	return 0;
+}
+
+void app_group_cache_init(void)
+{
+	int ret = PKGMGR_R_OK;
+	pkgmgr_client *listener = NULL;
+
+	if (g_atomic_pointer_get(&app_group_cache_listener) != NULL)
+		return;
+
+	listener = pkgmgr_client_new(PC_LISTENING);
+	if (listener == NULL) {
+		_ERR("pkgmgr_client_new failed, app group cache disabled");
+		return;
+	}
+
+	pkgmgr_client_set_status_type(listener,
+			PKGMGR_CLIENT_STATUS_INSTALL | PKGMGR_CLIENT_STATUS_UNINSTALL | PKGMGR_CLIENT_STATUS_UPGRADE);
+
+	ret = pkgmgr_client_listen_status(listener, app_group_cache_pkgmgr_cb, NULL);
+	if (ret < 0) {
+		_ERR("pkgmgr_client_listen_status failed [%d], app group cache disabled", ret);
+		pkgmgr_client_free(listener);
+		return;
+	}
+
+	/* set up off the main thread while calls come in, lookups only see a listening client */
+	g_atomic_pointer_set(&app_group_cache_listener, listener);
+
+	_INFO("app group cache listening to package events");
+}
+
+void app_group_cache_finish(void)
+{
+	pkgmgr_client *listener = NULL;
+
+	/* cleared under the lock first, a store racing with this then finds no listener and keeps nothing */
+	pthread_mutex_lock(&app_group_cache_mutex);
+	listener = (pkgmgr_client *)g_atomic_pointer_get(&app_group_cache_listener);
+	g_atomic_pointer_set(&app_group_cache_listener, NULL);
+	app_group_cache_clear(&app_group_cache_groups);
+	app_group_cache_clear(&app_group_cache_represented);
+	pthread_mutex_unlock(&app_group_cache_mutex);
+
+	if (listener)
+		pkgmgr_client_free(listener);
+}
+
+bool app_group_cache_lookup_group(const char *appid, const char *package_name, uid_t uid, unsigned int *generation)
+{
+	char *key = NULL;
+	bool found = false;
+
+	/* without the listener an uninstalled package would keep its grant */
+	if (appid == NULL || package_name == NULL || g_atomic_pointer_get(&app_group_cache_listener) == NULL)
+		return false;
+
+	key = g_strdup_printf("%d\n%s\n%s", uid, appid, package_name);
+
+	pthread_mutex_lock(&app_group_cache_mutex);
+	*generation = app_group_cache_generation;
+	if (app_group_cache_groups)
+		found = g_hash_table_contains(app_group_cache_groups, key);
+	pthread_mutex_unlock(&app_group_cache_mutex);
+
+	g_free(key);
+
+	return found;
+}
+
+void app_group_cache_store_group(const char *appid, const char *package_name, uid_t uid, unsigned int generation)
+{
+	if (appid == NULL || package_name == NULL || g_atomic_pointer_get(&app_group_cache_listener) == NULL)
+		return;
+
+	pthread_mutex_lock(&app_group_cache_mutex);
+	if (generation != app_group_cache_generation) {
+		pthread_mutex_unlock(&app_group_cache_mutex);
+		return;
+	}
+	if (app_group_cache_groups && g_hash_table_size(app_group_cache_groups) >= APP_GROUP_CACHE_MAX_ENTRIES)
+		app_group_cache_clear(&app_group_cache_groups);
+	if (app_group_cache_groups == NULL)
+		app_group_cache_groups = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	g_hash_table_add(app_group_cache_groups, g_strdup_printf("%d\n%s\n%s", uid, appid, package_name));
+	pthread_mutex_unlock(&app_group_cache_mutex);
+}
+
+char *app_group_cache_lookup_represented(const char *appid, uid_t uid, unsigned int *generation)
+{
+	char *key = NULL;
+	char *verified_appid = NULL;
+	const char *cached = NULL;
+
+	if (appid == NULL || g_atomic_pointer_get(&app_group_cache_listener) == NULL)
+		return NULL;
+
+	key = g_strdup_printf("%d\n%s", uid, appid);
+
+	pthread_mutex_lock(&app_group_cache_mutex);
+	*generation = app_group_cache_generation;
+	if (app_group_cache_represented)
+		cached = (const char *)g_hash_table_lookup(app_group_cache_represented, key);
+	if (cached)
+		verified_appid = strdup(cached);
+	pthread_mutex_unlock(&app_group_cache_mutex);
+
+	g_free(key);
+
+	return verified_appid;
+}
+
+void app_group_cache_store_represented(const char *appid, uid_t uid, const char *verified_appid, unsigned int generation)
+{
+	if (appid == NULL || verified_appid == NULL || g_atomic_pointer_get(&app_group_cache_listener) == NULL)
+		return;
+
+	pthread_mutex_lock(&app_group_cache_mutex);
+	if (generation != app_group_cache_generation) {
+		pthread_mutex_unlock(&app_group_cache_mutex);
+		return;
+	}
+	if (app_group_cache_represented && g_hash_table_size(app_group_cache_represented) >= APP_GROUP_CACHE_MAX_ENTRIES)
+		app_group_cache_clear(&app_group_cache_represented);
+	if (app_group_cache_represented == NULL)
+		app_group_cache_represented = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+	g_hash_table_insert(app_group_cache_represented, g_strdup_printf("%d\n%s", uid, appid), g_strdup(verified_appid));
+	pthread_mutex_unlock(&app_group_cache_mutex);
+}
+
+void app_group_cache_invalidate_represented(void)
+{
+	pthread_mutex_lock(&app_group_cache_mutex);
+	app_group_cache_clear(&app_group_cache_represented);
+	app_group_cache_generation++;
+	pthread_mutex_unlock(&app_group_cache_mutex);
+}
@@ -0,0 +1,148 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <glib.h>
+#include <dlog.h>
+#include <dbg.h>
+
+#include "appid-cache.h"
+
+/* processes that died without leaving the bus are only dropped when the cache is full */
+#define APPID_CACHE_MAX_ENTRIES 128
+
+typedef struct _appid_cache_entry_s {
+	unsigned long long start_time;
+	uid_t uid;
+	char *appid;
+} appid_cache_entry_s;
+
+static GHashTable *appid_cache = NULL;	/* pid -> appid_cache_entry_s */
+static pthread_mutex_t appid_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void appid_cache_entry_free(gpointer data)
+{
+	appid_cache_entry_s *entry = (appid_cache_entry_s *)data;
+
+	if (entry == NULL)
+		return;
+
+	g_free(entry->appid);
+	g_free(entry);
+}
+
+/* field 22 of /proc/<pid>/stat, in clock ticks since boot, 0 if the process is gone */
+static unsigned long long appid_cache_get_start_time(int pid)
+{
+	char path[64] = {0, };
+	char buf[512] = {0, };
+	char *fields = NULL;
+	unsigned long long start_time = 0;
+	int fd = -1;
+	int len = 0;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 0;
+
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return 0;
+	buf[len] = '\0';
+
+	/* the command name may hold spaces and parentheses, the fields start after the last ')' */
+	fields = strrchr(buf, ')');
+	if (fields == NULL)
+		return 0;
+
+	if (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &start_time) != 1)
+		return 0;
+
+	return start_time;
+}
+
+char *appid_cache_lookup(int pid, uid_t uid, unsigned long long *start_time)
+{
+	appid_cache_entry_s *entry = NULL;
+	char *appid = NULL;
+
+	*start_time = appid_cache_get_start_time(pid);
+	if (*start_time == 0)
+		return NULL;
+
+	pthread_mutex_lock(&appid_cache_mutex);
+	if (appid_cache)
+		entry = (appid_cache_entry_s *)g_hash_table_lookup(appid_cache, GINT_TO_POINTER(pid));
+	if (entry && entry->start_time == *start_time && entry->uid == uid)
+		appid = strdup(entry->appid);
+	pthread_mutex_unlock(&appid_cache_mutex);
+
+	return appid;
+}
+
+void appid_cache_store(int pid, uid_t uid, unsigned long long start_time, const char *appid)
+{
+	appid_cache_entry_s *entry = NULL;
+
+	/* without the start time a later process with the same pid could pick the entry up */
+	if (start_time == 0 || appid == NULL)
+		return;
+
+	entry = g_new0(appid_cache_entry_s, 1);
+	entry->start_time = start_time;
+	entry->uid = uid;
+	entry->appid = g_strdup(appid);
+
+	pthread_mutex_lock(&appid_cache_mutex);
+	if (appid_cache == NULL)
+		appid_cache = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, appid_cache_entry_free);
+
+	if (g_hash_table_size(appid_cache) >= APPID_CACHE_MAX_ENTRIES) {
+		_INFO("appid cache is full, dropping [%d] entries", g_hash_table_size(appid_cache));
+		g_hash_table_remove_all(appid_cache);
+	}
+
+	g_hash_table_insert(appid_cache, GINT_TO_POINTER(pid), entry);
+	pthread_mutex_unlock(&appid_cache_mutex);
+}
+
+void appid_cache_remove_pid(int pid)
+{
+	pthread_mutex_lock(&appid_cache_mutex);
+	if (appid_cache && g_hash_table_remove(appid_cache, GINT_TO_POINTER(pid)))
+		_INFO("pid [%d] left, cached appid dropped", pid);
+	pthread_mutex_unlock(&appid_cache_mutex);
+}
+
+void appid_cache_finish(void)
+{
+	pthread_mutex_lock(&appid_cache_mutex);
+	if (appid_cache) {
+		g_hash_table_destroy(appid_cache);
+		appid_cache = NULL;
+	}
+	pthread_mutex_unlock(&appid_cache_mutex);
+}
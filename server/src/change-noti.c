@@ -0,0 +1,220 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <vconf.h>
+#include <dlog.h>
+#include <dbg.h>
+#include <account-private.h>
+
+#include "change-noti.h"
+
+/* changes arriving within this window go out in one signal */
+#define CHANGE_NOTI_DELAY_MS 50
+/* a window holding this many changes is sent right away */
+#define CHANGE_NOTI_MAX_CHANGES 256
+
+typedef struct _change_noti_s {
+	char *op;
+	int account_id;
+	char *package_name;
+} change_noti_s;
+
+static GDBusConnection *change_noti_connection = NULL;
+static char *change_noti_object_path = NULL;
+static char *change_noti_interface = NULL;
+static GSList *change_noti_pending = NULL;	/* newest first */
+static GHashTable *change_noti_keys = NULL;	/* "op:id" of the pending changes */
+static guint change_noti_count = 0;
+static guint change_noti_source_id = 0;
+static pthread_mutex_t change_noti_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void change_noti_free(gpointer data)
+{
+	change_noti_s *change = (change_noti_s *)data;
+
+	g_free(change->op);
+	g_free(change->package_name);
+	g_free(change);
+}
+
+/* called with change_noti_mutex held */
+static void change_noti_emit_locked(void)
+{
+	GVariantBuilder builder;
+	GError *error = NULL;
+	GSList *changes = NULL;
+	GSList *iter = NULL;
+	change_noti_s *change = NULL;
+
+	if (change_noti_pending == NULL)
+		return;
+
+	changes = g_slist_reverse(change_noti_pending);
+	change_noti_pending = NULL;
+	change_noti_count = 0;
+	if (change_noti_keys)
+		g_hash_table_remove_all(change_noti_keys);
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a(sis)"));
+	for (iter = changes; iter != NULL; iter = g_slist_next(iter)) {
+		change = (change_noti_s *)iter->data;
+		g_variant_builder_add(&builder, "(sis)", change->op, change->account_id, change->package_name ? change->package_name : "");
+	}
+
+	if (change_noti_connection) {
+		/* sent with the lock held so that windows reach the bus in order */
+		if (!g_dbus_connection_emit_signal(change_noti_connection, NULL, change_noti_object_path,
+					change_noti_interface, CHANGE_NOTI_SIGNAL, g_variant_new("(a(sis))", &builder), &error)) {
+			_ERR("emit %s failed [%s]", CHANGE_NOTI_SIGNAL, error ? error->message : "");
+			g_clear_error(&error);
+		}
+	} else {
+		g_variant_builder_clear(&builder);
+	}
+	_INFO("[%d] account changes sent", g_slist_length(changes));
+
+#ifdef ACCOUNT_VCONF_NOTI
+	/* legacy listeners parse a single "op:id", so each distinct change of the window is written in order */
+	char buf[64] = {0,};
+	for (iter = changes; iter != NULL; iter = g_slist_next(iter)) {
+		change = (change_noti_s *)iter->data;
+		snprintf(buf, sizeof(buf), "%s:%d", change->op, change->account_id);
+		if (vconf_set_str(VCONFKEY_ACCOUNT_MSG_STR, buf) != 0)
+			_ERR("Vconf MSG Str set FAILED !!!!!!\n");
+	}
+#endif
+
+	g_slist_free_full(changes, change_noti_free);
+}
+
+static gboolean change_noti_timeout_cb(gpointer user_data)
+{
+	pthread_mutex_lock(&change_noti_mutex);
+	/* a flush may already have replaced this window with a new one */
+	if (change_noti_source_id == g_source_get_id(g_main_current_source()))
+		change_noti_source_id = 0;
+	change_noti_emit_locked();
+	pthread_mutex_unlock(&change_noti_mutex);
+
+	return FALSE;
+}
+
+void change_noti_init(GDBusConnection *connection, const char *object_path, const char *interface_name)
+{
+	pthread_mutex_lock(&change_noti_mutex);
+	if (change_noti_connection == NULL) {
+		change_noti_connection = g_object_ref(connection);
+		change_noti_object_path = g_strdup(object_path);
+		change_noti_interface = g_strdup(interface_name);
+	}
+	pthread_mutex_unlock(&change_noti_mutex);
+}
+
+void change_noti_finish(void)
+{
+	pthread_mutex_lock(&change_noti_mutex);
+	if (change_noti_source_id != 0) {
+		g_source_remove(change_noti_source_id);
+		change_noti_source_id = 0;
+	}
+	change_noti_emit_locked();
+
+	if (change_noti_connection) {
+		g_dbus_connection_flush_sync(change_noti_connection, NULL, NULL);
+		g_object_unref(change_noti_connection);
+		change_noti_connection = NULL;
+	}
+	g_free(change_noti_object_path);
+	change_noti_object_path = NULL;
+	g_free(change_noti_interface);
+	change_noti_interface = NULL;
+
+	if (change_noti_keys) {
+		g_hash_table_destroy(change_noti_keys);
+		change_noti_keys = NULL;
+	}
+	pthread_mutex_unlock(&change_noti_mutex);
+}
+
+void change_noti_queue(const char *op, int account_id, const char *package_name)
+{
+	change_noti_s *change = NULL;
+	char *key = NULL;
+	GSource *source = NULL;
+
+	if (op == NULL) {
+		_ERR("Noti Name is NULL!!!!!!\n");
+		return;
+	}
+
+	_INFO("noti_type = %s:%d", op, account_id);
+
+	key = g_strdup_printf("%s:%d", op, account_id);
+
+	pthread_mutex_lock(&change_noti_mutex);
+
+	if (change_noti_keys == NULL)
+		change_noti_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	/* the same change twice in a window, e.g. repeated sync status updates, is sent once */
+	if (g_hash_table_contains(change_noti_keys, key)) {
+		pthread_mutex_unlock(&change_noti_mutex);
+		g_free(key);
+		return;
+	}
+	g_hash_table_add(change_noti_keys, key);
+
+	change = g_new0(change_noti_s, 1);
+	change->op = g_strdup(op);
+	change->account_id = account_id;
+	change->package_name = g_strdup(package_name);
+	change_noti_pending = g_slist_prepend(change_noti_pending, change);
+	change_noti_count++;
+
+	if (change_noti_count >= CHANGE_NOTI_MAX_CHANGES) {
+		if (change_noti_source_id != 0) {
+			g_source_remove(change_noti_source_id);
+			change_noti_source_id = 0;
+		}
+		change_noti_emit_locked();
+	} else if (change_noti_source_id == 0) {
+		/* queued from worker threads, the window is closed on the main loop */
+		source = g_timeout_source_new(CHANGE_NOTI_DELAY_MS);
+		g_source_set_callback(source, change_noti_timeout_cb, NULL, NULL);
+		change_noti_source_id = g_source_attach(source, NULL);
+		g_source_unref(source);
+	}
+
+	pthread_mutex_unlock(&change_noti_mutex);
+}
+
+void change_noti_flush(void)
+{
+	pthread_mutex_lock(&change_noti_mutex);
+	if (change_noti_source_id != 0) {
+		g_source_remove(change_noti_source_id);
+		change_noti_source_id = 0;
+	}
+	change_noti_emit_locked();
+	pthread_mutex_unlock(&change_noti_mutex);
+}
@@ -0,0 +1,347 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <dlog.h>
+#include <dbg.h>
+
+#include "appid-cache.h"
+#include "client-cache.h"
+
+/* granted privileges are re-checked with cynara after this many seconds */
+#define CLIENT_CACHE_PRIVILEGE_TTL 30
+/* unique names of clients that vanished before we cached them are never signalled again */
+#define CLIENT_CACHE_MAX_SENDERS 256
+
+typedef struct _client_cache_entry_s {
+	bool has_peer_creds;
+	guint pid;
+	uid_t uid;
+	char *label;
+	char *client;
+	char *user;
+	char *session;
+	GHashTable *privileges;	/* privilege -> time it was granted */
+} client_cache_entry_s;
+
+static GHashTable *client_cache = NULL;
+static GDBusConnection *client_cache_connection = NULL;
+static guint name_owner_changed_id = 0;
+static pthread_mutex_t client_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void client_cache_entry_free(gpointer data)
+{
+	client_cache_entry_s *entry = (client_cache_entry_s *)data;
+
+	if (entry == NULL)
+		return;
+
+	g_free(entry->label);
+	g_free(entry->client);
+	g_free(entry->user);
+	g_free(entry->session);
+	g_hash_table_destroy(entry->privileges);
+	g_free(entry);
+}
+
+static client_cache_entry_s *client_cache_get_entry(const char *sender, bool create)
+{
+	client_cache_entry_s *entry = NULL;
+
+	if (client_cache == NULL) {
+		if (!create)
+			return NULL;
+		client_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, client_cache_entry_free);
+	}
+
+	entry = (client_cache_entry_s *)g_hash_table_lookup(client_cache, sender);
+	if (entry || !create)
+		return entry;
+
+	if (g_hash_table_size(client_cache) >= CLIENT_CACHE_MAX_SENDERS) {
+		_INFO("client cache is full, dropping [%d] senders", g_hash_table_size(client_cache));
+		g_hash_table_remove_all(client_cache);
+	}
+
+	entry = g_new0(client_cache_entry_s, 1);
+	entry->privileges = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_hash_table_insert(client_cache, g_strdup(sender), entry);
+
+	return entry;
+}
+
+static void client_cache_remove_sender(const char *sender)
+{
+	client_cache_entry_s *entry = NULL;
+	guint pid = 0;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	if (client_cache)
+		entry = (client_cache_entry_s *)g_hash_table_lookup(client_cache, sender);
+	if (entry) {
+		if (entry->has_peer_creds)
+			pid = entry->pid;
+		g_hash_table_remove(client_cache, sender);
+		_INFO("sender [%s] left the bus, cache dropped", sender);
+	}
+	pthread_mutex_unlock(&client_cache_mutex);
+
+	/* the process is most likely exiting, its pid may be handed out again */
+	if (pid != 0)
+		appid_cache_remove_pid((int)pid);
+}
+
+static void on_name_owner_changed(GDBusConnection *connection, const gchar *sender_name, const gchar *object_path,
+		const gchar *interface_name, const gchar *signal_name, GVariant *parameters, gpointer user_data)
+{
+	const gchar *name = NULL;
+	const gchar *old_owner = NULL;
+	const gchar *new_owner = NULL;
+
+	g_variant_get(parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
+
+	/* only unique names carry our cache entries */
+	if (name[0] == ':' && new_owner[0] == '\0')
+		client_cache_remove_sender(name);
+}
+
+void client_cache_init(GDBusConnection *connection)
+{
+	if (name_owner_changed_id != 0)
+		return;
+
+	client_cache_connection = g_object_ref(connection);
+	name_owner_changed_id = g_dbus_connection_signal_subscribe(connection,
+			"org.freedesktop.DBus",
+			"org.freedesktop.DBus",
+			"NameOwnerChanged",
+			"/org/freedesktop/DBus",
+			NULL,
+			G_DBUS_SIGNAL_FLAGS_NONE,
+			on_name_owner_changed,
+			NULL,
+			NULL);
+
+	_INFO("client cache subscribed to NameOwnerChanged [%d]", name_owner_changed_id);
+}
+
+void client_cache_finish(void)
+{
+	if (client_cache_connection) {
+		if (name_owner_changed_id != 0)
+			g_dbus_connection_signal_unsubscribe(client_cache_connection, name_owner_changed_id);
+		g_object_unref(client_cache_connection);
+		client_cache_connection = NULL;
+	}
+	name_owner_changed_id = 0;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	if (client_cache) {
+		g_hash_table_destroy(client_cache);
+		client_cache = NULL;
+	}
+	pthread_mutex_unlock(&client_cache_mutex);
+}
+
+bool client_cache_lookup_privilege(const char *sender, const char *privilege)
+{
+	client_cache_entry_s *entry = NULL;
+	gint64 *granted = NULL;
+	bool found = false;
+
+	/* without the subscription we would never learn that a sender went away */
+	if (sender == NULL || privilege == NULL || name_owner_changed_id == 0)
+		return false;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	entry = client_cache_get_entry(sender, false);
+	if (entry)
+		granted = (gint64 *)g_hash_table_lookup(entry->privileges, privilege);
+	if (granted) {
+		if (g_get_monotonic_time() - *granted < (gint64)CLIENT_CACHE_PRIVILEGE_TTL * G_USEC_PER_SEC)
+			found = true;
+		else
+			g_hash_table_remove(entry->privileges, privilege);
+	}
+	pthread_mutex_unlock(&client_cache_mutex);
+
+	return found;
+}
+
+void client_cache_store_privilege(const char *sender, const char *privilege)
+{
+	client_cache_entry_s *entry = NULL;
+	gint64 *granted = NULL;
+
+	if (sender == NULL || privilege == NULL || name_owner_changed_id == 0)
+		return;
+
+	granted = g_new(gint64, 1);
+	*granted = g_get_monotonic_time();
+
+	pthread_mutex_lock(&client_cache_mutex);
+	entry = client_cache_get_entry(sender, true);
+	g_hash_table_insert(entry->privileges, g_strdup(privilege), granted);
+	pthread_mutex_unlock(&client_cache_mutex);
+}
+
+bool client_cache_lookup_creds(const char *sender, char **client, char **user, char **session)
+{
+	client_cache_entry_s *entry = NULL;
+	bool found = false;
+
+	if (sender == NULL || name_owner_changed_id == 0)
+		return false;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	entry = client_cache_get_entry(sender, false);
+	if (entry && entry->client && entry->user && entry->session) {
+		*client = g_strdup(entry->client);
+		*user = g_strdup(entry->user);
+		*session = strdup(entry->session);
+		found = true;
+	}
+	pthread_mutex_unlock(&client_cache_mutex);
+
+	return found;
+}
+
+void client_cache_store_creds(const char *sender, const char *client, const char *user, const char *session)
+{
+	client_cache_entry_s *entry = NULL;
+
+	if (sender == NULL || name_owner_changed_id == 0)
+		return;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	entry = client_cache_get_entry(sender, true);
+	g_free(entry->client);
+	g_free(entry->user);
+	g_free(entry->session);
+	entry->client = g_strdup(client);
+	entry->user = g_strdup(user);
+	entry->session = g_strdup(session);
+	pthread_mutex_unlock(&client_cache_mutex);
+}
+
+static int client_cache_query_peer_creds(GDBusConnection *connection, const char *sender, guint *pid, uid_t *uid, char **label)
+{
+	GError *error = NULL;
+	GVariant *ret = NULL;
+	GVariant *creds = NULL;
+	GVariant *value = NULL;
+	const gchar *key = NULL;
+	GVariantIter iter;
+	bool has_pid = false;
+	bool has_uid = false;
+
+	/* one round trip gives pid, uid and the security label together */
+	ret = g_dbus_connection_call_sync(connection,
+			"org.freedesktop.DBus",
+			"/org/freedesktop/DBus",
+			"org.freedesktop.DBus",
+			"GetConnectionCredentials",
+			g_variant_new("(s)", sender),
+			G_VARIANT_TYPE("(a{sv})"),
+			G_DBUS_CALL_FLAGS_NONE,
+			-1,
+			NULL,
+			&error);
+	if (ret == NULL) {
+		_ERR("GetConnectionCredentials(%s) failed [%s]", sender, error ? error->message : "");
+		g_clear_error(&error);
+		return -1;
+	}
+
+	creds = g_variant_get_child_value(ret, 0);
+	g_variant_iter_init(&iter, creds);
+	while (g_variant_iter_loop(&iter, "{&sv}", &key, &value)) {
+		if (g_strcmp0(key, "ProcessID") == 0) {
+			*pid = g_variant_get_uint32(value);
+			has_pid = true;
+		} else if (g_strcmp0(key, "UnixUserID") == 0) {
+			*uid = g_variant_get_uint32(value);
+			has_uid = true;
+		} else if (g_strcmp0(key, "LinuxSecurityLabel") == 0) {
+			/* the label is a NUL terminated byte array */
+			*label = g_strdup(g_variant_get_bytestring(value));
+		}
+	}
+	g_variant_unref(creds);
+	g_variant_unref(ret);
+
+	if (!has_pid || !has_uid) {
+		_ERR("GetConnectionCredentials(%s) has no pid or uid", sender);
+		g_free(*label);
+		*label = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+int client_cache_get_peer_creds(GDBusConnection *connection, const char *sender, guint *pid, uid_t *uid, char **label)
+{
+	client_cache_entry_s *entry = NULL;
+	guint new_pid = 0;
+	uid_t new_uid = 0;
+	char *new_label = NULL;
+
+	if (connection == NULL || sender == NULL)
+		return -1;
+
+	pthread_mutex_lock(&client_cache_mutex);
+	if (name_owner_changed_id != 0)
+		entry = client_cache_get_entry(sender, false);
+	if (entry && entry->has_peer_creds) {
+		*pid = entry->pid;
+		*uid = entry->uid;
+		if (label)
+			*label = g_strdup(entry->label);
+		pthread_mutex_unlock(&client_cache_mutex);
+		return 0;
+	}
+	pthread_mutex_unlock(&client_cache_mutex);
+
+	if (client_cache_query_peer_creds(connection, sender, &new_pid, &new_uid, &new_label) != 0)
+		return -1;
+
+	*pid = new_pid;
+	*uid = new_uid;
+	if (label)
+		*label = g_strdup(new_label);
+
+	if (name_owner_changed_id != 0) {
+		pthread_mutex_lock(&client_cache_mutex);
+		entry = client_cache_get_entry(sender, true);
+		g_free(entry->label);
+		entry->label = new_label;
+		entry->pid = new_pid;
+		entry->uid = new_uid;
+		entry->has_peer_creds = true;
+		pthread_mutex_unlock(&client_cache_mutex);
+	} else {
+		g_free(new_label);
+	}
+
+	return 0;
+}
@@ -16,51 +16,164 @@
  *
  */
 
-#include <unistd.h>
 #include <stdbool.h>
 #include <glib.h>
 #include <pthread.h>
 #include <dlog.h>
 #include <dbg.h>
 
-#define TIMEOUT 20
+#include "account-server-db.h"
+#include "lifecycle.h"
+
+/* seconds the daemon stays up after the last call, longer while clients keep coming back */
+#ifndef ACCOUNT_IDLE_TIMEOUT
+#define ACCOUNT_IDLE_TIMEOUT 20
+#endif
+#define ACCOUNT_IDLE_TIMEOUT_MAX (6 * ACCOUNT_IDLE_TIMEOUT)
+#define DB_CHECKPOINT_TIMEOUT 2
+#define DB_IDLE_TIMEOUT 5
+
+typedef enum {
+	LIFECYCLE_IDLE_CHECKPOINT = 0,	/* the write-ahead log is checkpointed first */
+	LIFECYCLE_IDLE_EVICT,		/* then cached db connections are dropped */
+	LIFECYCLE_IDLE_EXIT
+} lifecycle_idle_stage_e;
 
 static int method_call_count = 0;
-static int timer_count = 0;
-static bool is_running_timer = false;
+static GSource *idle_source = NULL;
+static lifecycle_idle_stage_e idle_stage = LIFECYCLE_IDLE_CHECKPOINT;
+static gint64 idle_since = 0;
+static gint64 last_call_end = 0;
+static gint64 idle_gap_average = 0;	/* of the idle periods that ended with a new call, in usec */
+static gint64 start_time = 0;
+static bool first_reply_logged = false;
 static pthread_mutex_t lifecycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lifecycle_calls_done_cond = PTHREAD_COND_INITIALIZER;
 
 void terminate_main_loop();
 
-void *lifecycle_termination_timer()
+/*
+ * A client coming back within twice its usual gap keeps the daemon up instead of paying a
+ * new D-Bus activation, one coming back later than the maximum would not be caught anyway.
+ */
+static int lifecycle_exit_timeout(void)
 {
-	while (TIMEOUT >= timer_count) {
-		pthread_mutex_lock(&lifecycle_mutex);
-		timer_count++;
+	gint64 timeout = 2 * idle_gap_average / G_USEC_PER_SEC;
+
+	if (timeout <= ACCOUNT_IDLE_TIMEOUT || timeout > ACCOUNT_IDLE_TIMEOUT_MAX)
+		return ACCOUNT_IDLE_TIMEOUT;
+
+	return (int)timeout;
+}
+
+/* called with lifecycle_mutex held */
+static void lifecycle_idle_arm(lifecycle_idle_stage_e stage, int timeout)
+{
+	idle_stage = stage;
+	if (idle_source)
+		g_source_set_ready_time(idle_source, idle_since + (gint64)timeout * G_USEC_PER_SEC);
+}
+
+static gboolean lifecycle_idle_dispatch(GSource *source, GSourceFunc callback, gpointer user_data)
+{
+	lifecycle_idle_stage_e stage;
+	int exit_timeout = 0;
+
+	pthread_mutex_lock(&lifecycle_mutex);
+	g_source_set_ready_time(source, -1);
+
+	/* a call that came in after the source got ready disarmed it too late */
+	if (method_call_count > 0) {
 		pthread_mutex_unlock(&lifecycle_mutex);
-		_INFO("while timer_count = [%d]", timer_count);
-		sleep(1);
+		return G_SOURCE_CONTINUE;
 	}
 
-	if (method_call_count <= 0)
+	stage = idle_stage;
+	exit_timeout = lifecycle_exit_timeout();
+
+	switch (stage) {
+	case LIFECYCLE_IDLE_CHECKPOINT:
+		lifecycle_idle_arm(LIFECYCLE_IDLE_EVICT, DB_IDLE_TIMEOUT);
+		break;
+	case LIFECYCLE_IDLE_EVICT:
+		/* under the lock, so no call picks up a connection while they are closed */
+		_account_db_pool_evict_idle();
+		lifecycle_idle_arm(LIFECYCLE_IDLE_EXIT, exit_timeout);
+		_INFO("account idle, exiting in [%d] sec unless called", exit_timeout);
+		break;
+	case LIFECYCLE_IDLE_EXIT:
+	default:
+		_INFO("account idle for [%d] sec, terminating", exit_timeout);
 		terminate_main_loop();
-	else
-		_ERR("account method_call_count > 0");
+		break;
+	}
+	pthread_mutex_unlock(&lifecycle_mutex);
+
+	if (stage == LIFECYCLE_IDLE_CHECKPOINT)
+		_account_db_pool_checkpoint();
+
+	return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs lifecycle_idle_funcs = {
+	NULL,
+	NULL,
+	lifecycle_idle_dispatch,
+	NULL,
+};
+
+void lifecycle_init(void)
+{
+	pthread_mutex_lock(&lifecycle_mutex);
+	if (start_time == 0)
+		start_time = g_get_monotonic_time();
+
+	if (idle_source == NULL) {
+		idle_source = g_source_new(&lifecycle_idle_funcs, sizeof(GSource));
+		g_source_set_name(idle_source, "account idle");
+		g_source_attach(idle_source, NULL);
+	}
 
-	pthread_detach(pthread_self());
+	/* an activation nobody calls into goes away as well */
+	if (method_call_count <= 0) {
+		idle_since = g_get_monotonic_time();
+		lifecycle_idle_arm(LIFECYCLE_IDLE_CHECKPOINT, DB_CHECKPOINT_TIMEOUT);
+	}
+	pthread_mutex_unlock(&lifecycle_mutex);
+}
 
+void lifecycle_finish(void)
+{
 	pthread_mutex_lock(&lifecycle_mutex);
-	is_running_timer = false;
+	if (idle_source) {
+		g_source_destroy(idle_source);
+		g_source_unref(idle_source);
+		idle_source = NULL;
+	}
 	pthread_mutex_unlock(&lifecycle_mutex);
-	pthread_exit(NULL);
 }
 
+void lifecycle_name_acquired(void)
+{
+	_INFO("cold start: bus name owned [%lld] msec after start",
+			(long long)((g_get_monotonic_time() - start_time) / 1000));
+}
 
 void lifecycle_method_call_active()
 {
+	gint64 idle_gap = 0;
+
 	pthread_mutex_lock(&lifecycle_mutex);
 
-	method_call_count++;
+	if (method_call_count++ <= 0) {
+		/* smoothed over the last few idle periods, a single long pause does not reset it */
+		if (last_call_end > 0) {
+			idle_gap = g_get_monotonic_time() - last_call_end;
+			idle_gap_average = idle_gap_average ? (3 * idle_gap_average + idle_gap) / 4 : idle_gap;
+		}
+		if (idle_source)
+			g_source_set_ready_time(idle_source, -1);
+	}
 	_INFO("account lifecycle_method_call_active method_call_count = [%d]", method_call_count);
 
 	pthread_mutex_unlock(&lifecycle_mutex);
@@ -68,34 +181,35 @@ void lifecycle_method_call_active()
 
 void lifecycle_method_call_inactive()
 {
-	pthread_t curThread;
-
+	/* handlers finish on worker threads, the source is only rearmed and runs on the main loop */
 	pthread_mutex_lock(&lifecycle_mutex);
 
 	method_call_count--;
 	_INFO("account lifecycle_method_call_inactive method_call_count = [%d]", method_call_count);
-	pthread_mutex_unlock(&lifecycle_mutex);
+
+	/* handlers send their reply before going inactive, this is what an activating client waited for */
+	if (!first_reply_logged) {
+		first_reply_logged = true;
+		_INFO("cold start: first reply [%lld] msec after start",
+				(long long)((g_get_monotonic_time() - start_time) / 1000));
+	}
 
 	if (method_call_count <= 0) {
-		if (!is_running_timer) {
-			pthread_mutex_lock(&lifecycle_mutex);
-			pthread_mutex_unlock(&lifecycle_mutex);
-			int ret = pthread_create(&curThread, NULL, lifecycle_termination_timer, NULL);
-			_INFO("account create timer thread");
-			if (ret != 0) {
-				_ERR("account pthread_create fail!");
-			} else {
-				pthread_mutex_lock(&lifecycle_mutex);
-				is_running_timer = true;
-				pthread_mutex_unlock(&lifecycle_mutex);
-			}
-		} else {
-			pthread_mutex_lock(&lifecycle_mutex);
-			timer_count = 0;
-			_INFO("account timer thread already is running. set timer_count = 0");
-			pthread_mutex_unlock(&lifecycle_mutex);
-		}
+		idle_since = g_get_monotonic_time();
+		last_call_end = idle_since;
+		lifecycle_idle_arm(LIFECYCLE_IDLE_CHECKPOINT, DB_CHECKPOINT_TIMEOUT);
+		pthread_cond_broadcast(&lifecycle_calls_done_cond);
 	}
-}
 
+	pthread_mutex_unlock(&lifecycle_mutex);
+}
 
+void lifecycle_wait_method_calls_done(void)
+{
+	pthread_mutex_lock(&lifecycle_mutex);
+	while (method_call_count > 0) {
+		_INFO("waiting for [%d] method calls to finish", method_call_count);
+		pthread_cond_wait(&lifecycle_calls_done_cond, &lifecycle_mutex);
+	}
+	pthread_mutex_unlock(&lifecycle_mutex);
+}
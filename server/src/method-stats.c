@@ -0,0 +1,422 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include <gio/gio.h>
+#include <dlog.h>
+#include <dbg.h>
+#include <account_err.h>
+
+#include "method-stats.h"
+
+/* bucket b counts the durations below 2^b usec, the last one everything longer */
+#define METHOD_STATS_BUCKETS 24
+
+typedef struct _method_stats_histogram_s {
+	guint64 count;
+	guint64 sum;	/* in usec, as are max and the bucket bounds */
+	guint64 max;
+	guint64 buckets[METHOD_STATS_BUCKETS];
+} method_stats_histogram_s;
+
+typedef struct _method_stats_method_s {
+	guint64 calls;
+	GHashTable *errors;	/* return code -> calls, _ACCOUNT_ERROR_NONE is not kept */
+	method_stats_histogram_s phases[METHOD_STATS_PHASE_MAX];
+	guint64 scoped_calls;	/* calls that had a request scope, carved and allocated are their sums */
+	guint64 carved;
+	guint64 allocated;
+} method_stats_method_s;
+
+/* the call the current thread is handling */
+typedef struct _method_stats_call_s {
+	method_stats_method_s *method;
+	int result;
+	gint64 begin;
+	bool in_phase;
+	method_stats_phase_e phase;
+	gint64 phase_begin;
+	gint64 phase_usec[METHOD_STATS_PHASE_MAX];
+	bool phase_seen[METHOD_STATS_PHASE_MAX];
+	bool scoped;
+	guint64 carved;
+	guint64 allocated;
+} method_stats_call_s;
+
+static const char *method_stats_phase_names[METHOD_STATS_PHASE_MAX] = {
+	"pid",
+	"privilege",
+	"db_open",
+	"query+reply",
+	"marshal",
+	"total",
+};
+
+/* method name -> method_stats_method_s, entries are only zeroed by a reset */
+static GHashTable *method_stats_methods = NULL;
+static pthread_mutex_t method_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static guint method_stats_signal_id = 0;
+static __thread method_stats_call_s method_stats_call;
+
+static void method_stats_method_free(gpointer data)
+{
+	method_stats_method_s *method = (method_stats_method_s *)data;
+
+	g_hash_table_destroy(method->errors);
+	g_free(method);
+}
+
+static int method_stats_bucket(guint64 usec)
+{
+	int bucket = 0;
+
+	while (bucket < METHOD_STATS_BUCKETS - 1 && (usec >> bucket) != 0)
+		bucket++;
+
+	return bucket;
+}
+
+static guint64 method_stats_bucket_bound(int bucket)
+{
+	if (bucket >= METHOD_STATS_BUCKETS - 1)
+		return G_MAXUINT64;
+
+	return (guint64)1 << bucket;
+}
+
+/* called with method_stats_mutex held */
+static void method_stats_histogram_add(method_stats_histogram_s *histogram, guint64 usec)
+{
+	histogram->count++;
+	histogram->sum += usec;
+	if (usec > histogram->max)
+		histogram->max = usec;
+	histogram->buckets[method_stats_bucket(usec)]++;
+}
+
+/* bound of the bucket the permille-th duration falls in, so rounded up to the next power of two */
+static guint64 method_stats_histogram_percentile(const method_stats_histogram_s *histogram, int permille)
+{
+	guint64 rank = 0;
+	guint64 seen = 0;
+	int bucket = 0;
+
+	if (histogram->count == 0)
+		return 0;
+
+	rank = (histogram->count * permille + 999) / 1000;
+	for (bucket = 0; bucket < METHOD_STATS_BUCKETS; bucket++) {
+		seen += histogram->buckets[bucket];
+		if (seen >= rank)
+			return MIN(method_stats_bucket_bound(bucket), histogram->max);
+	}
+
+	return histogram->max;
+}
+
+/* dispatched on the main loop, not in the signal handler */
+static gboolean method_stats_signal_cb(gpointer user_data)
+{
+	method_stats_dump();
+
+	return G_SOURCE_CONTINUE;
+}
+
+void method_stats_init(void)
+{
+	if (method_stats_signal_id == 0)
+		method_stats_signal_id = g_unix_signal_add(SIGUSR1, method_stats_signal_cb, NULL);
+}
+
+void method_stats_finish(void)
+{
+	/* the daemon exits when idle, this is what a run leaves behind */
+	method_stats_dump();
+
+	if (method_stats_signal_id) {
+		g_source_remove(method_stats_signal_id);
+		method_stats_signal_id = 0;
+	}
+
+	pthread_mutex_lock(&method_stats_mutex);
+	if (method_stats_methods) {
+		g_hash_table_destroy(method_stats_methods);
+		method_stats_methods = NULL;
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+}
+
+void method_stats_call_begin(GDBusMethodInvocation *invocation)
+{
+	method_stats_call_s *call = &method_stats_call;
+	method_stats_method_s *method = NULL;
+	const char *name = g_dbus_method_invocation_get_method_name(invocation);
+
+	memset(call, 0, sizeof(method_stats_call_s));
+	if (name == NULL)
+		return;
+
+	/* looked up here, the invocation and its name are gone once the reply is sent */
+	pthread_mutex_lock(&method_stats_mutex);
+	if (method_stats_methods == NULL)
+		method_stats_methods = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, method_stats_method_free);
+
+	method = (method_stats_method_s *)g_hash_table_lookup(method_stats_methods, name);
+	if (method == NULL) {
+		method = g_new0(method_stats_method_s, 1);
+		method->errors = g_hash_table_new(g_direct_hash, g_direct_equal);
+		g_hash_table_insert(method_stats_methods, g_strdup(name), method);
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+
+	call->method = method;
+	call->result = _ACCOUNT_ERROR_NONE;
+	call->begin = g_get_monotonic_time();
+}
+
+void method_stats_call_result(int return_code)
+{
+	if (method_stats_call.method)
+		method_stats_call.result = return_code;
+}
+
+void method_stats_call_end(void)
+{
+	method_stats_call_s *call = &method_stats_call;
+	method_stats_method_s *method = call->method;
+	gint64 query = 0;
+	guint count = 0;
+	int phase = 0;
+
+	if (method == NULL)
+		return;
+
+	call->phase_usec[METHOD_STATS_PHASE_TOTAL] = g_get_monotonic_time() - call->begin;
+	call->phase_seen[METHOD_STATS_PHASE_TOTAL] = true;
+
+	/* only a call that got its connections ran a query, a denied one would just skew it to zero */
+	if (call->phase_seen[METHOD_STATS_PHASE_DB_OPEN]) {
+		query = call->phase_usec[METHOD_STATS_PHASE_TOTAL];
+		for (phase = 0; phase < METHOD_STATS_PHASE_TOTAL; phase++) {
+			if (phase != METHOD_STATS_PHASE_QUERY)
+				query -= call->phase_usec[phase];
+		}
+		call->phase_usec[METHOD_STATS_PHASE_QUERY] = MAX(query, 0);
+		call->phase_seen[METHOD_STATS_PHASE_QUERY] = true;
+	}
+
+	pthread_mutex_lock(&method_stats_mutex);
+	method->calls++;
+	if (call->result != _ACCOUNT_ERROR_NONE) {
+		count = GPOINTER_TO_UINT(g_hash_table_lookup(method->errors, GINT_TO_POINTER(call->result)));
+		g_hash_table_insert(method->errors, GINT_TO_POINTER(call->result), GUINT_TO_POINTER(count + 1));
+	}
+	for (phase = 0; phase < METHOD_STATS_PHASE_MAX; phase++) {
+		if (call->phase_seen[phase])
+			method_stats_histogram_add(&method->phases[phase], (guint64)call->phase_usec[phase]);
+	}
+	if (call->scoped) {
+		method->scoped_calls++;
+		method->carved += call->carved;
+		method->allocated += call->allocated;
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+
+	call->method = NULL;
+}
+
+void method_stats_phase_begin(method_stats_phase_e phase)
+{
+	method_stats_call_s *call = &method_stats_call;
+
+	/* e.g. the pid lookup a privilege check falls back to is part of the check */
+	if (call->method == NULL || call->in_phase)
+		return;
+
+	call->in_phase = true;
+	call->phase = phase;
+	call->phase_begin = g_get_monotonic_time();
+}
+
+void method_stats_phase_end(method_stats_phase_e phase)
+{
+	method_stats_call_s *call = &method_stats_call;
+
+	if (call->method == NULL || !call->in_phase || call->phase != phase)
+		return;
+
+	call->phase_usec[phase] += g_get_monotonic_time() - call->phase_begin;
+	call->phase_seen[phase] = true;
+	call->in_phase = false;
+}
+
+void method_stats_call_allocations(guint64 carved, guint64 allocated)
+{
+	method_stats_call_s *call = &method_stats_call;
+
+	if (call->method == NULL)
+		return;
+
+	call->scoped = true;
+	call->carved += carved;
+	call->allocated += allocated;
+}
+
+GVariant *method_stats_to_variant(void)
+{
+	GVariantBuilder bounds;
+	GVariantBuilder methods;
+	GVariantBuilder errors;
+	GVariantBuilder phases;
+	GVariantBuilder buckets;
+	GHashTableIter iter;
+	GHashTableIter error_iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+	gpointer error_key = NULL;
+	gpointer error_value = NULL;
+	method_stats_method_s *method = NULL;
+	method_stats_histogram_s *histogram = NULL;
+	int phase = 0;
+	int bucket = 0;
+
+	g_variant_builder_init(&bounds, G_VARIANT_TYPE("at"));
+	for (bucket = 0; bucket < METHOD_STATS_BUCKETS; bucket++)
+		g_variant_builder_add(&bounds, "t", method_stats_bucket_bound(bucket));
+
+	g_variant_builder_init(&methods, G_VARIANT_TYPE("a{s(ta{it}a{s(tttat)})}"));
+
+	pthread_mutex_lock(&method_stats_mutex);
+	if (method_stats_methods) {
+		g_hash_table_iter_init(&iter, method_stats_methods);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			method = (method_stats_method_s *)value;
+
+			g_variant_builder_init(&errors, G_VARIANT_TYPE("a{it}"));
+			g_hash_table_iter_init(&error_iter, method->errors);
+			while (g_hash_table_iter_next(&error_iter, &error_key, &error_value))
+				g_variant_builder_add(&errors, "{it}", GPOINTER_TO_INT(error_key), (guint64)GPOINTER_TO_UINT(error_value));
+
+			/* phases a method never went through are left out */
+			g_variant_builder_init(&phases, G_VARIANT_TYPE("a{s(tttat)}"));
+			for (phase = 0; phase < METHOD_STATS_PHASE_MAX; phase++) {
+				histogram = &method->phases[phase];
+				if (histogram->count == 0)
+					continue;
+
+				g_variant_builder_init(&buckets, G_VARIANT_TYPE("at"));
+				for (bucket = 0; bucket < METHOD_STATS_BUCKETS; bucket++)
+					g_variant_builder_add(&buckets, "t", histogram->buckets[bucket]);
+
+				g_variant_builder_add(&phases, "{s(tttat)}", method_stats_phase_names[phase],
+						histogram->count, histogram->sum, histogram->max, &buckets);
+			}
+
+			g_variant_builder_add(&methods, "{s(ta{it}a{s(tttat)})}", (const char *)key, method->calls, &errors, &phases);
+		}
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+
+	return g_variant_new("(ata{s(ta{it}a{s(tttat)})})", &bounds, &methods);
+}
+
+void method_stats_reset(void)
+{
+	GHashTableIter iter;
+	gpointer value = NULL;
+	method_stats_method_s *method = NULL;
+
+	/* calls in flight keep a pointer to their entry, so it is cleared rather than removed */
+	pthread_mutex_lock(&method_stats_mutex);
+	if (method_stats_methods) {
+		g_hash_table_iter_init(&iter, method_stats_methods);
+		while (g_hash_table_iter_next(&iter, NULL, &value)) {
+			method = (method_stats_method_s *)value;
+			method->calls = 0;
+			g_hash_table_remove_all(method->errors);
+			memset(method->phases, 0, sizeof(method->phases));
+			method->scoped_calls = 0;
+			method->carved = 0;
+			method->allocated = 0;
+		}
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+
+	_INFO("method stats reset");
+}
+
+void method_stats_dump(void)
+{
+	GHashTableIter iter;
+	GHashTableIter error_iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+	gpointer error_key = NULL;
+	gpointer error_value = NULL;
+	method_stats_method_s *method = NULL;
+	method_stats_histogram_s *histogram = NULL;
+	GString *errors = NULL;
+	int phase = 0;
+
+	pthread_mutex_lock(&method_stats_mutex);
+	if (method_stats_methods) {
+		g_hash_table_iter_init(&iter, method_stats_methods);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			method = (method_stats_method_s *)value;
+			if (method->calls == 0)
+				continue;
+
+			errors = g_string_new(NULL);
+			g_hash_table_iter_init(&error_iter, method->errors);
+			while (g_hash_table_iter_next(&error_iter, &error_key, &error_value))
+				g_string_append_printf(errors, "%s%d:%u", errors->len ? " " : "",
+						GPOINTER_TO_INT(error_key), GPOINTER_TO_UINT(error_value));
+
+			_INFO("stats [%s] calls [%llu] errors [%s]", (const char *)key,
+					(unsigned long long)method->calls, errors->str);
+			g_string_free(errors, TRUE);
+
+			for (phase = 0; phase < METHOD_STATS_PHASE_MAX; phase++) {
+				histogram = &method->phases[phase];
+				if (histogram->count == 0)
+					continue;
+
+				_INFO("stats [%s] %s count [%llu] avg [%llu] p50 [%llu] p99 [%llu] max [%llu] usec",
+						(const char *)key, method_stats_phase_names[phase],
+						(unsigned long long)histogram->count,
+						(unsigned long long)(histogram->sum / histogram->count),
+						(unsigned long long)method_stats_histogram_percentile(histogram, 500),
+						(unsigned long long)method_stats_histogram_percentile(histogram, 990),
+						(unsigned long long)histogram->max);
+			}
+
+			/* carved is what the results would have cost in mallocs without the scope */
+			if (method->scoped_calls)
+				_INFO("stats [%s] scope calls [%llu] avg carved [%llu] avg malloc [%llu]", (const char *)key,
+						(unsigned long long)method->scoped_calls,
+						(unsigned long long)(method->carved / method->scoped_calls),
+						(unsigned long long)(method->allocated / method->scoped_calls));
+		}
+	}
+	pthread_mutex_unlock(&method_stats_mutex);
+}
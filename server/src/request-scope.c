@@ -0,0 +1,198 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+#include <glib.h>
+
+#include "request-scope.h"
+#include "method-stats.h"
+
+/* a streamed account with its capabilities and custom rows fits in one block */
+#define REQUEST_SCOPE_BLOCK_SIZE 4096
+#define REQUEST_SCOPE_ALIGN(size) (((size) + 2 * sizeof(gpointer) - 1) & ~(2 * sizeof(gpointer) - 1))
+#define REQUEST_SCOPE_BLOCK_HEADER REQUEST_SCOPE_ALIGN(sizeof(request_scope_block_s))
+
+typedef struct _request_scope_block_s {
+	struct _request_scope_block_s *next;
+	gsize size;	/* both counted from the start of the block */
+	gsize used;
+} request_scope_block_s;
+
+typedef struct _request_scope_cleanup_s {
+	GDestroyNotify destroy;
+	gpointer data;
+} request_scope_cleanup_s;
+
+struct _request_scope_s {
+	request_scope_block_s *blocks;	/* the one being carved first */
+	request_scope_block_s *spare;	/* blocks of the usual size a reset handed back */
+	GSList *cleanups;	/* request_scope_cleanup_s, last added first */
+	guint64 carved;
+	guint64 allocated;
+};
+
+static void request_scope_block_list_free(request_scope_block_s *block)
+{
+	request_scope_block_s *next = NULL;
+
+	for (; block != NULL; block = next) {
+		next = block->next;
+		g_free(block);
+	}
+}
+
+static request_scope_block_s *request_scope_block_new(request_scope_s *scope, gsize size)
+{
+	request_scope_block_s *block = NULL;
+	gsize block_size = MAX(REQUEST_SCOPE_BLOCK_SIZE, REQUEST_SCOPE_BLOCK_HEADER + size);
+
+	if (block_size == REQUEST_SCOPE_BLOCK_SIZE && scope->spare) {
+		block = scope->spare;
+		scope->spare = block->next;
+	} else {
+		block = (request_scope_block_s *)g_malloc(block_size);
+		block->size = block_size;
+		scope->allocated++;
+	}
+
+	block->used = REQUEST_SCOPE_BLOCK_HEADER;
+	block->next = scope->blocks;
+	scope->blocks = block;
+
+	return block;
+}
+
+request_scope_s *request_scope_new(void)
+{
+	request_scope_s *scope = g_new0(request_scope_s, 1);
+
+	/* the scope itself is the one allocation it always makes */
+	scope->allocated = 1;
+
+	return scope;
+}
+
+void request_scope_free(request_scope_s *scope)
+{
+	GSList *iter = NULL;
+
+	if (scope == NULL)
+		return;
+
+	for (iter = scope->cleanups; iter != NULL; iter = g_slist_next(iter)) {
+		request_scope_cleanup_s *cleanup = (request_scope_cleanup_s *)iter->data;
+
+		cleanup->destroy(cleanup->data);
+		g_free(cleanup);
+	}
+	g_slist_free(scope->cleanups);
+
+	request_scope_block_list_free(scope->blocks);
+	request_scope_block_list_free(scope->spare);
+
+	method_stats_call_allocations(scope->carved, scope->allocated);
+
+	g_free(scope);
+}
+
+gpointer request_scope_alloc(request_scope_s *scope, gsize size)
+{
+	request_scope_block_s *block = scope->blocks;
+	gpointer ptr = NULL;
+
+	size = REQUEST_SCOPE_ALIGN(size);
+
+	/* what is left of the current block is given up, an account rarely leaves much of it */
+	if (block == NULL || block->size - block->used < size)
+		block = request_scope_block_new(scope, size);
+
+	ptr = (char *)block + block->used;
+	block->used += size;
+	scope->carved++;
+
+	/* blocks are reused after a reset, so everything is zeroed as it is handed out */
+	memset(ptr, 0, size);
+
+	return ptr;
+}
+
+char *request_scope_strdup(request_scope_s *scope, const char *str)
+{
+	gsize len = 0;
+	char *dup = NULL;
+
+	if (str == NULL)
+		return NULL;
+
+	len = strlen(str) + 1;
+	dup = (char *)request_scope_alloc(scope, len);
+	memcpy(dup, str, len);
+
+	return dup;
+}
+
+GSList *request_scope_slist_prepend(request_scope_s *scope, GSList *list, gpointer data)
+{
+	GSList *node = (GSList *)request_scope_alloc(scope, sizeof(GSList));
+
+	node->data = data;
+	node->next = list;
+
+	return node;
+}
+
+void request_scope_mark(request_scope_s *scope, request_scope_mark_s *mark)
+{
+	mark->block = scope->blocks;
+	mark->used = scope->blocks ? scope->blocks->used : 0;
+}
+
+void request_scope_reset(request_scope_s *scope, const request_scope_mark_s *mark)
+{
+	request_scope_block_s *block = NULL;
+
+	while (scope->blocks != NULL && scope->blocks != mark->block) {
+		block = scope->blocks;
+		scope->blocks = block->next;
+
+		if (block->size == REQUEST_SCOPE_BLOCK_SIZE) {
+			block->next = scope->spare;
+			scope->spare = block;
+		} else {
+			g_free(block);
+		}
+	}
+
+	if (scope->blocks)
+		scope->blocks->used = mark->used;
+}
+
+void request_scope_add_cleanup(request_scope_s *scope, GDestroyNotify destroy, gpointer data)
+{
+	request_scope_cleanup_s *cleanup = NULL;
+
+	if (destroy == NULL || data == NULL)
+		return;
+
+	cleanup = g_new(request_scope_cleanup_s, 1);
+	cleanup->destroy = destroy;
+	cleanup->data = data;
+	scope->cleanups = g_slist_prepend(scope->cleanups, cleanup);
+	/* the cleanup and its list node */
+	scope->allocated += 2;
+}
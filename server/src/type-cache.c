@@ -0,0 +1,1389 @@
+/*
+ *
+ * Copyright (c) 2012 - 2013 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <glib.h>
+#include <dlog.h>
+#include <dbg.h>
+#include <account_free.h>
+#include <account-private.h>
+#include <account_db_helper.h>
+#include <account_err.h>
+
+#include "type-cache.h"
+
+/* offset of the file change counter in the sqlite database header */
+#define TYPE_CACHE_CHANGE_COUNTER_OFFSET 24
+
+/* usec a checked global catalog is trusted without looking at the db files again, unless invalidated */
+#define TYPE_CACHE_GLOBAL_CHECK_INTERVAL G_USEC_PER_SEC
+
+/*
+ * Bumped on any change to the snapshot layout below, an older file is then rebuilt from the dbs.
+ * The same layout holds the index of the global db written at install time.
+ */
+#define TYPE_CACHE_SNAPSHOT_MAGIC "ACCTCAT"
+#define TYPE_CACHE_SNAPSHOT_VERSION 2
+
+/* what the installer leaves behind when it commits to the global db */
+typedef struct _type_cache_stamp_s {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+	off_t wal_size;
+	struct timespec wal_mtime;
+	unsigned char change_counter[4];
+} type_cache_stamp_s;
+
+/*
+ * Catalogs kept in a file, so an activation does not have to read every type table again.
+ * Sections follow the header in this order, string fields are offsets into the string table
+ * and 0 is NULL. All records are of 4 and 8 byte members, each section stays aligned.
+ */
+typedef struct _type_cache_snapshot_header_s {
+	char magic[8];			/* written last, a file cut short has none */
+	guint32 version;
+	guint32 header_size;
+	guint32 catalog_size;
+	guint32 catalog_count;
+	guint32 type_count;
+	guint32 label_count;		/* also the length of the label order */
+	guint32 feature_count;		/* also the length of the feature order */
+	guint32 string_size;
+} type_cache_snapshot_header_s;
+
+/* one per database, only used while its files still carry the stamp */
+typedef struct _type_cache_snapshot_catalog_s {
+	type_cache_stamp_s stamp;
+	guint32 uid;
+	guint32 global;
+	guint32 db_path;
+	guint32 first_type;
+	guint32 type_count;
+	guint32 first_label;		/* into the labels and the label order alike */
+	guint32 label_count;
+	guint32 first_feature;		/* into the features and the feature order alike */
+	guint32 feature_count;
+} type_cache_snapshot_catalog_s;
+
+typedef struct _type_cache_snapshot_type_s {
+	gint32 id;
+	gint32 multiple_account_support;
+	guint32 app_id;
+	guint32 service_provider_id;
+	guint32 icon_path;
+	guint32 small_icon_path;
+} type_cache_snapshot_type_s;
+
+/* rows of the types in table order, then those of app ids without a type */
+typedef struct _type_cache_snapshot_label_s {
+	guint32 app_id;
+	guint32 label;
+	guint32 locale;
+} type_cache_snapshot_label_s;
+
+typedef struct _type_cache_snapshot_feature_s {
+	guint32 app_id;
+	guint32 key;
+} type_cache_snapshot_feature_s;
+
+/*
+ * Sections of a mapped snapshot. The orders are the indexes of the label and feature rows
+ * of each catalog sorted by app id and locale or key, rows comparing equal stay in row order.
+ */
+typedef struct _type_cache_snapshot_s {
+	GMappedFile *file;
+	const type_cache_snapshot_header_s *header;
+	const type_cache_snapshot_catalog_s *catalogs;
+	const type_cache_snapshot_type_s *types;
+	const type_cache_snapshot_label_s *labels;
+	const type_cache_snapshot_feature_s *features;
+	const guint32 *label_order;
+	const guint32 *feature_order;
+	const char *strings;
+} type_cache_snapshot_s;
+
+struct _type_cache_catalog_s {
+	gint ref_count;
+	char *db_path;
+	GSList *account_types;		/* in table order once indexed */
+	GHashTable *app_ids;		/* app id -> account_type_s */
+	GHashTable *provider_features;	/* key -> GSList of account_type_s having it, in table order */
+	GHashTable *supported_features;	/* "app_id\nkey" of every provider_feature row, empty when mapped */
+	GHashTable *labels;		/* "app_id\nlocale" -> label, empty when mapped */
+	/* set when built from a snapshot or the index, its sorted rows then answer the label and feature lookups */
+	type_cache_snapshot_s mapped;
+	const type_cache_snapshot_catalog_s *mapped_entry;
+};
+
+typedef struct _type_cache_snapshot_writer_s {
+	GByteArray *catalogs;
+	GByteArray *types;
+	GByteArray *labels;
+	GByteArray *features;
+	GByteArray *label_order;
+	GByteArray *feature_order;
+	GByteArray *strings;
+	GHashTable *string_offsets;	/* string -> offset, every app id is stored once */
+} type_cache_snapshot_writer_s;
+
+static GHashTable *type_cache_users = NULL;	/* uid -> type_cache_catalog_s */
+static type_cache_catalog_s *type_cache_global = NULL;
+static type_cache_stamp_s type_cache_global_stamp;
+static gint64 type_cache_global_checked = 0;	/* when the stamp last matched the db files */
+static bool type_cache_global_dirty = false;
+static type_cache_snapshot_s type_cache_snapshot;
+/* catalogs of the snapshot not built yet, dropped once their db is written to */
+static GHashTable *type_cache_snapshot_users = NULL;	/* uid -> type_cache_snapshot_catalog_s */
+static const type_cache_snapshot_catalog_s *type_cache_snapshot_global = NULL;
+/* written at install time, preferred over the snapshot while the global db is unchanged */
+static type_cache_snapshot_s type_cache_index;
+static const type_cache_snapshot_catalog_s *type_cache_index_global = NULL;
+static char *type_cache_index_path = NULL;	/* rewritten there whenever found older than the global db */
+static pthread_mutex_t type_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* bumped under type_cache_mutex for every index serialized, the write lock only orders the writes */
+static gint type_cache_index_serial = 0;
+static pthread_mutex_t type_cache_index_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static char *type_cache_key(const char *first, const char *second)
+{
+	return g_strconcat(first, "\n", second, NULL);
+}
+
+static label_s *type_cache_label_new(const char *app_id, const char *label, const char *locale)
+{
+	label_s *label_data = (label_s *)calloc(1, sizeof(label_s));
+
+	if (label_data == NULL) {
+		ACCOUNT_FATAL("Memory Allocation Failed");
+		return NULL;
+	}
+
+	label_data->app_id = _account_dup_text(app_id);
+	label_data->label = _account_dup_text(label);
+	label_data->locale = _account_dup_text(locale);
+
+	return label_data;
+}
+
+static provider_feature_s *type_cache_feature_new(const char *app_id, const char *key)
+{
+	provider_feature_s *feature_data = (provider_feature_s *)calloc(1, sizeof(provider_feature_s));
+
+	if (feature_data == NULL) {
+		ACCOUNT_FATAL("Memory Allocation Failed");
+		return NULL;
+	}
+
+	feature_data->app_id = _account_dup_text(app_id);
+	feature_data->key = _account_dup_text(key);
+
+	return feature_data;
+}
+
+static type_cache_catalog_s *type_cache_catalog_new(const char *db_path)
+{
+	type_cache_catalog_s *catalog = g_new0(type_cache_catalog_s, 1);
+
+	catalog->ref_count = 1;
+	catalog->db_path = g_strdup(db_path);
+	catalog->app_ids = g_hash_table_new(g_str_hash, g_str_equal);
+	catalog->provider_features = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_slist_free);
+	catalog->supported_features = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	catalog->labels = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+	return catalog;
+}
+
+void type_cache_catalog_unref(type_cache_catalog_s *catalog)
+{
+	if (catalog == NULL || !g_atomic_int_dec_and_test(&catalog->ref_count))
+		return;
+
+	g_hash_table_destroy(catalog->app_ids);
+	g_hash_table_destroy(catalog->provider_features);
+	g_hash_table_destroy(catalog->supported_features);
+	g_hash_table_destroy(catalog->labels);
+	_account_type_gslist_account_type_free(catalog->account_types);
+	if (catalog->mapped.file)
+		g_mapped_file_unref(catalog->mapped.file);
+	g_free(catalog->db_path);
+	g_free(catalog);
+}
+
+void type_cache_catalog_add_account_type(type_cache_catalog_s *catalog, account_type_s *account_type)
+{
+	if (catalog == NULL || account_type == NULL)
+		return;
+
+	/* reversed back in type_cache_catalog_index() */
+	catalog->account_types = g_slist_prepend(catalog->account_types, account_type);
+	if (account_type->app_id)
+		g_hash_table_insert(catalog->app_ids, account_type->app_id, account_type);
+}
+
+void type_cache_catalog_add_label(type_cache_catalog_s *catalog, const char *app_id, const char *label, const char *locale)
+{
+	account_type_s *account_type = NULL;
+	label_s *label_data = NULL;
+
+	if (catalog == NULL || app_id == NULL)
+		return;
+
+	/* the last row wins, as it does for the query by locale */
+	if (locale && catalog->mapped_entry == NULL)
+		g_hash_table_insert(catalog->labels, type_cache_key(app_id, locale), g_strdup(label));
+
+	account_type = (account_type_s *)g_hash_table_lookup(catalog->app_ids, app_id);
+	if (account_type == NULL)
+		return;
+
+	label_data = type_cache_label_new(app_id, label, locale);
+	if (label_data)
+		account_type->label_list = g_slist_prepend(account_type->label_list, label_data);
+}
+
+void type_cache_catalog_add_provider_feature(type_cache_catalog_s *catalog, const char *app_id, const char *key)
+{
+	account_type_s *account_type = NULL;
+	provider_feature_s *feature_data = NULL;
+
+	if (catalog == NULL || app_id == NULL)
+		return;
+
+	if (key && catalog->mapped_entry == NULL)
+		g_hash_table_add(catalog->supported_features, type_cache_key(app_id, key));
+
+	account_type = (account_type_s *)g_hash_table_lookup(catalog->app_ids, app_id);
+	if (account_type == NULL)
+		return;
+
+	feature_data = type_cache_feature_new(app_id, key);
+	if (feature_data)
+		account_type->provider_feature_list = g_slist_prepend(account_type->provider_feature_list, feature_data);
+}
+
+static void type_cache_catalog_index(type_cache_catalog_s *catalog)
+{
+	GSList *iter = NULL;
+	GSList *feature_iter = NULL;
+	GHashTable *feature_types = g_hash_table_new(g_str_hash, g_str_equal);
+	GHashTableIter hash_iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+
+	catalog->account_types = g_slist_reverse(catalog->account_types);
+
+	for (iter = catalog->account_types; iter != NULL; iter = g_slist_next(iter)) {
+		account_type_s *account_type = (account_type_s *)iter->data;
+
+		account_type->label_list = g_slist_reverse(account_type->label_list);
+		account_type->provider_feature_list = g_slist_reverse(account_type->provider_feature_list);
+
+		for (feature_iter = account_type->provider_feature_list; feature_iter != NULL; feature_iter = g_slist_next(feature_iter)) {
+			provider_feature_s *feature_data = (provider_feature_s *)feature_iter->data;
+			GSList *account_types = NULL;
+
+			if (feature_data->key == NULL)
+				continue;
+
+			account_types = (GSList *)g_hash_table_lookup(feature_types, feature_data->key);
+			/* a type listing the key twice is returned once, as with the AppId IN () query */
+			if (account_types == NULL || account_types->data != account_type)
+				g_hash_table_insert(feature_types, feature_data->key, g_slist_prepend(account_types, account_type));
+		}
+	}
+
+	/* built newest first, appending would walk the whole list of a key for every type */
+	g_hash_table_iter_init(&hash_iter, feature_types);
+	while (g_hash_table_iter_next(&hash_iter, &key, &value))
+		g_hash_table_insert(catalog->provider_features, g_strdup((const char *)key), g_slist_reverse((GSList *)value));
+	g_hash_table_destroy(feature_types);
+}
+
+static type_cache_catalog_s *type_cache_catalog_build(const char *db_path, type_cache_load_cb load, void *user_data)
+{
+	type_cache_catalog_s *catalog = type_cache_catalog_new(db_path);
+	int ret = _ACCOUNT_ERROR_NONE;
+
+	ret = load(catalog, user_data);
+	if (ret != _ACCOUNT_ERROR_NONE) {
+		_ERR("account type catalog load failed [%d]", ret);
+		type_cache_catalog_unref(catalog);
+		return NULL;
+	}
+
+	type_cache_catalog_index(catalog);
+
+	return catalog;
+}
+
+static bool type_cache_get_stamp(const char *db_path, type_cache_stamp_s *stamp)
+{
+	struct stat st;
+	char *wal_path = NULL;
+	int fd = -1;
+
+	memset(stamp, 0, sizeof(type_cache_stamp_s));
+
+	if (stat(db_path, &st) != 0)
+		return false;
+
+	stamp->dev = st.st_dev;
+	stamp->ino = st.st_ino;
+	stamp->size = st.st_size;
+	stamp->mtime = st.st_mtim;
+
+	/* a commit in WAL mode only touches the -wal file */
+	wal_path = g_strdup_printf("%s-wal", db_path);
+	if (stat(wal_path, &st) == 0) {
+		stamp->wal_size = st.st_size;
+		stamp->wal_mtime = st.st_mtim;
+	}
+	g_free(wal_path);
+
+	/* bumped by every commit in rollback mode, mtime may not move for two commits within a tick */
+	fd = open(db_path, O_RDONLY | O_CLOEXEC);
+	if (fd >= 0) {
+		if (pread(fd, stamp->change_counter, sizeof(stamp->change_counter), TYPE_CACHE_CHANGE_COUNTER_OFFSET) != sizeof(stamp->change_counter))
+			memset(stamp->change_counter, 0, sizeof(stamp->change_counter));
+		close(fd);
+	}
+
+	return true;
+}
+
+/* unchecked, for the writer's own strings and rows of entries type_cache_snapshot_entry_valid() passed */
+static const char *type_cache_snapshot_text(const char *strings, guint32 offset)
+{
+	return offset ? strings + offset : NULL;
+}
+
+static const char *type_cache_snapshot_string(const type_cache_snapshot_s *snapshot, guint32 offset)
+{
+	if (offset >= snapshot->header->string_size)
+		return NULL;
+
+	return type_cache_snapshot_text(snapshot->strings, offset);
+}
+
+/* NULL sorts first, lookups never ask for it */
+static int type_cache_snapshot_strcmp(const char *first, const char *second)
+{
+	if (first == NULL || second == NULL)
+		return (first != NULL) - (second != NULL);
+
+	return strcmp(first, second);
+}
+
+/* fills the catalog from its mapped rows the way _account_type_catalog_load() does from the tables */
+static int type_cache_snapshot_load_catalog(type_cache_catalog_s *catalog)
+{
+	const type_cache_snapshot_s *snapshot = &catalog->mapped;
+	const type_cache_snapshot_catalog_s *entry = catalog->mapped_entry;
+	guint32 i = 0;
+
+	for (i = entry->first_type; i < entry->first_type + entry->type_count; i++) {
+		const type_cache_snapshot_type_s *record = &snapshot->types[i];
+		account_type_s *account_type = create_empty_account_type_instance();
+
+		if (account_type == NULL) {
+			ACCOUNT_FATAL("Memory Allocation Failed");
+			return _ACCOUNT_ERROR_OUT_OF_MEMORY;
+		}
+
+		account_type->id = record->id;
+		account_type->app_id = _account_dup_text(type_cache_snapshot_string(snapshot, record->app_id));
+		account_type->service_provider_id = _account_dup_text(type_cache_snapshot_string(snapshot, record->service_provider_id));
+		account_type->icon_path = _account_dup_text(type_cache_snapshot_string(snapshot, record->icon_path));
+		account_type->small_icon_path = _account_dup_text(type_cache_snapshot_string(snapshot, record->small_icon_path));
+		account_type->multiple_account_support = record->multiple_account_support;
+		type_cache_catalog_add_account_type(catalog, account_type);
+	}
+
+	for (i = entry->first_label; i < entry->first_label + entry->label_count; i++) {
+		const type_cache_snapshot_label_s *record = &snapshot->labels[i];
+
+		type_cache_catalog_add_label(catalog, type_cache_snapshot_string(snapshot, record->app_id),
+				type_cache_snapshot_string(snapshot, record->label), type_cache_snapshot_string(snapshot, record->locale));
+	}
+
+	for (i = entry->first_feature; i < entry->first_feature + entry->feature_count; i++) {
+		const type_cache_snapshot_feature_s *record = &snapshot->features[i];
+
+		type_cache_catalog_add_provider_feature(catalog, type_cache_snapshot_string(snapshot, record->app_id),
+				type_cache_snapshot_string(snapshot, record->key));
+	}
+
+	return _ACCOUNT_ERROR_NONE;
+}
+
+/* only the account types are copied out, the catalog keeps the file mapped for the rest */
+static type_cache_catalog_s *type_cache_catalog_build_mapped(const type_cache_snapshot_s *snapshot, const type_cache_snapshot_catalog_s *entry)
+{
+	type_cache_catalog_s *catalog = type_cache_catalog_new(type_cache_snapshot_string(snapshot, entry->db_path));
+	int ret = _ACCOUNT_ERROR_NONE;
+
+	catalog->mapped = *snapshot;
+	g_mapped_file_ref(catalog->mapped.file);
+	catalog->mapped_entry = entry;
+
+	ret = type_cache_snapshot_load_catalog(catalog);
+	if (ret != _ACCOUNT_ERROR_NONE) {
+		_ERR("account type catalog load from snapshot failed [%d]", ret);
+		type_cache_catalog_unref(catalog);
+		return NULL;
+	}
+
+	type_cache_catalog_index(catalog);
+
+	return catalog;
+}
+
+static int type_cache_snapshot_label_cmp(const char *strings, const type_cache_snapshot_label_s *record, const char *app_id, const char *locale)
+{
+	int ret = type_cache_snapshot_strcmp(type_cache_snapshot_text(strings, record->app_id), app_id);
+
+	if (ret == 0)
+		ret = type_cache_snapshot_strcmp(type_cache_snapshot_text(strings, record->locale), locale);
+
+	return ret;
+}
+
+static int type_cache_snapshot_feature_cmp(const char *strings, const type_cache_snapshot_feature_s *record, const char *app_id, const char *key)
+{
+	int ret = type_cache_snapshot_strcmp(type_cache_snapshot_text(strings, record->app_id), app_id);
+
+	if (ret == 0)
+		ret = type_cache_snapshot_strcmp(type_cache_snapshot_text(strings, record->key), key);
+
+	return ret;
+}
+
+/* the last of the equal rows, as the last row wins for the hash too */
+static const char *type_cache_mapped_lookup_label(type_cache_catalog_s *catalog, const char *app_id, const char *locale)
+{
+	const type_cache_snapshot_s *snapshot = &catalog->mapped;
+	const type_cache_snapshot_label_s *record = NULL;
+	guint32 low = catalog->mapped_entry->first_label;
+	guint32 high = low + catalog->mapped_entry->label_count;
+	guint32 mid = 0;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		record = &snapshot->labels[snapshot->label_order[mid]];
+		if (type_cache_snapshot_label_cmp(snapshot->strings, record, app_id, locale) <= 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low == catalog->mapped_entry->first_label)
+		return NULL;
+
+	record = &snapshot->labels[snapshot->label_order[low - 1]];
+	if (type_cache_snapshot_label_cmp(snapshot->strings, record, app_id, locale) != 0)
+		return NULL;
+
+	return type_cache_snapshot_string(snapshot, record->label);
+}
+
+static bool type_cache_mapped_has_provider_feature(type_cache_catalog_s *catalog, const char *app_id, const char *key)
+{
+	const type_cache_snapshot_s *snapshot = &catalog->mapped;
+	guint32 low = catalog->mapped_entry->first_feature;
+	guint32 high = low + catalog->mapped_entry->feature_count;
+	guint32 mid = 0;
+	int ret = 0;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		ret = type_cache_snapshot_feature_cmp(snapshot->strings, &snapshot->features[snapshot->feature_order[mid]], app_id, key);
+		if (ret == 0)
+			return true;
+		if (ret < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return false;
+}
+
+/* called with type_cache_mutex held, catalogs built from it keep their own reference */
+static void type_cache_snapshot_unmap(type_cache_snapshot_s *snapshot)
+{
+	if (snapshot->file)
+		g_mapped_file_unref(snapshot->file);
+	memset(snapshot, 0, sizeof(type_cache_snapshot_s));
+}
+
+/* called with type_cache_mutex held */
+static void type_cache_snapshot_release(void)
+{
+	if (type_cache_snapshot_users) {
+		g_hash_table_destroy(type_cache_snapshot_users);
+		type_cache_snapshot_users = NULL;
+	}
+	type_cache_snapshot_global = NULL;
+	type_cache_snapshot_unmap(&type_cache_snapshot);
+}
+
+/* called with type_cache_mutex held, the mapping goes once every catalog in it got built or dropped */
+static void type_cache_snapshot_release_if_unused(void)
+{
+	if (type_cache_snapshot_global == NULL
+			&& (type_cache_snapshot_users == NULL || g_hash_table_size(type_cache_snapshot_users) == 0))
+		type_cache_snapshot_release();
+}
+
+/* called with type_cache_mutex held */
+static void type_cache_index_release(void)
+{
+	type_cache_index_global = NULL;
+	type_cache_snapshot_unmap(&type_cache_index);
+}
+
+static bool type_cache_snapshot_range_valid(guint32 first, guint32 count, guint32 total)
+{
+	return first <= total && count <= total - first;
+}
+
+static bool type_cache_snapshot_order_valid(const guint32 *order, guint32 first, guint32 count)
+{
+	guint32 i = 0;
+
+	for (i = first; i < first + count; i++) {
+		if (order[i] < first || order[i] - first >= count)
+			return false;
+	}
+
+	return true;
+}
+
+static bool type_cache_snapshot_offset_valid(const type_cache_snapshot_s *snapshot, guint32 offset)
+{
+	return offset < snapshot->header->string_size;
+}
+
+/* the lookups read the strings of the rows through type_cache_snapshot_text(), unchecked */
+static bool type_cache_snapshot_rows_valid(const type_cache_snapshot_s *snapshot, const type_cache_snapshot_catalog_s *entry)
+{
+	guint32 i = 0;
+
+	for (i = entry->first_type; i < entry->first_type + entry->type_count; i++) {
+		const type_cache_snapshot_type_s *record = &snapshot->types[i];
+
+		if (!type_cache_snapshot_offset_valid(snapshot, record->app_id)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->service_provider_id)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->icon_path)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->small_icon_path))
+			return false;
+	}
+
+	for (i = entry->first_label; i < entry->first_label + entry->label_count; i++) {
+		const type_cache_snapshot_label_s *record = &snapshot->labels[i];
+
+		if (!type_cache_snapshot_offset_valid(snapshot, record->app_id)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->label)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->locale))
+			return false;
+	}
+
+	for (i = entry->first_feature; i < entry->first_feature + entry->feature_count; i++) {
+		const type_cache_snapshot_feature_s *record = &snapshot->features[i];
+
+		if (!type_cache_snapshot_offset_valid(snapshot, record->app_id)
+				|| !type_cache_snapshot_offset_valid(snapshot, record->key))
+			return false;
+	}
+
+	return true;
+}
+
+/* every row and string of the entry lies within the file, out of order rows would only make lookups miss */
+static bool type_cache_snapshot_entry_valid(const type_cache_snapshot_s *snapshot, const type_cache_snapshot_catalog_s *entry)
+{
+	const type_cache_snapshot_header_s *header = snapshot->header;
+
+	return type_cache_snapshot_string(snapshot, entry->db_path) != NULL
+		&& type_cache_snapshot_range_valid(entry->first_type, entry->type_count, header->type_count)
+		&& type_cache_snapshot_range_valid(entry->first_label, entry->label_count, header->label_count)
+		&& type_cache_snapshot_range_valid(entry->first_feature, entry->feature_count, header->feature_count)
+		&& type_cache_snapshot_order_valid(snapshot->label_order, entry->first_label, entry->label_count)
+		&& type_cache_snapshot_order_valid(snapshot->feature_order, entry->first_feature, entry->feature_count)
+		&& type_cache_snapshot_rows_valid(snapshot, entry);
+}
+
+static bool type_cache_snapshot_map(type_cache_snapshot_s *snapshot, const char *path)
+{
+	GError *error = NULL;
+	const char *contents = NULL;
+	const type_cache_snapshot_header_s *header = NULL;
+	gsize length = 0;
+	guint64 expected = 0;
+
+	memset(snapshot, 0, sizeof(type_cache_snapshot_s));
+
+	snapshot->file = g_mapped_file_new(path, FALSE, &error);
+	if (snapshot->file == NULL) {
+		_INFO("no account type catalogs in [%s] (%s)", path, error ? error->message : "");
+		g_clear_error(&error);
+		return false;
+	}
+
+	contents = g_mapped_file_get_contents(snapshot->file);
+	length = g_mapped_file_get_length(snapshot->file);
+	header = (const type_cache_snapshot_header_s *)contents;
+
+	if (contents == NULL || length < sizeof(type_cache_snapshot_header_s)
+			|| memcmp(header->magic, TYPE_CACHE_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != TYPE_CACHE_SNAPSHOT_VERSION
+			|| header->header_size != sizeof(type_cache_snapshot_header_s)
+			|| header->catalog_size != sizeof(type_cache_snapshot_catalog_s)) {
+		_ERR("account type catalogs in [%s] unusable", path);
+		type_cache_snapshot_unmap(snapshot);
+		return false;
+	}
+
+	expected = sizeof(type_cache_snapshot_header_s)
+		+ (guint64)header->catalog_count * sizeof(type_cache_snapshot_catalog_s)
+		+ (guint64)header->type_count * sizeof(type_cache_snapshot_type_s)
+		+ (guint64)header->label_count * (sizeof(type_cache_snapshot_label_s) + sizeof(guint32))
+		+ (guint64)header->feature_count * (sizeof(type_cache_snapshot_feature_s) + sizeof(guint32))
+		+ header->string_size;
+	if (expected != length || header->string_size == 0) {
+		_ERR("account type catalogs in [%s] truncated, [%zu] bytes of [%llu]", path, length, (unsigned long long)expected);
+		type_cache_snapshot_unmap(snapshot);
+		return false;
+	}
+
+	snapshot->header = header;
+	snapshot->catalogs = (const type_cache_snapshot_catalog_s *)(contents + sizeof(type_cache_snapshot_header_s));
+	snapshot->types = (const type_cache_snapshot_type_s *)(snapshot->catalogs + header->catalog_count);
+	snapshot->labels = (const type_cache_snapshot_label_s *)(snapshot->types + header->type_count);
+	snapshot->features = (const type_cache_snapshot_feature_s *)(snapshot->labels + header->label_count);
+	snapshot->label_order = (const guint32 *)(snapshot->features + header->feature_count);
+	snapshot->feature_order = snapshot->label_order + header->label_count;
+	snapshot->strings = (const char *)(snapshot->feature_order + header->feature_count);
+
+	/* every offset below string_size then reads a terminated string */
+	if (snapshot->strings[0] != '\0' || snapshot->strings[header->string_size - 1] != '\0') {
+		_ERR("account type catalogs in [%s] have a broken string table", path);
+		type_cache_snapshot_unmap(snapshot);
+		return false;
+	}
+
+	return true;
+}
+
+void type_cache_snapshot_load(const char *path)
+{
+	type_cache_stamp_s stamp;
+	guint32 current = 0;
+	guint32 i = 0;
+
+	if (path == NULL)
+		return;
+
+	pthread_mutex_lock(&type_cache_mutex);
+	type_cache_snapshot_release();
+
+	if (!type_cache_snapshot_map(&type_cache_snapshot, path)) {
+		pthread_mutex_unlock(&type_cache_mutex);
+		return;
+	}
+
+	/* a catalog is only trusted while its db looks exactly as it did when the snapshot was written */
+	for (i = 0; i < type_cache_snapshot.header->catalog_count; i++) {
+		const type_cache_snapshot_catalog_s *entry = &type_cache_snapshot.catalogs[i];
+		const char *db_path = NULL;
+
+		if (!type_cache_snapshot_entry_valid(&type_cache_snapshot, entry))
+			continue;
+
+		db_path = type_cache_snapshot_string(&type_cache_snapshot, entry->db_path);
+		if (!type_cache_get_stamp(db_path, &stamp) || memcmp(&stamp, &entry->stamp, sizeof(type_cache_stamp_s)) != 0) {
+			_INFO("[%s] changed since the account type snapshot", db_path);
+			continue;
+		}
+
+		if (entry->global) {
+			type_cache_snapshot_global = entry;
+		} else {
+			if (type_cache_snapshot_users == NULL)
+				type_cache_snapshot_users = g_hash_table_new(g_direct_hash, g_direct_equal);
+			g_hash_table_insert(type_cache_snapshot_users, GUINT_TO_POINTER(entry->uid), (gpointer)entry);
+		}
+		current++;
+	}
+
+	_INFO("account type snapshot mapped, [%d] of [%d] catalogs current", current, type_cache_snapshot.header->catalog_count);
+
+	type_cache_snapshot_release_if_unused();
+	pthread_mutex_unlock(&type_cache_mutex);
+}
+
+/* the stamp is checked when the global catalog is built, the installer may still be writing now */
+void type_cache_index_load(const char *path)
+{
+	guint32 i = 0;
+
+	if (path == NULL)
+		return;
+
+	pthread_mutex_lock(&type_cache_mutex);
+	type_cache_index_release();
+	g_free(type_cache_index_path);
+	type_cache_index_path = g_strdup(path);
+
+	if (type_cache_snapshot_map(&type_cache_index, path)) {
+		for (i = 0; i < type_cache_index.header->catalog_count && type_cache_index_global == NULL; i++) {
+			if (type_cache_index.catalogs[i].global && type_cache_snapshot_entry_valid(&type_cache_index, &type_cache_index.catalogs[i]))
+				type_cache_index_global = &type_cache_index.catalogs[i];
+		}
+
+		if (type_cache_index_global)
+			_INFO("account type index mapped, [%d] types", type_cache_index_global->type_count);
+		else
+			type_cache_index_release();
+	}
+	pthread_mutex_unlock(&type_cache_mutex);
+}
+
+static void type_cache_snapshot_writer_init(type_cache_snapshot_writer_s *writer)
+{
+	writer->catalogs = g_byte_array_new();
+	writer->types = g_byte_array_new();
+	writer->labels = g_byte_array_new();
+	writer->features = g_byte_array_new();
+	writer->label_order = g_byte_array_new();
+	writer->feature_order = g_byte_array_new();
+	writer->strings = g_byte_array_new();
+	writer->string_offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	/* offset 0 stands for NULL */
+	g_byte_array_append(writer->strings, (const guint8 *)"", 1);
+}
+
+static void type_cache_snapshot_writer_clear(type_cache_snapshot_writer_s *writer)
+{
+	g_byte_array_free(writer->catalogs, TRUE);
+	g_byte_array_free(writer->types, TRUE);
+	g_byte_array_free(writer->labels, TRUE);
+	g_byte_array_free(writer->features, TRUE);
+	g_byte_array_free(writer->label_order, TRUE);
+	g_byte_array_free(writer->feature_order, TRUE);
+	g_byte_array_free(writer->strings, TRUE);
+	g_hash_table_destroy(writer->string_offsets);
+}
+
+static guint32 type_cache_snapshot_add_string(type_cache_snapshot_writer_s *writer, const char *str)
+{
+	gpointer offset = NULL;
+
+	if (str == NULL)
+		return 0;
+
+	if (g_hash_table_lookup_extended(writer->string_offsets, str, NULL, &offset))
+		return GPOINTER_TO_UINT(offset);
+
+	offset = GUINT_TO_POINTER(writer->strings->len);
+	g_byte_array_append(writer->strings, (const guint8 *)str, strlen(str) + 1);
+	g_hash_table_insert(writer->string_offsets, g_strdup(str), offset);
+
+	return GPOINTER_TO_UINT(offset);
+}
+
+static void type_cache_snapshot_add_type(type_cache_snapshot_writer_s *writer, int id, bool multiple_account_support,
+		const char *app_id, const char *service_provider_id, const char *icon_path, const char *small_icon_path)
+{
+	type_cache_snapshot_type_s record;
+
+	record.id = id;
+	record.multiple_account_support = multiple_account_support;
+	record.app_id = type_cache_snapshot_add_string(writer, app_id);
+	record.service_provider_id = type_cache_snapshot_add_string(writer, service_provider_id);
+	record.icon_path = type_cache_snapshot_add_string(writer, icon_path);
+	record.small_icon_path = type_cache_snapshot_add_string(writer, small_icon_path);
+	g_byte_array_append(writer->types, (const guint8 *)&record, sizeof(record));
+}
+
+static void type_cache_snapshot_add_label(type_cache_snapshot_writer_s *writer, const char *app_id, const char *label, const char *locale)
+{
+	type_cache_snapshot_label_s record;
+
+	record.app_id = type_cache_snapshot_add_string(writer, app_id);
+	record.label = type_cache_snapshot_add_string(writer, label);
+	record.locale = type_cache_snapshot_add_string(writer, locale);
+	g_byte_array_append(writer->labels, (const guint8 *)&record, sizeof(record));
+}
+
+static void type_cache_snapshot_add_feature(type_cache_snapshot_writer_s *writer, const char *app_id, const char *key)
+{
+	type_cache_snapshot_feature_s record;
+
+	record.app_id = type_cache_snapshot_add_string(writer, app_id);
+	record.key = type_cache_snapshot_add_string(writer, key);
+	g_byte_array_append(writer->features, (const guint8 *)&record, sizeof(record));
+}
+
+/* the label and feature rows of every type, then those of app ids without one, which only feed the lookups */
+static void type_cache_snapshot_add_catalog_rows(type_cache_snapshot_writer_s *writer, type_cache_catalog_s *catalog)
+{
+	GHashTableIter hash_iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+	GSList *iter = NULL;
+	GSList *row_iter = NULL;
+
+	for (iter = catalog->account_types; iter != NULL; iter = g_slist_next(iter)) {
+		account_type_s *account_type = (account_type_s *)iter->data;
+
+		type_cache_snapshot_add_type(writer, account_type->id, account_type->multiple_account_support, account_type->app_id,
+				account_type->service_provider_id, account_type->icon_path, account_type->small_icon_path);
+
+		for (row_iter = account_type->label_list; row_iter != NULL; row_iter = g_slist_next(row_iter)) {
+			label_s *label_data = (label_s *)row_iter->data;
+			type_cache_snapshot_add_label(writer, label_data->app_id, label_data->label, label_data->locale);
+		}
+
+		for (row_iter = account_type->provider_feature_list; row_iter != NULL; row_iter = g_slist_next(row_iter)) {
+			provider_feature_s *feature_data = (provider_feature_s *)row_iter->data;
+			type_cache_snapshot_add_feature(writer, feature_data->app_id, feature_data->key);
+		}
+	}
+
+	g_hash_table_iter_init(&hash_iter, catalog->labels);
+	while (g_hash_table_iter_next(&hash_iter, &key, &value)) {
+		char **fields = g_strsplit((const char *)key, "\n", 2);
+
+		if (fields[0] && fields[1] && !g_hash_table_contains(catalog->app_ids, fields[0]))
+			type_cache_snapshot_add_label(writer, fields[0], (const char *)value, fields[1]);
+		g_strfreev(fields);
+	}
+
+	g_hash_table_iter_init(&hash_iter, catalog->supported_features);
+	while (g_hash_table_iter_next(&hash_iter, &key, NULL)) {
+		char **fields = g_strsplit((const char *)key, "\n", 2);
+
+		if (fields[0] && fields[1] && !g_hash_table_contains(catalog->app_ids, fields[0]))
+			type_cache_snapshot_add_feature(writer, fields[0], fields[1]);
+		g_strfreev(fields);
+	}
+}
+
+/* the rows of a mapped catalog are already in snapshot order */
+static void type_cache_snapshot_copy_rows(type_cache_snapshot_writer_s *writer, const type_cache_snapshot_s *snapshot,
+		const type_cache_snapshot_catalog_s *entry)
+{
+	guint32 i = 0;
+
+	for (i = entry->first_type; i < entry->first_type + entry->type_count; i++) {
+		const type_cache_snapshot_type_s *record = &snapshot->types[i];
+		type_cache_snapshot_add_type(writer, record->id, record->multiple_account_support,
+				type_cache_snapshot_string(snapshot, record->app_id), type_cache_snapshot_string(snapshot, record->service_provider_id),
+				type_cache_snapshot_string(snapshot, record->icon_path), type_cache_snapshot_string(snapshot, record->small_icon_path));
+	}
+
+	for (i = entry->first_label; i < entry->first_label + entry->label_count; i++) {
+		const type_cache_snapshot_label_s *record = &snapshot->labels[i];
+		type_cache_snapshot_add_label(writer, type_cache_snapshot_string(snapshot, record->app_id),
+				type_cache_snapshot_string(snapshot, record->label), type_cache_snapshot_string(snapshot, record->locale));
+	}
+
+	for (i = entry->first_feature; i < entry->first_feature + entry->feature_count; i++) {
+		const type_cache_snapshot_feature_s *record = &snapshot->features[i];
+		type_cache_snapshot_add_feature(writer, type_cache_snapshot_string(snapshot, record->app_id),
+				type_cache_snapshot_string(snapshot, record->key));
+	}
+}
+
+static gint type_cache_snapshot_label_order_cmp(gconstpointer first, gconstpointer second, gpointer user_data)
+{
+	type_cache_snapshot_writer_s *writer = (type_cache_snapshot_writer_s *)user_data;
+	const type_cache_snapshot_label_s *labels = (const type_cache_snapshot_label_s *)writer->labels->data;
+	const char *strings = (const char *)writer->strings->data;
+	const type_cache_snapshot_label_s *second_record = &labels[*(const guint32 *)second];
+
+	return type_cache_snapshot_label_cmp(strings, &labels[*(const guint32 *)first],
+			type_cache_snapshot_text(strings, second_record->app_id), type_cache_snapshot_text(strings, second_record->locale));
+}
+
+static gint type_cache_snapshot_feature_order_cmp(gconstpointer first, gconstpointer second, gpointer user_data)
+{
+	type_cache_snapshot_writer_s *writer = (type_cache_snapshot_writer_s *)user_data;
+	const type_cache_snapshot_feature_s *features = (const type_cache_snapshot_feature_s *)writer->features->data;
+	const char *strings = (const char *)writer->strings->data;
+	const type_cache_snapshot_feature_s *second_record = &features[*(const guint32 *)second];
+
+	return type_cache_snapshot_feature_cmp(strings, &features[*(const guint32 *)first],
+			type_cache_snapshot_text(strings, second_record->app_id), type_cache_snapshot_text(strings, second_record->key));
+}
+
+/* g_qsort_with_data() is stable, equal rows keep their order */
+static void type_cache_snapshot_add_order(type_cache_snapshot_writer_s *writer, GByteArray *order_section,
+		guint32 first, guint32 count, GCompareDataFunc compare)
+{
+	guint32 *order = g_new(guint32, count ? count : 1);
+	guint32 i = 0;
+
+	for (i = 0; i < count; i++)
+		order[i] = first + i;
+
+	g_qsort_with_data(order, count, sizeof(guint32), compare, writer);
+	g_byte_array_append(order_section, (const guint8 *)order, count * sizeof(guint32));
+	g_free(order);
+}
+
+/* mapped catalogs are copied over as they are, their label and feature hashes are empty */
+static void type_cache_snapshot_add_catalog(type_cache_snapshot_writer_s *writer, const char *db_path, uid_t uid, bool global,
+		const type_cache_stamp_s *stamp, type_cache_catalog_s *catalog, const type_cache_snapshot_s *snapshot,
+		const type_cache_snapshot_catalog_s *mapped_entry)
+{
+	type_cache_snapshot_catalog_s entry;
+
+	memset(&entry, 0, sizeof(type_cache_snapshot_catalog_s));
+	memcpy(&entry.stamp, stamp, sizeof(type_cache_stamp_s));
+	entry.uid = uid;
+	entry.global = global;
+	entry.db_path = type_cache_snapshot_add_string(writer, db_path);
+	entry.first_type = writer->types->len / sizeof(type_cache_snapshot_type_s);
+	entry.first_label = writer->labels->len / sizeof(type_cache_snapshot_label_s);
+	entry.first_feature = writer->features->len / sizeof(type_cache_snapshot_feature_s);
+
+	if (catalog && catalog->mapped_entry)
+		type_cache_snapshot_copy_rows(writer, &catalog->mapped, catalog->mapped_entry);
+	else if (catalog)
+		type_cache_snapshot_add_catalog_rows(writer, catalog);
+	else
+		type_cache_snapshot_copy_rows(writer, snapshot, mapped_entry);
+
+	entry.type_count = writer->types->len / sizeof(type_cache_snapshot_type_s) - entry.first_type;
+	entry.label_count = writer->labels->len / sizeof(type_cache_snapshot_label_s) - entry.first_label;
+	entry.feature_count = writer->features->len / sizeof(type_cache_snapshot_feature_s) - entry.first_feature;
+
+	type_cache_snapshot_add_order(writer, writer->label_order, entry.first_label, entry.label_count, type_cache_snapshot_label_order_cmp);
+	type_cache_snapshot_add_order(writer, writer->feature_order, entry.first_feature, entry.feature_count, type_cache_snapshot_feature_order_cmp);
+
+	g_byte_array_append(writer->catalogs, (const guint8 *)&entry, sizeof(entry));
+}
+
+/* a catalog of the mapped snapshot nobody asked for this time, kept for the next start if still current */
+static void type_cache_snapshot_carry_over(type_cache_snapshot_writer_s *writer, const type_cache_snapshot_catalog_s *entry)
+{
+	type_cache_stamp_s stamp;
+	const char *db_path = type_cache_snapshot_string(&type_cache_snapshot, entry->db_path);
+
+	if (!type_cache_get_stamp(db_path, &stamp) || memcmp(&stamp, &entry->stamp, sizeof(type_cache_stamp_s)) != 0)
+		return;
+
+	type_cache_snapshot_add_catalog(writer, db_path, entry->uid, entry->global, &stamp, NULL, &type_cache_snapshot, entry);
+}
+
+/* the whole file but the magic, which type_cache_snapshot_write() puts in */
+static GByteArray *type_cache_snapshot_serialize(type_cache_snapshot_writer_s *writer)
+{
+	type_cache_snapshot_header_s header;
+	GByteArray *buffer = g_byte_array_new();
+
+	memset(&header, 0, sizeof(type_cache_snapshot_header_s));
+	header.version = TYPE_CACHE_SNAPSHOT_VERSION;
+	header.header_size = sizeof(type_cache_snapshot_header_s);
+	header.catalog_size = sizeof(type_cache_snapshot_catalog_s);
+	header.catalog_count = writer->catalogs->len / sizeof(type_cache_snapshot_catalog_s);
+	header.type_count = writer->types->len / sizeof(type_cache_snapshot_type_s);
+	header.label_count = writer->labels->len / sizeof(type_cache_snapshot_label_s);
+	header.feature_count = writer->features->len / sizeof(type_cache_snapshot_feature_s);
+	header.string_size = writer->strings->len;
+
+	g_byte_array_append(buffer, (const guint8 *)&header, sizeof(header));
+	g_byte_array_append(buffer, writer->catalogs->data, writer->catalogs->len);
+	g_byte_array_append(buffer, writer->types->data, writer->types->len);
+	g_byte_array_append(buffer, writer->labels->data, writer->labels->len);
+	g_byte_array_append(buffer, writer->features->data, writer->features->len);
+	g_byte_array_append(buffer, writer->label_order->data, writer->label_order->len);
+	g_byte_array_append(buffer, writer->feature_order->data, writer->feature_order->len);
+	g_byte_array_append(buffer, writer->strings->data, writer->strings->len);
+
+	return buffer;
+}
+
+/* replaced by a rename, catalogs still mapping the old file keep reading it */
+static bool type_cache_snapshot_write(const char *path, GByteArray *buffer)
+{
+	GError *error = NULL;
+
+	memcpy(buffer->data, TYPE_CACHE_SNAPSHOT_MAGIC, sizeof(TYPE_CACHE_SNAPSHOT_MAGIC));
+
+	if (!g_file_set_contents(path, (const gchar *)buffer->data, buffer->len, &error)) {
+		_ERR("account type catalogs [%s] write failed (%s)", path, error ? error->message : "");
+		g_clear_error(&error);
+		return false;
+	}
+
+	return true;
+}
+
+void type_cache_snapshot_save(const char *path)
+{
+	type_cache_snapshot_writer_s writer;
+	type_cache_stamp_s stamp;
+	GByteArray *buffer = NULL;
+	GHashTableIter iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+
+	if (path == NULL)
+		return;
+
+	type_cache_snapshot_writer_init(&writer);
+
+	/* the dbs have to be closed by now, the stamps are taken as the next start will find them */
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_global) {
+		if (type_cache_get_stamp(type_cache_global->db_path, &stamp)
+				&& memcmp(&stamp, &type_cache_global_stamp, sizeof(type_cache_stamp_s)) == 0)
+			type_cache_snapshot_add_catalog(&writer, type_cache_global->db_path, 0, true, &stamp, type_cache_global, NULL, NULL);
+	} else if (type_cache_snapshot_global) {
+		type_cache_snapshot_carry_over(&writer, type_cache_snapshot_global);
+	}
+
+	if (type_cache_users) {
+		g_hash_table_iter_init(&iter, type_cache_users);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			type_cache_catalog_s *catalog = (type_cache_catalog_s *)value;
+			if (type_cache_get_stamp(catalog->db_path, &stamp))
+				type_cache_snapshot_add_catalog(&writer, catalog->db_path, GPOINTER_TO_UINT(key), false, &stamp, catalog, NULL, NULL);
+		}
+	}
+
+	if (type_cache_snapshot_users) {
+		g_hash_table_iter_init(&iter, type_cache_snapshot_users);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			if (type_cache_users == NULL || !g_hash_table_contains(type_cache_users, key))
+				type_cache_snapshot_carry_over(&writer, (const type_cache_snapshot_catalog_s *)value);
+		}
+	}
+
+	pthread_mutex_unlock(&type_cache_mutex);
+
+	buffer = type_cache_snapshot_serialize(&writer);
+	if (type_cache_snapshot_write(path, buffer))
+		_INFO("account type snapshot written, [%d] catalogs, [%d] bytes",
+				(int)(writer.catalogs->len / sizeof(type_cache_snapshot_catalog_s)), buffer->len);
+
+	g_byte_array_free(buffer, TRUE);
+	type_cache_snapshot_writer_clear(&writer);
+}
+
+/* the index of catalog as it is written, *types is the number of account types in it */
+static GByteArray *type_cache_index_serialize(const char *db_path, const type_cache_stamp_s *stamp, type_cache_catalog_s *catalog, int *types)
+{
+	type_cache_snapshot_writer_s writer;
+	GByteArray *buffer = NULL;
+
+	type_cache_snapshot_writer_init(&writer);
+	type_cache_snapshot_add_catalog(&writer, db_path, 0, true, stamp, catalog, NULL, NULL);
+
+	buffer = type_cache_snapshot_serialize(&writer);
+	*types = (int)(writer.types->len / sizeof(type_cache_snapshot_type_s));
+
+	type_cache_snapshot_writer_clear(&writer);
+
+	return buffer;
+}
+
+static bool type_cache_index_write(const char *index_path, GByteArray *buffer, int types)
+{
+	bool ret = false;
+
+	ret = type_cache_snapshot_write(index_path, buffer);
+	if (ret)
+		_INFO("account type index [%s] written, [%d] types, [%d] bytes", index_path, types, buffer->len);
+
+	return ret;
+}
+
+bool type_cache_index_build(const char *index_path, const char *db_path, type_cache_load_cb load, void *user_data)
+{
+	type_cache_catalog_s *catalog = NULL;
+	type_cache_stamp_s stamp;
+	GByteArray *buffer = NULL;
+	int types = 0;
+	bool ret = false;
+
+	if (index_path == NULL || db_path == NULL || load == NULL)
+		return false;
+
+	/* taken before loading, so a commit racing with the load leaves the index stale rather than wrong */
+	if (!type_cache_get_stamp(db_path, &stamp))
+		return false;
+
+	catalog = type_cache_catalog_build(db_path, load, user_data);
+	if (catalog == NULL)
+		return false;
+
+	buffer = type_cache_index_serialize(db_path, &stamp, catalog, &types);
+	type_cache_catalog_unref(catalog);
+
+	ret = type_cache_index_write(index_path, buffer, types);
+	g_byte_array_free(buffer, TRUE);
+
+	return ret;
+}
+
+type_cache_catalog_s *type_cache_get_user_catalog(uid_t uid, const char *db_path, type_cache_load_cb load, void *user_data)
+{
+	type_cache_catalog_s *catalog = NULL;
+	const type_cache_snapshot_catalog_s *entry = NULL;
+
+	if (db_path == NULL || load == NULL)
+		return NULL;
+
+	/* held while loading, concurrent readers wait for one build instead of running their own */
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_users == NULL)
+		type_cache_users = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)type_cache_catalog_unref);
+
+	catalog = (type_cache_catalog_s *)g_hash_table_lookup(type_cache_users, GUINT_TO_POINTER(uid));
+	if (catalog == NULL && type_cache_snapshot_users) {
+		entry = (const type_cache_snapshot_catalog_s *)g_hash_table_lookup(type_cache_snapshot_users, GUINT_TO_POINTER(uid));
+		if (entry) {
+			catalog = type_cache_catalog_build_mapped(&type_cache_snapshot, entry);
+			g_hash_table_remove(type_cache_snapshot_users, GUINT_TO_POINTER(uid));
+			type_cache_snapshot_release_if_unused();
+			if (catalog) {
+				g_hash_table_insert(type_cache_users, GUINT_TO_POINTER(uid), catalog);
+				_INFO("account type catalog of uid [%d] restored from snapshot, [%d] types", uid, g_slist_length(catalog->account_types));
+			}
+		}
+	}
+	if (catalog == NULL) {
+		catalog = type_cache_catalog_build(db_path, load, user_data);
+		if (catalog) {
+			g_hash_table_insert(type_cache_users, GUINT_TO_POINTER(uid), catalog);
+			_INFO("account type catalog of uid [%d] built, [%d] types", uid, g_slist_length(catalog->account_types));
+		}
+	}
+
+	if (catalog)
+		g_atomic_int_inc(&catalog->ref_count);
+	pthread_mutex_unlock(&type_cache_mutex);
+
+	return catalog;
+}
+
+type_cache_catalog_s *type_cache_get_global_catalog(const char *db_path, type_cache_load_cb load, void *user_data)
+{
+	type_cache_catalog_s *catalog = NULL;
+	type_cache_stamp_s stamp;
+	bool index_stale = false;
+	GByteArray *index_buffer = NULL;
+	char *index_path = NULL;
+	int index_types = 0;
+	guint index_serial = 0;
+
+	if (db_path == NULL || load == NULL)
+		return NULL;
+
+	/* package events mark it dirty, anything else writing the global db is caught within the interval */
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_global && !type_cache_global_dirty
+			&& g_get_monotonic_time() - type_cache_global_checked < TYPE_CACHE_GLOBAL_CHECK_INTERVAL) {
+		catalog = type_cache_global;
+		g_atomic_int_inc(&catalog->ref_count);
+		pthread_mutex_unlock(&type_cache_mutex);
+		return catalog;
+	}
+	/* cleared before the stamp is taken, an invalidation after that is seen by the next call */
+	type_cache_global_dirty = false;
+	pthread_mutex_unlock(&type_cache_mutex);
+
+	/* taken before loading, a commit racing with the load shows up on the next call */
+	if (!type_cache_get_stamp(db_path, &stamp))
+		return NULL;
+
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_global && memcmp(&stamp, &type_cache_global_stamp, sizeof(type_cache_stamp_s)) != 0) {
+		_INFO("global db changed, account type catalog dropped");
+		type_cache_catalog_unref(type_cache_global);
+		type_cache_global = NULL;
+	}
+
+	/* a package installed since the index was written leaves it stale until rewritten below */
+	if (type_cache_global == NULL && type_cache_index_global) {
+		if (memcmp(&stamp, &type_cache_index_global->stamp, sizeof(type_cache_stamp_s)) == 0) {
+			type_cache_global = type_cache_catalog_build_mapped(&type_cache_index, type_cache_index_global);
+			if (type_cache_global)
+				_INFO("account type catalog of global db mapped from the index, [%d] types", g_slist_length(type_cache_global->account_types));
+		} else {
+			_INFO("account type index is older than the global db, falling back to the db");
+			type_cache_index_release();
+		}
+	}
+	index_stale = type_cache_global == NULL;
+
+	/* the snapshot is good for the first build only, a rebuild means the db changed since */
+	if (type_cache_global == NULL && type_cache_snapshot_global) {
+		if (memcmp(&stamp, &type_cache_snapshot_global->stamp, sizeof(type_cache_stamp_s)) == 0) {
+			type_cache_global = type_cache_catalog_build_mapped(&type_cache_snapshot, type_cache_snapshot_global);
+			if (type_cache_global)
+				_INFO("account type catalog of global db restored from snapshot, [%d] types", g_slist_length(type_cache_global->account_types));
+		}
+	}
+	if (type_cache_snapshot_global) {
+		type_cache_snapshot_global = NULL;
+		type_cache_snapshot_release_if_unused();
+	}
+
+	if (type_cache_global == NULL) {
+		type_cache_global = type_cache_catalog_build(db_path, load, user_data);
+		if (type_cache_global)
+			_INFO("account type catalog of global db built, [%d] types", g_slist_length(type_cache_global->account_types));
+	}
+
+	if (type_cache_global) {
+		memcpy(&type_cache_global_stamp, &stamp, sizeof(type_cache_stamp_s));
+		type_cache_global_checked = g_get_monotonic_time();
+	}
+
+	/* once per change of the global db, so the next start maps it again. Only serialized here, written below */
+	if (type_cache_global && index_stale && type_cache_index_path) {
+		index_buffer = type_cache_index_serialize(db_path, &stamp, type_cache_global, &index_types);
+		index_path = g_strdup(type_cache_index_path);
+		index_serial = (guint)g_atomic_int_add(&type_cache_index_serial, 1) + 1;
+	}
+
+	catalog = type_cache_global;
+	if (catalog)
+		g_atomic_int_inc(&catalog->ref_count);
+	pthread_mutex_unlock(&type_cache_mutex);
+
+	/* the fsync and rename stall no lookup, a buffer overtaken by a newer one is dropped */
+	if (index_buffer) {
+		pthread_mutex_lock(&type_cache_index_write_mutex);
+		if (index_serial == (guint)g_atomic_int_get(&type_cache_index_serial))
+			type_cache_index_write(index_path, index_buffer, index_types);
+		pthread_mutex_unlock(&type_cache_index_write_mutex);
+
+		g_byte_array_free(index_buffer, TRUE);
+		g_free(index_path);
+	}
+
+	return catalog;
+}
+
+void type_cache_invalidate_user(uid_t uid)
+{
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_users && g_hash_table_remove(type_cache_users, GUINT_TO_POINTER(uid)))
+		_INFO("account type catalog of uid [%d] dropped", uid);
+	if (type_cache_snapshot_users && g_hash_table_remove(type_cache_snapshot_users, GUINT_TO_POINTER(uid)))
+		type_cache_snapshot_release_if_unused();
+	pthread_mutex_unlock(&type_cache_mutex);
+}
+
+void type_cache_invalidate_global(void)
+{
+	pthread_mutex_lock(&type_cache_mutex);
+	type_cache_global_dirty = true;
+	pthread_mutex_unlock(&type_cache_mutex);
+}
+
+void type_cache_finish(void)
+{
+	pthread_mutex_lock(&type_cache_mutex);
+	if (type_cache_users) {
+		g_hash_table_destroy(type_cache_users);
+		type_cache_users = NULL;
+	}
+	type_cache_catalog_unref(type_cache_global);
+	type_cache_global = NULL;
+	type_cache_snapshot_release();
+	type_cache_index_release();
+	g_free(type_cache_index_path);
+	type_cache_index_path = NULL;
+	pthread_mutex_unlock(&type_cache_mutex);
+}
+
+GSList *type_cache_get_all(type_cache_catalog_s *catalog)
+{
+	if (catalog == NULL)
+		return NULL;
+
+	return catalog->account_types;
+}
+
+const account_type_s *type_cache_lookup_app_id(type_cache_catalog_s *catalog, const char *app_id)
+{
+	if (catalog == NULL || app_id == NULL)
+		return NULL;
+
+	return (const account_type_s *)g_hash_table_lookup(catalog->app_ids, app_id);
+}
+
+GSList *type_cache_lookup_provider_feature(type_cache_catalog_s *catalog, const char *key)
+{
+	if (catalog == NULL || key == NULL)
+		return NULL;
+
+	return (GSList *)g_hash_table_lookup(catalog->provider_features, key);
+}
+
+bool type_cache_has_provider_feature(type_cache_catalog_s *catalog, const char *app_id, const char *key)
+{
+	char *feature_key = NULL;
+	bool found = false;
+
+	if (catalog == NULL || app_id == NULL || key == NULL)
+		return false;
+
+	if (catalog->mapped_entry)
+		return type_cache_mapped_has_provider_feature(catalog, app_id, key);
+
+	feature_key = type_cache_key(app_id, key);
+	found = g_hash_table_contains(catalog->supported_features, feature_key);
+	g_free(feature_key);
+
+	return found;
+}
+
+const char *type_cache_lookup_label(type_cache_catalog_s *catalog, const char *app_id, const char *locale)
+{
+	char *label_key = NULL;
+	const char *label = NULL;
+
+	if (catalog == NULL || app_id == NULL || locale == NULL)
+		return NULL;
+
+	if (catalog->mapped_entry)
+		return type_cache_mapped_lookup_label(catalog, app_id, locale);
+
+	label_key = type_cache_key(app_id, locale);
+	label = (const char *)g_hash_table_lookup(catalog->labels, label_key);
+	g_free(label_key);
+
+	return label;
+}